@@ -6,6 +6,7 @@
 #include <ctype.h>
 #include <stdlib.h> // for malloc() and free()
 #include "piControl.h"
+#include "piControlIf.h"
 
 #define MAX_DEVICES   64
 #define MAX_VARIABLES 1024
@@ -132,79 +133,117 @@ int read_variables(VariableEntry* vars)
 /* ---------------------------------------------------------
  * 3. For each variable:
  *    - KB_FIND_VARIABLE → offset, bit, length
- *    - KB_GET_VALUE     → actual value
+ *    Then read every value with one piControlReadV() call,
+ *    which coalesces neighbouring variables into few preads.
  * --------------------------------------------------------- */
-void get_variable_info(int fd, VariableEntry* vars, int count)
+void get_variable_info(VariableEntry* vars, int count)
 {
     printf("=== Variable Info ===\n\n");
 
-    for (int i = 0; i < count; i++) {
+    SPIVariable* info = calloc(count, sizeof(SPIVariable));
+    SPISegment*  seg  = calloc(count, sizeof(SPISegment));
+    uint8_t**    raw  = calloc(count, sizeof(uint8_t*));
+    int nseg = 0;
 
-        SPIVariable var;
-        memset(&var, 0, sizeof(var));
-        snprintf(var.strVarName, sizeof(var.strVarName), "%s", vars[i].name);
+    if (!info || !seg || !raw) {
+        fprintf(stderr, "Out of memory\n");
+        goto out;
+    }
 
-        if (ioctl(fd, KB_FIND_VARIABLE, &var) < 0) {
+    for (int i = 0; i < count; i++) {
+        snprintf(info[i].strVarName, sizeof(info[i].strVarName), "%s", vars[i].name);
+
+        if (piControlGetVariableInfo(&info[i]) < 0) {
             printf("%s: not found by KB_FIND_VARIABLE\n\n", vars[i].name);
             continue;
         }
 
-        printf("%s\n", vars[i].name);
-        printf("  Offset: %u\n", var.i16uAddress);
-        printf("  Bit:    %u\n", var.i8uBit);
-        printf("  Length: %u bits\n", var.i16uLength);
+        /* One buffer per variable, sized from its length */
+        uint16_t len = info[i].i16uLength >= 8 ? info[i].i16uLength / 8 : 1;
+
+        raw[i] = calloc(len, 1);
+        if (!raw[i]) {
+            fprintf(stderr, "Out of memory\n");
+            goto out;
+        }
+
+        seg[nseg].Offset = info[i].i16uAddress;
+        seg[nseg].Length = len;
+        seg[nseg].pData  = raw[i];
+        nseg++;
+    }
+
+    if (nseg > 0 && piControlReadV(seg, nseg) < 0) {
+        fprintf(stderr, "Failed to read variable values\n");
+        goto out;
+    }
 
-        SPIValue v;
-        memset(&v, 0, sizeof(v));
-        v.i16uAddress = var.i16uAddress;
-        v.i8uBit      = var.i8uBit;
+    for (int i = 0; i < count; i++) {
+        if (!raw[i])
+            continue;
 
-        ioctl(fd, KB_GET_VALUE, &v);
+        SPIVariable* var = &info[i];
+        uint8_t* b = raw[i];
+
+        printf("%s\n", vars[i].name);
+        printf("  Offset: %u\n", var->i16uAddress);
+        printf("  Bit:    %u\n", var->i8uBit);
+        printf("  Length: %u bits\n", var->i16uLength);
 
-        if (var.i16uLength == 1) {
-            printf("  Value: %u (digital)\n\n", v.i8uValue);
+        if (var->i16uLength == 1) {
+            printf("  Value: %u (digital)\n\n", (b[0] >> var->i8uBit) & 1);
         }
-        else if (var.i16uLength == 16) {
-            SPIValue high;
-            memset(&high, 0, sizeof(high));
-            high.i16uAddress = var.i16uAddress + 1;
-            high.i8uBit      = 0;
-            ioctl(fd, KB_GET_VALUE, &high);
-
-            unsigned int full = v.i8uValue | (high.i8uValue << 8);
-            printf("  Value: %u (16-bit)\n\n", full);
+        else if (var->i16uLength == 16) {
+            printf("  Value: %u (16-bit)\n\n", (unsigned)(b[0] | b[1] << 8));
+        }
+        else if (var->i16uLength == 32) {
+            printf("  Value: %u (32-bit)\n\n",
+                   (uint32_t)b[0] | (uint32_t)b[1] << 8 |
+                   (uint32_t)b[2] << 16 | (uint32_t)b[3] << 24);
+        }
+        else if (var->i16uLength > 32) {
+            printf("  Value:");
+            for (int k = 0; k < var->i16uLength / 8; k++)
+                printf(" %02x", b[k]);
+            printf(" (raw bytes)\n\n");
         }
         else {
-            printf("  Value: %u (raw byte)\n\n", v.i8uValue);
+            printf("  Value: %u (raw byte)\n\n", b[0]);
         }
     }
+
+out:
+    free(info);
+    free(seg);
+    if (raw) {
+        for (int i = 0; i < count; i++)
+            free(raw[i]);
+    }
+    free(raw);
 }
 
 int main(void)
 {
-    int fd = open(PICONTROL_DEVICE, O_RDWR);
-    if (fd < 0) {
-        perror("open " PICONTROL_DEVICE);
+    if (piControlOpen() < 0)
         return 1;
-    }
 
     SDeviceInfo devs[MAX_DEVICES];
     VariableEntry vars[MAX_VARIABLES];
 
     /* Step 1: Discover devices */
-    get_device_info(fd, devs);
+    get_device_info(PiControlHandle_g, devs);
 
     /* Step 2: Read variable names from config.rsc */
     int var_count = read_variables(vars);
     if (var_count <= 0) {
         fprintf(stderr, "No variables found in ./config.rsc\n");
-        close(fd);
+        piControlClose();
         return 1;
     }
 
     /* Step 3: Read variable info and values */
-    get_variable_info(fd, vars, var_count);
+    get_variable_info(vars, var_count);
 
-    close(fd);
+    piControlClose();
     return 0;
 }
@@ -0,0 +1,932 @@
+// SPDX-FileCopyrightText: 2017-2024 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+/*!
+ * Project: Pi Control
+ * Demo source code for usage of piControl driver
+ *
+ * \file piControlIf.c
+ *
+ * \brief PI Control Interface
+ */
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "piControlIf.h"
+
+#include "piControl.h"
+
+/******************************************************************************/
+/******************************  Global Vars  *********************************/
+/******************************************************************************/
+
+int PiControlHandle_g = -1;
+
+/* process image mapping, NULL while the syscall backend is active */
+uint8_t *PiControlImage_g = NULL;
+
+/* requested backend; -1 means "not set, consult PICONTROL_BACKEND_ENV" */
+static int PiControlBackendReq_g = -1;
+
+/******************************************************************************/
+/***************************  Internal Functions  *****************************/
+/******************************************************************************/
+
+/***********************************************************************************/
+/*!
+ * @brief Resolve the requested backend
+ *
+ * An explicit piControlSetBackend() wins over the environment variable.
+ *
+ ************************************************************************************/
+static EPiControlBackend piControlRequestedBackend(void)
+{
+	const char *env;
+
+	if (PiControlBackendReq_g >= 0)
+		return (EPiControlBackend)PiControlBackendReq_g;
+
+	env = getenv(PICONTROL_BACKEND_ENV);
+	if (env && strcmp(env, "mmap") == 0)
+		return PICONTROL_BACKEND_MMAP;
+
+	return PICONTROL_BACKEND_SYSCALL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Map the process image
+ *
+ * On failure the syscall backend stays active.
+ *
+ ************************************************************************************/
+static void piControlMap(void)
+{
+	void *p;
+
+	if (PiControlImage_g || PiControlHandle_g < 0)
+		return;
+
+	p = mmap(NULL, PICONTROL_IMAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+		 PiControlHandle_g, 0);
+	if (p == MAP_FAILED) {
+		fprintf(stderr, "Failed to mmap " PICONTROL_DEVICE
+			", using read/write: %s\n", strerror(errno));
+		return;
+	}
+
+	PiControlImage_g = p;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Unmap the process image
+ *
+ ************************************************************************************/
+static void piControlUnmap(void)
+{
+	if (PiControlImage_g) {
+		munmap(PiControlImage_g, PICONTROL_IMAGE_SIZE);
+		PiControlImage_g = NULL;
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Check a range against the mapped process image
+ *
+ ************************************************************************************/
+static int piControlInImage(uint32_t Offset, uint32_t Length)
+{
+	return Offset <= PICONTROL_IMAGE_SIZE &&
+	       Length <= PICONTROL_IMAGE_SIZE - Offset;
+}
+
+/******************************************************************************/
+/*******************************  Functions  **********************************/
+/******************************************************************************/
+
+/***********************************************************************************/
+/*!
+ * @brief Open Pi Control Interface
+ *
+ * Initialize the Pi Control Interface
+ *
+ ************************************************************************************/
+int piControlOpen(void)
+{
+	/* open handle if needed */
+	if (PiControlHandle_g < 0) {
+		PiControlHandle_g = open(PICONTROL_DEVICE, O_RDWR);
+		if (PiControlHandle_g < 0) {
+			fprintf(stderr, "Failed to open " PICONTROL_DEVICE ": %s\n",
+				strerror(errno));
+			return -1;
+		}
+
+		if (piControlRequestedBackend() == PICONTROL_BACKEND_MMAP)
+			piControlMap();
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Close Pi Control Interface
+ *
+ * Clsoe the Pi Control Interface
+ *
+ ************************************************************************************/
+void piControlClose(void)
+{
+	piControlUnmap();
+
+	/* open handle if needed */
+	if (PiControlHandle_g > 0) {
+		close(PiControlHandle_g);
+		PiControlHandle_g = -1;
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Select the process image backend
+ *
+ * PICONTROL_BACKEND_MMAP serves piControlRead/piControlWrite and the bit
+ * helpers from a shared mapping of the process image, so they cost a
+ * memory access instead of a syscall. If the mapping cannot be created the
+ * syscall backend is used. May be called before or after piControlOpen().
+ *
+ * @param[in]   backend
+ *
+ * @return 0 if the requested backend is active, -1 if it fell back
+ *
+ ************************************************************************************/
+int piControlSetBackend(EPiControlBackend backend)
+{
+	PiControlBackendReq_g = backend;
+
+	if (PiControlHandle_g < 0)
+		return 0;
+
+	if (backend == PICONTROL_BACKEND_MMAP)
+		piControlMap();
+	else
+		piControlUnmap();
+
+	return piControlGetBackend() == backend ? 0 : -1;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Get the active process image backend
+ *
+ ************************************************************************************/
+EPiControlBackend piControlGetBackend(void)
+{
+	return PiControlImage_g ? PICONTROL_BACKEND_MMAP : PICONTROL_BACKEND_SYSCALL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Reset Pi Control Interface
+ *
+ * Initialize the Pi Control Interface
+ *
+ ************************************************************************************/
+int piControlReset(void)
+{
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	if (ioctl(PiControlHandle_g, KB_RESET, NULL) < 0) {
+		fprintf(stderr, "Failed to reset piControl: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Wait for Reset of Pi Control Interface
+ *
+ * Wait for Reset of Pi Control Interface
+ *
+ ************************************************************************************/
+int piControlWaitForEvent(void)
+{
+	int event;
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	if (ioctl(PiControlHandle_g, KB_WAIT_FOR_EVENT, &event) < 0) {
+		fprintf(stderr, "Failed to wait for event: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return event;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Get Processdata
+ *
+ * Gets Processdata from a specific position
+ *
+ * @param[in]   Offset
+ * @param[in]   Length
+ * @param[out]  pData
+ *
+ * @return Number of Bytes read or error if negative
+ *
+ ************************************************************************************/
+int piControlRead(uint32_t Offset, uint32_t Length, uint8_t * pData)
+{
+	int BytesRead;
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	if (PiControlImage_g) {
+		if (!piControlInImage(Offset, Length)) {
+			fprintf(stderr,
+				"Failed to read data at offset %" PRIu32
+				" with length %" PRIu32 ": out of range\n",
+				Offset, Length);
+			return -1;
+		}
+		/* see everything the driver published before this read */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		memcpy(pData, PiControlImage_g + Offset, Length);
+		return Length;
+	}
+
+	/* seek */
+	if (lseek(PiControlHandle_g, Offset, SEEK_SET) < 0) {
+		fprintf(stderr,
+			"Failed to seek to data at offset %" PRIu32 ": %s\n",
+			Offset, strerror(errno));
+		return -1;
+	}
+
+	/* read */
+	BytesRead = read(PiControlHandle_g, pData, Length);
+	if (BytesRead < 0) {
+		fprintf(stderr,
+			"Failed to read data at offset %" PRIu32
+			" with length %" PRIu32 ": %s\n",
+			Offset, Length, strerror(errno));
+		return -1;
+	}
+
+	return BytesRead;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Set Processdata
+ *
+ * Writes Processdata at a specific position
+ *
+ * @param[in]   Offset
+ * @param[in]   Length
+ * @param[out]  pData
+ *
+ * @return Number of Bytes written or error if negative
+ *
+ ************************************************************************************/
+int piControlWrite(uint32_t Offset, uint32_t Length, uint8_t * pData)
+{
+	int BytesWritten;
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	if (PiControlImage_g) {
+		if (!piControlInImage(Offset, Length)) {
+			fprintf(stderr,
+				"Failed to write data at offset %" PRIu32
+				" with length %" PRIu32 ": out of range\n",
+				Offset, Length);
+			return -1;
+		}
+		memcpy(PiControlImage_g + Offset, pData, Length);
+		/* make the new outputs visible before the next I/O cycle */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		return Length;
+	}
+
+	/* seek */
+	if (lseek(PiControlHandle_g, Offset, SEEK_SET) < 0) {
+		fprintf(stderr,
+			"Failed to seek to data at offset %" PRIu32 ": %s\n",
+			Offset, strerror(errno));
+		return -1;
+	}
+
+	/* Write */
+	BytesWritten = write(PiControlHandle_g, pData, Length);
+	if (BytesWritten < 0) {
+		fprintf(stderr,
+			"Failed to write data at offset %" PRIu32
+			" with length %" PRIu32 ": %s\n",
+			Offset, Length, strerror(errno));
+		return -1;
+	}
+
+	return BytesWritten;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Sort segment indices by offset
+ *
+ * Insertion sort; batches are at most PICONTROL_MAX_SEGMENTS long.
+ *
+ ************************************************************************************/
+static void piControlSortSegments(const SPISegment *pSeg, int Count, int *pIdx)
+{
+	int i, j, k;
+
+	for (i = 0; i < Count; i++) {
+		k = i;
+		for (j = i; j > 0 && pSeg[pIdx[j - 1]].Offset > pSeg[k].Offset; j--)
+			pIdx[j] = pIdx[j - 1];
+		pIdx[j] = k;
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Transfer one batch of segments
+ *
+ * Segments are sorted and grouped into spans. Each span costs one pread or
+ * pwrite (no lseek), or a memcpy when the process image is mapped. Reads
+ * merge segments closer than PICONTROL_READV_GAP; writes merge only exactly
+ * adjacent segments so that bytes between them are never written.
+ *
+ ************************************************************************************/
+static int piControlTransferV(const SPISegment *pSeg, int Count, int Write)
+{
+	int idx[PICONTROL_MAX_SEGMENTS];
+	uint8_t buf[PICONTROL_IMAGE_SIZE];
+	uint32_t gap = Write ? 0 : PICONTROL_READV_GAP;
+	int total = 0;
+	int i, j, k;
+
+	piControlSortSegments(pSeg, Count, idx);
+
+	if (PiControlImage_g && !Write)
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	for (i = 0; i < Count; i = j) {
+		uint32_t start = pSeg[idx[i]].Offset;
+		uint32_t end = start + pSeg[idx[i]].Length;
+		uint8_t *span;
+		ssize_t n;
+
+		for (j = i + 1; j < Count; j++) {
+			const SPISegment *s = &pSeg[idx[j]];
+
+			if (s->Offset > end + gap)
+				break;
+			if (Write && s->Offset < end)
+				break;	/* overlapping writes stay separate, in offset order */
+			if (s->Offset + s->Length > end)
+				end = s->Offset + s->Length;
+		}
+
+		if (!piControlInImage(start, end - start)) {
+			fprintf(stderr,
+				"Failed to %s data at offset %" PRIu32
+				" with length %" PRIu32 ": out of range\n",
+				Write ? "write" : "read", start, end - start);
+			return -1;
+		}
+
+		span = PiControlImage_g ? PiControlImage_g + start : buf;
+
+		if (Write) {
+			for (k = i; k < j; k++) {
+				const SPISegment *s = &pSeg[idx[k]];
+				memcpy(span + (s->Offset - start), s->pData, s->Length);
+			}
+			if (!PiControlImage_g) {
+				n = pwrite(PiControlHandle_g, buf, end - start, start);
+				if (n != (ssize_t)(end - start)) {
+					fprintf(stderr,
+						"Failed to write data at offset %" PRIu32
+						" with length %" PRIu32 ": %s\n",
+						start, end - start,
+						n < 0 ? strerror(errno) : "short write");
+					return -1;
+				}
+			}
+		} else {
+			if (!PiControlImage_g) {
+				n = pread(PiControlHandle_g, buf, end - start, start);
+				if (n != (ssize_t)(end - start)) {
+					fprintf(stderr,
+						"Failed to read data at offset %" PRIu32
+						" with length %" PRIu32 ": %s\n",
+						start, end - start,
+						n < 0 ? strerror(errno) : "short read");
+					return -1;
+				}
+			}
+			for (k = i; k < j; k++) {
+				const SPISegment *s = &pSeg[idx[k]];
+				memcpy(s->pData, span + (s->Offset - start), s->Length);
+			}
+		}
+
+		for (k = i; k < j; k++)
+			total += pSeg[idx[k]].Length;
+	}
+
+	if (PiControlImage_g && Write)
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	return total;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Get Processdata from several positions
+ *
+ * Scatter read: fills every segment with the minimum number of kernel
+ * crossings (one pread per group of nearby segments, none with mmap).
+ *
+ * @param[in/out]   pSeg	array of segments
+ * @param[in]       Count	number of segments
+ *
+ * @return Total number of bytes read or error if negative
+ *
+ ************************************************************************************/
+int piControlReadV(const SPISegment *pSeg, int Count)
+{
+	int total = 0;
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	while (Count > 0) {
+		int n = Count > PICONTROL_MAX_SEGMENTS ? PICONTROL_MAX_SEGMENTS : Count;
+
+		ret = piControlTransferV(pSeg, n, 0);
+		if (ret < 0)
+			return ret;
+
+		total += ret;
+		pSeg += n;
+		Count -= n;
+	}
+
+	return total;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Set Processdata at several positions
+ *
+ * Gather write: adjacent segments are combined into one pwrite. Segments
+ * must not overlap unless their order does not matter.
+ *
+ * @param[in]   pSeg	array of segments
+ * @param[in]   Count	number of segments
+ *
+ * @return Total number of bytes written or error if negative
+ *
+ ************************************************************************************/
+int piControlWriteV(const SPISegment *pSeg, int Count)
+{
+	int total = 0;
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	while (Count > 0) {
+		int n = Count > PICONTROL_MAX_SEGMENTS ? PICONTROL_MAX_SEGMENTS : Count;
+
+		ret = piControlTransferV(pSeg, n, 1);
+		if (ret < 0)
+			return ret;
+
+		total += ret;
+		pSeg += n;
+		Count -= n;
+	}
+
+	return total;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Get Device Info
+ *
+ * Get Description of connected devices.
+ *
+ * @param[in/out]   Pointer to one element of type SDeviceInfo.
+ *
+ * @return 0 on success
+ *
+ ************************************************************************************/
+int piControlGetDeviceInfo(SDeviceInfo * pDev)
+{
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	if (ioctl(PiControlHandle_g, KB_GET_DEVICE_INFO, pDev) < 0) {
+		fprintf(stderr, "Failed to get device info: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Get Device Info List
+ *
+ * Get Description of connected devices.
+ *
+ * @param[in/out]   Pointer to an array of 20 entries of type SDeviceInfo.
+ *
+ * @return Number of detected devices
+ *
+ ************************************************************************************/
+int piControlGetDeviceInfoList(SDeviceInfo * pDev)
+{
+	int cnt;
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	cnt = ioctl(PiControlHandle_g, KB_GET_DEVICE_INFO_LIST, pDev);
+	if (cnt < 0) {
+		fprintf(stderr, "Failed to get device info list: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return cnt;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Get Bit Value
+ *
+ * Get the value of one bit in the process image.
+ *
+ * @param[in/out]   Pointer to SPIValue.
+ *
+ * @return 0 or error if negative
+ *
+ ************************************************************************************/
+int piControlGetBitValue(SPIValue * pSpiValue)
+{
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	pSpiValue->i16uAddress += pSpiValue->i8uBit / 8;
+	pSpiValue->i8uBit %= 8;
+
+	if (PiControlImage_g) {
+		if (!piControlInImage(pSpiValue->i16uAddress, 1)) {
+			fprintf(stderr, "Failed to get bit value: out of range\n");
+			return -1;
+		}
+		pSpiValue->i8uValue =
+			(__atomic_load_n(PiControlImage_g + pSpiValue->i16uAddress,
+					 __ATOMIC_SEQ_CST) >> pSpiValue->i8uBit) & 1;
+		return 0;
+	}
+
+	if (ioctl(PiControlHandle_g, KB_GET_VALUE, pSpiValue) < 0) {
+		fprintf(stderr, "Failed to get bit value: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Set Bit Value
+ *
+ * Set the value of one bit in the process image.
+ *
+ * @param[in/out]   Pointer to SPIValue.
+ *
+ * @return 0 or error if negative
+ *
+ ************************************************************************************/
+int piControlSetBitValue(SPIValue * pSpiValue)
+{
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	pSpiValue->i16uAddress += pSpiValue->i8uBit / 8;
+	pSpiValue->i8uBit %= 8;
+
+	if (PiControlImage_g) {
+		uint8_t *pByte;
+		uint8_t mask = 1 << pSpiValue->i8uBit;
+
+		if (!piControlInImage(pSpiValue->i16uAddress, 1)) {
+			fprintf(stderr, "Failed to set bit value: out of range\n");
+			return -1;
+		}
+		pByte = PiControlImage_g + pSpiValue->i16uAddress;
+		/* atomic so concurrent writers of neighbouring bits are preserved */
+		if (pSpiValue->i8uValue)
+			__atomic_fetch_or(pByte, mask, __ATOMIC_SEQ_CST);
+		else
+			__atomic_fetch_and(pByte, (uint8_t)~mask, __ATOMIC_SEQ_CST);
+		return 0;
+	}
+
+	if (ioctl(PiControlHandle_g, KB_SET_VALUE, pSpiValue) < 0) {
+		fprintf(stderr, "Failed to set bit value: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Get Variable Info
+ *
+ * Get the info for a variable.
+ *
+ * @param[in/out]   Pointer to SPIVariable.
+ *
+ * @return 0 or error if negative
+ *
+ ************************************************************************************/
+int piControlGetVariableInfo(SPIVariable * pSpiVariable)
+{
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	if (ioctl(PiControlHandle_g, KB_FIND_VARIABLE, pSpiVariable) < 0) {
+		fprintf(stderr, "Failed to get variable info: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Reset a counter or encoder in a RevPi DI or DIO module
+ *
+ * The DIO and DI modules some of the inputs can be configured as counter or encoder.
+ * When the module is turned on, both start with the value 0. They are implemented as
+ * signed 32-bit integer variable. This means they count upwards to (2^15)-1 and
+ * the flip to -(2^15). All counters/encoders can the reset to 0 at thw same time
+ * with this command. The argument is a bitfield. If bit n is set to 1, the
+ * counter/encoder on input n+1 will be reset. A value of 0xffff will reset all
+ * counters/encoders.
+ *
+ * @param[in]   address		address of the module as displayed ba PiCtory or 'piTest -d'
+ *		bitfield	bitfield defining the counters/endcoders to reset.
+ *
+ * @return      == 0    no error
+ *		< 0     in case of error, errno will be set
+ *
+ ************************************************************************************/
+int piControlResetCounter(int address, int bitfield)
+{
+	SDIOResetCounter tel;
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	tel.i8uAddress = address;
+	tel.i16uBitfield = bitfield;
+
+	ret = ioctl(PiControlHandle_g, KB_DIO_RESET_COUNTER, &tel);
+	if (ret < 0) {
+		fprintf(stderr, "Failed to reset counter: %s\n", strerror(errno));
+		return -1;
+	}
+	return ret;
+}
+
+int piControlGetROCounters(int address)
+{
+	struct revpi_ro_ioctl_counters ioc;
+	int ret;
+	int i;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	ioc.addr = address;
+
+	ret = ioctl(PiControlHandle_g, KB_RO_GET_COUNTER, &ioc);
+	if (ret < 0) {
+		fprintf(stderr, "Failed to get RO counters: %s\n", strerror(errno));
+		return -1;
+	}
+
+	printf("RO relay counters:\n");
+	for (i = 0; i < REVPI_RO_NUM_RELAYS; i++)
+		printf("     Relay %i: %u\n", i + 1, ioc.counter[i]);
+
+	return ret;
+}
+
+
+/***********************************************************************************/
+/*!
+ * @brief Update firmware
+ *
+ * KUNBUS provides "*.fwu" files with new firmware for RevPi I/O and RevPi Gate modules.
+ * These are provided in the debian paket revpi-firmware. Use 'sudo apt-get install revpi-firmware'
+ * to get the latest firmware files. Afterwards you can update the firmware with this ioctl call.
+ * Unforunatelly old modules hang or block the piBridge communication if a modules is updated.
+ * Therefore the update is only possible when only one module is connected to the RevPi.
+ * The module must be on the right side of the RevPi Core and on the left side of the RevPi Connect.
+ * This ioctl reads the version number from the module and compares it to the lastet available
+ * firmware file. If a new firmware is available, it is flashed to the module.
+ * If forced update is specified the firmware is flashed even if its version number is equal to or
+ * smaller than the one running on the target module. This requires a module address.
+ *
+ * @param[in]   addr_p		address of module to update. 0 for automatic selection of the module
+ * 				to update.
+ * @param[in]   force_update	skip the firmware version check.
+ *
+ * @return 0 or error if negative
+ *
+ ************************************************************************************/
+int piControlUpdateFirmware(uint32_t addr_p, bool force_update)
+{
+	struct picontrol_firmware_upload fwu;
+	int ret;
+
+	if (addr_p == 0) {
+		fprintf(stderr,
+			"A firmware update on the module with address %" PRIu32
+			" (i.e. the Revolution Pi) is invalid.\n", addr_p);
+		return -EINVAL;
+	}
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	memset(&fwu, 0, sizeof(fwu));
+	fwu.addr = addr_p;
+	if (force_update) {
+		fwu.flags |= PICONTROL_FIRMWARE_FORCE_UPLOAD;
+	}
+
+	printf("Updating Firmware%s!\n", force_update ? " (forced)" : "");
+	printf("This can take a while. Do not switch off the system!\n");
+
+	ret = ioctl(PiControlHandle_g, PICONTROL_UPLOAD_FIRMWARE, &fwu);
+	if (ret < 0) {
+		fprintf(stderr, "Failed to update firmware of module with address %"
+			PRIu32 ": %s\n", addr_p, strerror(errno));
+		return -1;
+	} else if (ret == 0) {
+		printf("Firmware for module with address %" PRIu32
+			" updated successfully.\n", addr_p);
+	} else if (ret == 1) {
+		printf("Firmware of module with address %" PRIu32
+			" is already up to date.\n", addr_p);
+		printf("Use '--force' to force firmware update.\n");
+	}
+
+	return 0;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Stop/Start I/O update
+ *
+ * This ioctl stops, starts or toggles the update of I/Os. If the I/O updates are stopped,
+ * piControls writes 0 to the outputs instead of the values from the process image.
+ * The input values are not written to the process images. The I/O communication is
+ * runnging as normal. On the update of DIO, DI, DO, AIO, Gate modules and the RevPi
+ * itself is stopped. There is no change in the handling of virtual modules.
+ * The function can used for simulation of I/Os. A simulation application can be started
+ * additionally to the other control and application processes. It stops the I/O update
+ * and simulates the hardware by setting and reading the values in the process image.
+ * The application does not notice this.
+ *
+ * @param[in]   stop==0	Start the I/O update
+ *		stop==1	Stop the I/O update
+ *		stop==2 Toggle the mode of I/O update
+ *
+ * @return 	0/1 the new state
+ *		<0 in case of an error
+ *
+ ************************************************************************************/
+int piControlStopIO(int stop)
+{
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	ret = ioctl(PiControlHandle_g, KB_STOP_IO, &stop);
+	if (ret < 0) {
+		fprintf(stderr, "Failed to stop IO: %s\n", strerror(errno));
+		return -1;
+	}
+	return ret;
+}
+
+
+/***********************************************************************************/
+/*!
+ * @brief Get a message from the last ioctl call.
+ * 
+ * Check, if the last ioctl() call produced a message and display it if necessary.
+ * 
+ ***********************************************************************************/
+void piShowLastMessage(void)
+{
+	char cMsg[REV_PI_ERROR_MSG_LEN];
+    
+	if (ioctl(PiControlHandle_g, KB_GET_LAST_MESSAGE, cMsg) == 0 && cMsg[0])
+		puts(cMsg);
+}
+
+int piControlCalibrate(int addr, int channl, int mode, int xval, int yval)
+{
+	struct pictl_calibrate cali;
+	int ret;
+
+	cali.address = addr;
+	cali.mode = mode;
+	cali.channels = channl;
+	cali.x_val = xval;
+	cali.y_val = yval;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	ret = ioctl(PiControlHandle_g, KB_AIO_CALIBRATE, &cali);
+	if (ret < 0) {
+		fprintf(stderr, "Failed to calibrate: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return ret;
+}
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2017-2024 KUNBUS GmbH
+//
+// SPDX-License-Identifier: MIT
+
+#ifndef PICONTROLIF_H_
+#define PICONTROLIF_H_
+
+/******************************************************************************/
+/********************************  Includes  **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "piControl.h"
+
+
+/******************************************************************************/
+/*********************************  Types  ************************************/
+/******************************************************************************/
+
+/* size of the process image mapped by the mmap backend */
+#define PICONTROL_IMAGE_SIZE	4096
+
+/* environment variable selecting the backend: "syscall" or "mmap" */
+#define PICONTROL_BACKEND_ENV	"PICONTROL_BACKEND"
+
+typedef enum {
+	PICONTROL_BACKEND_SYSCALL = 0,	/* lseek/read/write and ioctl */
+	PICONTROL_BACKEND_MMAP		/* process image mapped into memory */
+} EPiControlBackend;
+
+/* segments handled per batch by piControlReadV/piControlWriteV */
+#define PICONTROL_MAX_SEGMENTS	64
+
+/* gap (bytes) between read segments that is still read in one call */
+#define PICONTROL_READV_GAP	32
+
+/* one (offset, length, buffer) entry of a scatter/gather request */
+typedef struct SPISegmentStr {
+	uint32_t Offset;
+	uint32_t Length;
+	uint8_t *pData;
+} SPISegment;
+
+extern int PiControlHandle_g;
+extern uint8_t *PiControlImage_g;
+
+
+/******************************************************************************/
+/*******************************  Prototypes  *********************************/
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int piControlReset(void);
+int piControlRead(uint32_t Offset, uint32_t Length, uint8_t *pData);
+int piControlWrite(uint32_t Offset, uint32_t Length, uint8_t *pData);
+int piControlReadV(const SPISegment *pSeg, int Count);
+int piControlWriteV(const SPISegment *pSeg, int Count);
+int piControlGetDeviceInfo(SDeviceInfo *pDev);
+int piControlGetDeviceInfoList(SDeviceInfo *pDev);
+int piControlGetBitValue(SPIValue *pSpiValue);
+int piControlSetBitValue(SPIValue *pSpiValue);
+int piControlGetVariableInfo(SPIVariable *pSpiVariable);
+int piControlFindVariable(const char *name);
+int piControlResetCounter(int address, int bitfield);
+int piControlGetROCounters(int address);
+int piControlWaitForEvent(void);
+int piControlUpdateFirmware(uint32_t addr_p, bool force_update);
+int piControlStopIO(int stop);
+void piShowLastMessage(void);
+int piControlCalibrate(int addr, int channl, int mode, int xval, int yval);
+
+int piControlOpen(void);
+void piControlClose(void);
+int piControlSetBackend(EPiControlBackend backend);
+EPiControlBackend piControlGetBackend(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PICONTROLIF_H_ */
@@ -6,6 +6,7 @@
  *   - Calibration validation
  *   - Non-blocking homing (tilt + rotate)
  *   - Session start/stop/pause/resume
+ *   - Multi-step session programs (control_program.h)
  *   - Non-blocking tilt and rotate commands
  *   - ESTOP handling
  */
@@ -17,37 +18,81 @@
  */
 
 #include <stdio.h>
-#include <unistd.h>   /* for usleep() */
 #include "control.h"
+#include "control_cmd.h"
+#include "control_program.h"
 #include "control_tilt.h"
 #include "control_rotate.h"
+#include "control_tick.h"
 #include "calibration_tilt.h"
 #include "calibration_rotate.h"
 #include "machine_state.h"
+#include "io_scan.h"
+#include "di_edge.h"
+#include "motion.h"
+#include "executive.h"
+#include "control_status.h"
+#include "hal.h"
+#include "safety.h"
+#include "time_source.h"
 
 /* -------------------------------------------------------------------------
  * Internal state
  * ------------------------------------------------------------------------- */
 
-/**
- * @brief Internal control phase for session execution.
- */
-typedef enum {
-    CONTROL_PHASE_IDLE = 0,       /**< No active session */
-    CONTROL_PHASE_HOME_TILT,      /**< Tilt homing in progress */
-    CONTROL_PHASE_HOME_ROTATE,    /**< Rotate homing in progress */
-    CONTROL_PHASE_TILT,           /**< Tilt axis is moving to target */
-    CONTROL_PHASE_ROTATE,         /**< Rotate axis is executing steps */
-    CONTROL_PHASE_DONE            /**< Session completed */
-} ControlPhase_t;
-
 static MachineStatus_t g_status          = MACHINE_STATUS_READY;
 static SessionConfig_t g_session;
 static int             g_estop_latched   = 0;
 static ControlPhase_t  g_phase           = CONTROL_PHASE_IDLE;
+static int             g_estop_sub       = -1;  /**< di_edge subscriber */
+static ControlFault_t  g_fault           = CONTROL_FAULT_NONE;
+static ControlInterlock_t g_interlock    = { CONTROL_OVERLAP_NONE, 0.0f };
+static int             g_tilt_busy       = 0;   /**< Overlapped phases: axis still moving */
+static int             g_rotate_busy     = 0;
+static uint64_t        g_publish_count   = 0;
+static uint64_t        g_tick_count      = 0;   /**< Control_Tick() calls */
+
+/* Program execution (Control_StartProgram) */
+static ControlProgram_t g_program;              /**< count = 0: no program */
+static int             g_program_active  = 0;   /**< Phases run program steps */
+static int             g_step            = 0;   /**< Current step index */
+static float           g_step_volt       = 0.0f;/**< Tilt target of the current step */
+static int             g_next_ok         = 0;   /**< Step g_step + 1 passed PrepareStep() */
+static float           g_next_volt       = 0.0f;
+static uint64_t        g_dwell_until_ms  = 0;
+static uint64_t        g_dwell_left_ms   = 0;   /**< Remaining dwell while paused */
+static uint64_t        g_program_start_ms = 0;
+static uint64_t        g_program_end_ms   = 0;  /**< Set when the program ends */
+
+/* Forward declarations */
+static int  CheckSession(const SessionConfig_t *cfg);
+static void ServiceEStop(void);
+static void ServiceCommands(void);
+static void ServicePhase(ControlTick_t *tick);
+static void ServiceBoth(ControlTick_t *tick);
+static int  BeginBoth(int home);
+static void PublishStatus(ControlTick_t *tick);
+static void BeginStep(void);
+static void EndProgram(void);
 
-/* Forward declaration */
-static int CheckSession(const SessionConfig_t *cfg);
+/**
+ * @brief Enter FAULT and record why; a running program ends here.
+ */
+static void SetFault(ControlFault_t reason)
+{
+    g_status = MACHINE_STATUS_FAULT;
+    g_fault  = reason;
+    EndProgram();
+}
+
+/**
+ * @brief Enter ESTOP (latched); a running program ends here.
+ */
+static void EnterEStop(void)
+{
+    g_status = MACHINE_STATUS_ESTOP;
+    EndProgram();
+}
 
 /* -------------------------------------------------------------------------
  * Initialization
@@ -59,8 +104,21 @@ static int CheckSession(const SessionConfig_t *cfg);
 void Control_Init(void)
 {
     g_status        = MACHINE_STATUS_READY;
-    g_estop_latched = 0;
+    __atomic_store_n(&g_estop_latched, 0, __ATOMIC_RELEASE);
     g_phase         = CONTROL_PHASE_IDLE;
+    g_fault         = CONTROL_FAULT_NONE;
+    EndProgram();
+
+    /* A safety trip also holds the relays off; release it with the latch */
+    if (hal_forced() && Safety_Reset() < 0) {
+        g_status = MACHINE_STATUS_ESTOP;   /* still pressed */
+        __atomic_store_n(&g_estop_latched, 1, __ATOMIC_RELEASE);
+    }
+
+    /* ESTOP press = falling raw edge (inverted input) */
+    if (g_estop_sub < 0)
+        g_estop_sub = di_edge_subscribe(DI_EDGE_CH(DI_ESTOP), DI_EDGE_FALLING);
+    di_edge_flush(g_estop_sub);
 }
 
 /* -------------------------------------------------------------------------
@@ -69,12 +127,159 @@ void Control_Init(void)
 
 /**
  * @brief Periodic tick function (non-blocking orchestrator).
+ *
+ * Inputs are scanned once at the start of the tick; every HAL read issued
+ * by the axis engines during this tick is served from that snapshot, and
+ * relay/DO/AO changes are flushed together once the phase has run.
+ * An ESTOP press seen by that scan (di_edge.h) latches ESTOP before the
+ * phase runs; commands queued by other threads (control_cmd.h) are run
+ * right after the ESTOP check. The status snapshot (control_status.h) is
+ * published from the same scan before the outputs are flushed.
+ *
+ * One tick context (control_tick.h) is built after the scan and handed to
+ * the engine services: a single timestamp and a single tilt sample for
+ * everything the tick does.
  */
 void Control_Tick(void)
+{
+    ControlTick_t tick;
+
+    io_scan_inputs();
+    ControlTick_Begin(&tick, g_tick_count++);
+    ServiceEStop();
+    ServiceCommands();
+    ServicePhase(&tick);
+    PublishStatus(&tick);
+    ControlTick_End(&tick);
+    io_scan_outputs();
+}
+
+/* -------------------------------------------------------------------------
+ * Executive tasks (multi-rate alternative to Control_Tick)
+ * ------------------------------------------------------------------------- */
+
+static void ControlTask_EStop(const ExecTick_t *tick)
+{
+    (void)tick;
+
+    ServiceEStop();
+    if (__atomic_load_n(&g_estop_latched, __ATOMIC_ACQUIRE)) {
+        EnterEStop();
+    }
+}
+
+static void ControlTask_Command(const ExecTick_t *exec)
+{
+    ControlTick_t tick;
+
+    ControlTick_Begin(&tick, exec->count);
+    ServiceCommands();
+
+    /* Dwell and fine tilt pulses end at command rate, not on the next
+     * tilt task run */
+    if (g_phase == CONTROL_PHASE_DWELL ||
+        ((g_phase == CONTROL_PHASE_TILT || g_phase == CONTROL_PHASE_BOTH) &&
+         ControlTilt_InPulse())) {
+        ServicePhase(&tick);
+    }
+    ControlTick_End(&tick);
+}
+
+static void ControlTask_Publish(const ExecTick_t *exec)
+{
+    ControlTick_t tick;
+
+    ControlTick_Begin(&tick, exec->count);
+    PublishStatus(&tick);
+    ControlTick_End(&tick);
+}
+
+static void ControlTask_Tilt(const ExecTick_t *exec)
+{
+    ControlTick_t tick;
+
+    if (g_phase == CONTROL_PHASE_HOME_TILT || g_phase == CONTROL_PHASE_TILT ||
+        g_phase == CONTROL_PHASE_HOME_BOTH || g_phase == CONTROL_PHASE_BOTH) {
+        ControlTick_Begin(&tick, exec->count);
+        ServicePhase(&tick);
+        ControlTick_End(&tick);
+    }
+}
+
+static void ControlTask_Rotate(const ExecTick_t *exec)
+{
+    ControlTick_t tick;
+
+    if (g_phase == CONTROL_PHASE_HOME_ROTATE || g_phase == CONTROL_PHASE_ROTATE) {
+        ControlTick_Begin(&tick, exec->count);
+        ServicePhase(&tick);
+        ControlTick_End(&tick);
+    }
+}
+
+/**
+ * @brief Register the control tasks with the executive.
+ *
+ * @return 0 on success, -1 if a task could not be added.
+ */
+int Control_RegisterTasks(void)
+{
+    if (Exec_AddTask("estop",   CONTROL_ESTOP_PERIOD_US, 0,  ControlTask_EStop)   < 0) return -1;
+    if (Exec_AddTask("command", CONTROL_ESTOP_PERIOD_US, 1,  ControlTask_Command) < 0) return -1;
+    if (Exec_AddTask("tilt",    CONTROL_AXIS_PERIOD_US,  10, ControlTask_Tilt)    < 0) return -1;
+    if (Exec_AddTask("rotate",  CONTROL_AXIS_PERIOD_US,  11, ControlTask_Rotate)  < 0) return -1;
+    if (Exec_AddTask("publish", CONTROL_ESTOP_PERIOD_US, 12, ControlTask_Publish) < 0) return -1;
+    return 0;
+}
+
+/**
+ * @brief Latch ESTOP if the current scan saw a press edge.
+ */
+static void ServiceEStop(void)
+{
+    DiEdge_t edge;
+
+    if (di_edge_next(g_estop_sub, &edge) > 0) {
+        di_edge_flush(g_estop_sub);
+        Control_NotifyEStopActive();
+    }
+}
+
+/**
+ * @brief Run commands queued by other threads, oldest first.
+ */
+static void ServiceCommands(void)
+{
+    ControlCmd_t cmd;
+    uint64_t seq;
+    int ret;
+
+    for (int n = 0; n < CONTROL_CMD_MAX_PER_TICK && ControlCmd_Next(&cmd, &seq); n++) {
+        switch (cmd.type) {
+        case CONTROL_CMD_HOME:   ret = Control_BeginHome();                break;
+        case CONTROL_CMD_START:  ret = Control_StartSession(&cmd.session); break;
+        case CONTROL_CMD_PAUSE:  ret = Control_PauseSession();             break;
+        case CONTROL_CMD_RESUME: ret = Control_ResumeSession();            break;
+        case CONTROL_CMD_STOP:   ret = Control_StopSession();              break;
+        case CONTROL_CMD_PROGRAM:
+            ret = cmd.program ? Control_StartProgram(cmd.program) : -1;
+            break;
+        default:                 ret = -1;                                 break;
+        }
+        ControlCmd_Complete(seq, ret);
+    }
+}
+
+/**
+ * @brief Run one step of the current control phase.
+ *
+ * @param tick Context of the current tick.
+ */
+static void ServicePhase(ControlTick_t *tick)
 {
     /* ESTOP handling */
-    if (g_estop_latched) {
-        g_status = MACHINE_STATUS_ESTOP;
+    if (__atomic_load_n(&g_estop_latched, __ATOMIC_ACQUIRE)) {
+        EnterEStop();
         return;
     }
 
@@ -90,7 +295,7 @@ void Control_Tick(void)
      * ------------------------------------------------------------- */
     case CONTROL_PHASE_HOME_TILT:
     {
-        TiltResult_t tr = ControlTilt_ServiceHome();
+        TiltResult_t tr = ControlTilt_ServiceHomeTick(tick);
 
         if (tr == TILT_RUNNING) break;
 
@@ -98,7 +303,7 @@ void Control_Tick(void)
             RotateResult_t rr = ControlRotate_RotateHome();
 
             if (rr == ROTATE_ERROR) {
-                g_status = MACHINE_STATUS_FAULT;
+                SetFault(CONTROL_FAULT_ROTATE);
                 g_phase  = CONTROL_PHASE_IDLE;
                 break;
             }
@@ -118,7 +323,7 @@ void Control_Tick(void)
             break;
         }
 
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_TILT);
         g_phase  = CONTROL_PHASE_IDLE;
         break;
     }
@@ -128,7 +333,7 @@ void Control_Tick(void)
      * ------------------------------------------------------------- */
     case CONTROL_PHASE_HOME_ROTATE:
     {
-        RotateResult_t rr = ControlRotate_ServiceHome();
+        RotateResult_t rr = ControlRotate_ServiceHomeTick(tick);
 
         if (rr == ROTATE_RUNNING) break;
 
@@ -143,7 +348,7 @@ void Control_Tick(void)
             break;
         }
 
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_ROTATE);
         g_phase  = CONTROL_PHASE_IDLE;
         break;
     }
@@ -153,18 +358,23 @@ void Control_Tick(void)
      * ------------------------------------------------------------- */
     case CONTROL_PHASE_TILT:
     {
-        float actual_volt = 0.0f;
-        TiltResult_t tr = ControlTilt_Service(&actual_volt);
+        TiltResult_t tr = ControlTilt_ServiceTick(tick, NULL);
 
         if (tr == TILT_RUNNING) break;
 
+        if (tr == TILT_OK && g_program_active) {
+            g_step++;
+            BeginStep();
+            break;
+        }
+
         if (tr == TILT_OK) {
             RotateResult_t rr =
                 ControlRotate_RotateMoveToDegree(g_session.rotate_dir,
                                                  (float)g_session.rotate_num);
 
             if (rr == ROTATE_ERROR) {
-                g_status = MACHINE_STATUS_FAULT;
+                SetFault(CONTROL_FAULT_ROTATE);
                 g_phase  = CONTROL_PHASE_IDLE;
             } else if (rr == ROTATE_OK) {
                 g_status = MACHINE_STATUS_DONE;
@@ -180,7 +390,7 @@ void Control_Tick(void)
             break;
         }
 
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_TILT);
         g_phase  = CONTROL_PHASE_IDLE;
         break;
     }
@@ -190,10 +400,16 @@ void Control_Tick(void)
      * ------------------------------------------------------------- */
     case CONTROL_PHASE_ROTATE:
     {
-        RotateResult_t rr = ControlRotate_Service();
+        RotateResult_t rr = ControlRotate_ServiceTick(tick);
 
         if (rr == ROTATE_RUNNING) break;
 
+        if (rr == ROTATE_OK && g_program_active) {
+            g_step++;
+            BeginStep();
+            break;
+        }
+
         if (rr == ROTATE_OK) {
             g_status = MACHINE_STATUS_DONE;
             g_phase  = CONTROL_PHASE_DONE;
@@ -205,11 +421,29 @@ void Control_Tick(void)
             break;
         }
 
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_ROTATE);
         g_phase  = CONTROL_PHASE_IDLE;
         break;
     }
 
+    /* -------------------------------------------------------------
+     * HOMING / SESSION: BOTH AXES
+     * ------------------------------------------------------------- */
+    case CONTROL_PHASE_HOME_BOTH:
+    case CONTROL_PHASE_BOTH:
+        ServiceBoth(tick);
+        break;
+
+    /* -------------------------------------------------------------
+     * PROGRAM: DWELL
+     * ------------------------------------------------------------- */
+    case CONTROL_PHASE_DWELL:
+        if (ControlTick_Ms(tick) >= g_dwell_until_ms) {
+            g_step++;
+            BeginStep();
+        }
+        break;
+
     case CONTROL_PHASE_DONE:
     case CONTROL_PHASE_IDLE:
     default:
@@ -217,6 +451,306 @@ void Control_Tick(void)
     }
 }
 
+/**
+ * @brief Service both engines of an overlapped phase in the same tick.
+ *
+ * A fault on one axis stops the other.
+ *
+ * @param tick Context of the current tick, shared by both engines.
+ */
+static void ServiceBoth(ControlTick_t *tick)
+{
+    int home   = (g_phase == CONTROL_PHASE_HOME_BOTH);
+    int paused = 0;
+
+    if (g_tilt_busy) {
+        TiltResult_t tr = home ? ControlTilt_ServiceHomeTick(tick)
+                               : ControlTilt_ServiceTick(tick, NULL);
+
+        if (tr == TILT_OK) {
+            g_tilt_busy = 0;
+        } else if (tr == TILT_PAUSED) {
+            paused = 1;
+        } else if (tr != TILT_RUNNING) {
+            ControlRotate_Stop();
+            SetFault(CONTROL_FAULT_TILT);
+            g_phase = CONTROL_PHASE_IDLE;
+            return;
+        }
+    }
+
+    if (g_rotate_busy) {
+        RotateResult_t rr = home ? ControlRotate_ServiceHomeTick(tick)
+                                 : ControlRotate_ServiceTick(tick);
+
+        if (rr == ROTATE_OK) {
+            g_rotate_busy = 0;
+        } else if (rr == ROTATE_PAUSED) {
+            paused = 1;
+        } else if (rr != ROTATE_RUNNING) {
+            ControlTilt_Pause();
+            SetFault(CONTROL_FAULT_ROTATE);
+            g_phase = CONTROL_PHASE_IDLE;
+            return;
+        }
+    }
+
+    if (paused) {
+        g_status = MACHINE_STATUS_PAUSED;
+        return;
+    }
+
+    if (!g_tilt_busy && !g_rotate_busy) {
+        g_status = home ? MACHINE_STATUS_READY : MACHINE_STATUS_DONE;
+        g_phase  = home ? CONTROL_PHASE_IDLE   : CONTROL_PHASE_DONE;
+    }
+}
+
+/* -------------------------------------------------------------------------
+ * Axis overlap
+ * ------------------------------------------------------------------------- */
+
+void Control_SetInterlock(const ControlInterlock_t *interlock)
+{
+    g_interlock = *interlock;
+}
+
+void Control_GetInterlock(ControlInterlock_t *interlock)
+{
+    *interlock = g_interlock;
+}
+
+/**
+ * @brief Check whether the interlock lets this session move both axes.
+ */
+static int SessionMayOverlap(const SessionConfig_t *cfg)
+{
+    if (!cfg->overlap || !(g_interlock.allow & CONTROL_OVERLAP_SESSION))
+        return 0;
+
+    if ((float)cfg->tilt_degree > g_interlock.max_tilt_degree)
+        return 0;
+
+    return ControlTilt_ReadDegree() <= g_interlock.max_tilt_degree;
+}
+
+/**
+ * @brief Check whether the interlock lets homing move both axes.
+ *
+ * Tilt homes downwards, so only the starting tilt can exceed the limit.
+ */
+static int HomeMayOverlap(void)
+{
+    if (!(g_interlock.allow & CONTROL_OVERLAP_HOME))
+        return 0;
+
+    return ControlTilt_ReadDegree() <= g_interlock.max_tilt_degree;
+}
+
+/**
+ * @brief Start both axes of a home (home = 1) or of g_session.
+ *
+ * @return 0 on success, -1 on failure (nothing left moving).
+ */
+static int BeginBoth(int home)
+{
+    TiltResult_t   tr;
+    RotateResult_t rr;
+
+    tr = home ? ControlTilt_BeginHome()
+              : ControlTilt_BeginMoveToDegree(g_session.tilt_degree);
+
+    if (tr == TILT_ERROR || tr == TILT_STOPPED) {
+        SetFault(CONTROL_FAULT_TILT);
+        g_phase = CONTROL_PHASE_IDLE;
+        return -1;
+    }
+
+    rr = home ? ControlRotate_RotateHome()
+              : ControlRotate_RotateMoveToDegree(g_session.rotate_dir,
+                                                 (float)g_session.rotate_num);
+
+    if (rr == ROTATE_ERROR) {
+        ControlTilt_Pause();
+        SetFault(CONTROL_FAULT_ROTATE);
+        g_phase = CONTROL_PHASE_IDLE;
+        return -1;
+    }
+
+    g_tilt_busy   = (tr != TILT_OK);
+    g_rotate_busy = (rr != ROTATE_OK);
+    g_status      = MACHINE_STATUS_RUNNING;
+    g_phase       = home ? CONTROL_PHASE_HOME_BOTH : CONTROL_PHASE_BOTH;
+
+    /* Both already there */
+    if (!g_tilt_busy && !g_rotate_busy) {
+        g_status = home ? MACHINE_STATUS_READY : MACHINE_STATUS_DONE;
+        g_phase  = home ? CONTROL_PHASE_IDLE   : CONTROL_PHASE_DONE;
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------------------
+ * Session programs
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Check step k against the current calibration ahead of time.
+ *
+ * Called when step k - 1 begins, so the check and the degree-to-volt
+ * conversion are off the step boundary.
+ *
+ * @return 0 if step k can begin (or there is no step k), -1 otherwise.
+ */
+static int PrepareStep(int k)
+{
+    const ProgramStep_t *s;
+
+    if (k >= g_program.count) return 0;
+
+    s = &g_program.steps[k];
+    if (s->op == PROGRAM_OP_TILT) {
+        if (!ControlTilt_CheckDegree((float)s->value)) return -1;
+        g_next_volt = ControlTilt_TiltToVolt((float)s->value);
+    }
+    return 0;
+}
+
+/**
+ * @brief Forget the running program; the next phase end finishes normally.
+ */
+static void EndProgram(void)
+{
+    if (g_program_active) {
+        g_program_end_ms = TimeSource_NowMs();
+    }
+    g_program_active = 0;
+}
+
+/**
+ * @brief Begin step g_step of the program.
+ *
+ * A step that completes at once (tilt already at target) is passed in the
+ * same call, so consecutive steps never leave an idle tick between them.
+ */
+static void BeginStep(void)
+{
+    while (g_step < g_program.count) {
+        const ProgramStep_t *s = &g_program.steps[g_step];
+
+        if (!g_next_ok) {
+            SetFault(CONTROL_FAULT_SESSION);
+            g_phase = CONTROL_PHASE_IDLE;
+            return;
+        }
+
+        g_step_volt = g_next_volt;
+        g_next_ok   = (PrepareStep(g_step + 1) == 0);
+        g_status    = MACHINE_STATUS_RUNNING;
+
+        if (s->op == PROGRAM_OP_TILT) {
+            TiltResult_t tr = ControlTilt_BeginMoveToVolt(g_step_volt);
+
+            if (tr == TILT_RUNNING) {
+                g_phase = CONTROL_PHASE_TILT;
+                return;
+            }
+            if (tr != TILT_OK) {
+                SetFault(CONTROL_FAULT_TILT);
+                g_phase = CONTROL_PHASE_IDLE;
+                return;
+            }
+        }
+        else if (s->op == PROGRAM_OP_ROTATE) {
+            RotateResult_t rr =
+                ControlRotate_RotateMoveToDegree(s->dir, (float)s->value);
+
+            if (rr == ROTATE_RUNNING) {
+                g_phase = CONTROL_PHASE_ROTATE;
+                return;
+            }
+            if (rr != ROTATE_OK) {
+                SetFault(CONTROL_FAULT_ROTATE);
+                g_phase = CONTROL_PHASE_IDLE;
+                return;
+            }
+        }
+        else {
+            g_dwell_until_ms = TimeSource_NowMs() + (uint64_t)s->value;
+            g_phase = CONTROL_PHASE_DWELL;
+            return;
+        }
+
+        g_step++;
+    }
+
+    g_status = MACHINE_STATUS_DONE;
+    g_phase  = CONTROL_PHASE_DONE;
+    EndProgram();
+}
+
+/**
+ * @brief Start a compiled program (non-blocking).
+ *
+ * @param program Compiled program (copied).
+ * @return 0 on success, -1 on failure.
+ */
+int Control_StartProgram(const ControlProgram_t *program)
+{
+    if (g_status != MACHINE_STATUS_READY &&
+        g_status != MACHINE_STATUS_DONE)
+    {
+        SetFault(CONTROL_FAULT_STATE);
+        return -1;
+    }
+
+    if (!program || program->count <= 0 ||
+        program->count > CONTROL_PROGRAM_MAX_STEPS) {
+        SetFault(CONTROL_FAULT_SESSION);
+        return -1;
+    }
+
+    if (Control_CheckCalibration() != 0) return -1;
+    if (Control_CheckHome() != 0)        return -1;
+
+    g_program.count = program->count;
+    for (int i = 0; i < program->count; i++) {
+        g_program.steps[i] = program->steps[i];
+    }
+
+    g_program_active   = 1;
+    g_step             = 0;
+    g_next_ok          = (PrepareStep(0) == 0);
+    g_program_start_ms = TimeSource_NowMs();
+
+    BeginStep();
+    return (g_status == MACHINE_STATUS_FAULT) ? -1 : 0;
+}
+
+/**
+ * @brief Progress of the running (or last) program.
+ */
+int Control_GetProgramStep(int *total)
+{
+    if (total) *total = g_program.count;
+
+    if (g_program.count == 0) return 0;
+    return (g_step < g_program.count) ? g_step + 1 : g_program.count;
+}
+
+/**
+ * @brief Time the running (or last) program has taken.
+ */
+uint64_t Control_GetProgramMs(void)
+{
+    uint64_t end;
+
+    if (g_program.count == 0) return 0;
+
+    end = g_program_active ? TimeSource_NowMs() : g_program_end_ms;
+    return end - g_program_start_ms;
+}
+
 /* -------------------------------------------------------------------------
  * Calibration and Home Checks
  * ------------------------------------------------------------------------- */
@@ -232,7 +766,7 @@ int Control_CheckCalibration(void)
     int rot_ok  = CalibrationRotate_Check();
 
     if (!tilt_ok || !rot_ok) {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_CALIBRATION);
         return -1;
     }
     return 0;
@@ -249,7 +783,7 @@ int Control_CheckHome(void)
     int rot_ok  = ControlRotate_CheckHome();
 
     if (!tilt_ok || !rot_ok) {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_NOT_HOMED);
         return -1;
     }
     return 0;
@@ -267,7 +801,7 @@ int Control_CheckHome(void)
 int Control_CalibrateTilt(void)
 {
     if (CalibrationTilt_Run() != 0) {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_CALIBRATION);
         return -1;
     }
     return 0;
@@ -281,7 +815,7 @@ int Control_CalibrateTilt(void)
 int Control_CalibrateRotate(void)
 {
     if (CalibrationRotate_Run() != 0) {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_CALIBRATION);
         return -1;
     }
     return 0;
@@ -301,14 +835,21 @@ int Control_BeginHome(void)
     if (g_status != MACHINE_STATUS_READY &&
         g_status != MACHINE_STATUS_DONE)
     {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_STATE);
         return -1;
     }
 
+    EndProgram();
+    g_program.count = 0;
+
+    if (HomeMayOverlap()) {
+        return BeginBoth(1);
+    }
+
     TiltResult_t tr = ControlTilt_BeginHome();
 
     if (tr == TILT_ERROR) {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_TILT);
         return -1;
     }
 
@@ -316,7 +857,7 @@ int Control_BeginHome(void)
         RotateResult_t rr = ControlRotate_RotateHome();
 
         if (rr == ROTATE_ERROR) {
-            g_status = MACHINE_STATUS_FAULT;
+            SetFault(CONTROL_FAULT_ROTATE);
             return -1;
         }
 
@@ -347,7 +888,7 @@ int Control_Home(void)
 
     while (g_status == MACHINE_STATUS_RUNNING) {
         Control_Tick();
-        usleep(1000);
+        TimeSource_SleepMs(1);
     }
 
     return (g_status == MACHINE_STATUS_READY) ? 0 : -1;
@@ -368,12 +909,12 @@ int Control_StartSession(const SessionConfig_t *cfg)
     if (g_status != MACHINE_STATUS_READY &&
         g_status != MACHINE_STATUS_DONE)
     {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_STATE);
         return -1;
     }
 
     if (CheckSession(cfg) != 0) {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_SESSION);
         return -1;
     }
 
@@ -381,12 +922,18 @@ int Control_StartSession(const SessionConfig_t *cfg)
     if (Control_CheckHome() != 0)        return -1;
 
     g_session = *cfg;
+    EndProgram();
+    g_program.count = 0;
+
+    if (SessionMayOverlap(cfg)) {
+        return BeginBoth(0);
+    }
 
     TiltResult_t tr =
         ControlTilt_BeginMoveToDegree(cfg->tilt_degree);
 
     if (tr == TILT_ERROR || tr == TILT_STOPPED) {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_TILT);
         g_phase  = CONTROL_PHASE_IDLE;
         return -1;
     }
@@ -397,7 +944,7 @@ int Control_StartSession(const SessionConfig_t *cfg)
                                              (float)cfg->rotate_num);
 
         if (rr == ROTATE_ERROR) {
-            g_status = MACHINE_STATUS_FAULT;
+            SetFault(CONTROL_FAULT_ROTATE);
             g_phase  = CONTROL_PHASE_IDLE;
             return -1;
         }
@@ -430,17 +977,53 @@ int Control_StartSession(const SessionConfig_t *cfg)
 int Control_PauseSession(void)
 {
     if (g_status != MACHINE_STATUS_RUNNING) {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_STATE);
         return -1;
     }
 
     ControlTilt_Pause();
     ControlRotate_Pause();
 
+    if (g_phase == CONTROL_PHASE_DWELL) {
+        uint64_t now = TimeSource_NowMs();
+        g_dwell_left_ms = (g_dwell_until_ms > now) ? g_dwell_until_ms - now : 0;
+    }
+
     g_status = MACHINE_STATUS_PAUSED;
     return 0;
 }
 
+/**
+ * @brief Restart the interrupted program step.
+ *
+ * @return 0 on success, -1 if the step could not be restarted.
+ */
+static int ResumeStep(void)
+{
+    const ProgramStep_t *s = &g_program.steps[g_step];
+
+    if (g_phase == CONTROL_PHASE_TILT &&
+        ControlTilt_BeginMoveToVolt(g_step_volt) == TILT_ERROR) {
+        SetFault(CONTROL_FAULT_TILT);
+        g_phase = CONTROL_PHASE_IDLE;
+        return -1;
+    }
+
+    if (g_phase == CONTROL_PHASE_ROTATE &&
+        ControlRotate_RotateMoveToDegree(s->dir, (float)s->value) == ROTATE_ERROR) {
+        SetFault(CONTROL_FAULT_ROTATE);
+        g_phase = CONTROL_PHASE_IDLE;
+        return -1;
+    }
+
+    if (g_phase == CONTROL_PHASE_DWELL) {
+        g_dwell_until_ms = TimeSource_NowMs() + g_dwell_left_ms;
+    }
+
+    g_status = MACHINE_STATUS_RUNNING;
+    return 0;
+}
+
 /**
  * @brief Resume a paused session.
  *
@@ -449,15 +1032,19 @@ int Control_PauseSession(void)
 int Control_ResumeSession(void)
 {
     if (g_status != MACHINE_STATUS_PAUSED) {
-        g_status = MACHINE_STATUS_FAULT;
+        SetFault(CONTROL_FAULT_STATE);
         return -1;
     }
 
+    if (g_program_active) {
+        return ResumeStep();
+    }
+
     if (g_phase == CONTROL_PHASE_TILT) {
         TiltResult_t tr =
             ControlTilt_BeginMoveToDegree(g_session.tilt_degree);
         if (tr == TILT_ERROR) {
-            g_status = MACHINE_STATUS_FAULT;
+            SetFault(CONTROL_FAULT_TILT);
             g_phase  = CONTROL_PHASE_IDLE;
             return -1;
         }
@@ -467,11 +1054,53 @@ int Control_ResumeSession(void)
             ControlRotate_RotateMoveToDegree(g_session.rotate_dir,
                                              (float)g_session.rotate_num);
         if (rr == ROTATE_ERROR) {
-            g_status = MACHINE_STATUS_FAULT;
+            SetFault(CONTROL_FAULT_ROTATE);
+            g_phase  = CONTROL_PHASE_IDLE;
+            return -1;
+        }
+    }
+    else if (g_phase == CONTROL_PHASE_BOTH) {
+        if (g_tilt_busy &&
+            ControlTilt_BeginMoveToDegree(g_session.tilt_degree) == TILT_ERROR) {
+            ControlRotate_Stop();
+            SetFault(CONTROL_FAULT_TILT);
+            g_phase  = CONTROL_PHASE_IDLE;
+            return -1;
+        }
+        if (g_rotate_busy &&
+            ControlRotate_RotateMoveToDegree(g_session.rotate_dir,
+                                             (float)g_session.rotate_num) == ROTATE_ERROR) {
+            ControlTilt_Pause();
+            SetFault(CONTROL_FAULT_ROTATE);
             g_phase  = CONTROL_PHASE_IDLE;
             return -1;
         }
     }
+    else if (g_phase == CONTROL_PHASE_HOME_BOTH) {
+        /* Pause left both home engines inactive: restart the unfinished ones */
+        if (g_tilt_busy) {
+            TiltResult_t tr = ControlTilt_BeginHome();
+
+            if (tr == TILT_ERROR || tr == TILT_STOPPED) {
+                ControlRotate_Stop();
+                SetFault(CONTROL_FAULT_TILT);
+                g_phase  = CONTROL_PHASE_IDLE;
+                return -1;
+            }
+            g_tilt_busy = (tr != TILT_OK);
+        }
+        if (g_rotate_busy) {
+            RotateResult_t rr = ControlRotate_RotateHome();
+
+            if (rr == ROTATE_ERROR) {
+                ControlTilt_Pause();
+                SetFault(CONTROL_FAULT_ROTATE);
+                g_phase  = CONTROL_PHASE_IDLE;
+                return -1;
+            }
+            g_rotate_busy = (rr != ROTATE_OK);
+        }
+    }
 
     g_status = MACHINE_STATUS_RUNNING;
     return 0;
@@ -486,8 +1115,9 @@ int Control_StopSession(void)
 {
     ControlTilt_Pause();
     ControlRotate_Stop();
-    g_status = MACHINE_STATUS_FAULT;
+    SetFault(CONTROL_FAULT_STOPPED);
     g_phase  = CONTROL_PHASE_IDLE;
+    EndProgram();
     return 0;
 }
 
@@ -505,12 +1135,56 @@ MachineStatus_t Control_GetStatus(void)
     return g_status;
 }
 
+/**
+ * @brief Reason for the last FAULT.
+ */
+ControlFault_t Control_GetFault(void)
+{
+    return g_fault;
+}
+
 /**
  * @brief Notify the control system that ESTOP is active.
+ *
+ * Safe to call from another thread (the safety thread, safety.h); the
+ * control thread sees the latch at its next ESTOP check.
  */
 void Control_NotifyEStopActive(void)
 {
-    g_estop_latched = 1;
+    __atomic_store_n(&g_estop_latched, 1, __ATOMIC_RELEASE);
+}
+
+/* -------------------------------------------------------------------------
+ * Status snapshot
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Publish the status snapshot (control_status.h).
+ *
+ * Axis positions and the timestamp are those of the tick.
+ *
+ * @param tick Context of the current tick.
+ */
+static void PublishStatus(ControlTick_t *tick)
+{
+    ControlStatus_t st;
+
+    st.publish_count  = ++g_publish_count;
+    st.t_us           = tick->t_us;
+    st.status         = g_status;
+    st.phase          = g_phase;
+    st.fault          = g_fault;
+    st.estop_latched  = __atomic_load_n(&g_estop_latched, __ATOMIC_ACQUIRE);
+    st.outputs_forced = hal_forced();
+    st.tilt_volts     = ControlTilt_ReadVolt();
+    st.tilt_degree    = ControlTilt_ReadDegree();
+    st.rotate_degree  = ControlRotate_ReadDegree();
+    st.session        = g_session;
+    st.last_cmd       = ControlCmd_LastCompleted();
+    st.program_step   = Control_GetProgramStep(&st.program_steps);
+    st.program_ms     = Control_GetProgramMs();
+
+    ControlStatus_Publish(&st);
 }
 
 /* -------------------------------------------------------------------------
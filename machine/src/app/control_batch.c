@@ -0,0 +1,233 @@
+/**
+ * @file control_batch.c
+ * @brief Batch of sessions, reordered to minimise tilt travel.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "control_batch.h"
+#include "control_tilt.h"
+#include "control_rotate.h"
+
+/* -------------------------------------------------------------------------
+ * Model
+ * ------------------------------------------------------------------------- */
+
+void ControlBatch_DefaultModel(ControlBatchModel_t *model)
+{
+    model->tilt_sec_per_degree = ControlTilt_SecPerDegree();
+    model->rotate_deg_per_sec  = ControlRotate_DegPerSec();
+    model->move_overhead_s     = CONTROL_BATCH_MOVE_OVERHEAD_S;
+}
+
+static float TiltTime(float from, float to, const ControlBatchModel_t *m)
+{
+    float d = fabsf(to - from);
+
+    return (d > 0.0f) ? d * m->tilt_sec_per_degree + m->move_overhead_s : 0.0f;
+}
+
+static float RotateTime(int degrees, const ControlBatchModel_t *m)
+{
+    if (degrees <= 0 || m->rotate_deg_per_sec <= 0.0f) return 0.0f;
+    return (float)degrees / m->rotate_deg_per_sec + m->move_overhead_s;
+}
+
+static float Tilt(const ControlBatchEntry_t *e)
+{
+    return (float)e->session.tilt_degree;
+}
+
+float ControlBatch_Predict(const ControlBatchEntry_t *entries, const int *order, int n,
+                           float start_degree, const ControlBatchModel_t *model)
+{
+    float pos = start_degree;
+    float t   = 0.0f;
+
+    for (int k = 0; k < n; k++) {
+        const ControlBatchEntry_t *e = &entries[order[k]];
+
+        t  += TiltTime(pos, Tilt(e), model) + RotateTime(e->session.rotate_num, model);
+        pos = Tilt(e);
+    }
+    return t;
+}
+
+/* -------------------------------------------------------------------------
+ * Planner
+ * ------------------------------------------------------------------------- */
+
+/* Stable insertion sort of entry indexes by tilt */
+static void SortByTilt(const ControlBatchEntry_t *entries, int *idx, int k, int descending)
+{
+    for (int i = 1; i < k; i++) {
+        int v = idx[i];
+        int j = i - 1;
+
+        while (j >= 0 && (descending ? Tilt(&entries[idx[j]]) < Tilt(&entries[v])
+                                     : Tilt(&entries[idx[j]]) > Tilt(&entries[v]))) {
+            idx[j + 1] = idx[j];
+            j--;
+        }
+        idx[j + 1] = v;
+    }
+}
+
+/*
+ * Sweep from pos: one side first (sorted away from pos), then the other.
+ * Entries at the tilt of the next pinned entry go last: the final move is
+ * then zero and saves its overhead, at no extra travel.
+ */
+static void Sweep(const ControlBatchEntry_t *entries, int first, int last, float pos,
+                  const float *end, int down_first, int *out)
+{
+    int near[CONTROL_BATCH_MAX], far[CONTROL_BATCH_MAX], tail[CONTROL_BATCH_MAX];
+    int nn = 0, nf = 0, nt = 0;
+
+    for (int i = first; i < last; i++) {
+        float t = Tilt(&entries[i]);
+
+        if (end && t == *end)
+            tail[nt++] = i;
+        else if (down_first ? (t <= pos) : (t >= pos))
+            near[nn++] = i;
+        else
+            far[nf++] = i;
+    }
+
+    SortByTilt(entries, near, nn, down_first);
+    SortByTilt(entries, far,  nf, !down_first);
+
+    for (int i = 0; i < nn; i++) out[i]           = near[i];
+    for (int i = 0; i < nf; i++) out[nn + i]      = far[i];
+    for (int i = 0; i < nt; i++) out[nn + nf + i] = tail[i];
+}
+
+/* Tilt time of a run from pos, plus the move on to the next pinned entry */
+static float RunTime(const ControlBatchEntry_t *entries, const int *seq, int k, float pos,
+                     const float *end, const ControlBatchModel_t *m)
+{
+    float t = 0.0f;
+
+    for (int i = 0; i < k; i++) {
+        t  += TiltTime(pos, Tilt(&entries[seq[i]]), m);
+        pos = Tilt(&entries[seq[i]]);
+    }
+    if (end) t += TiltTime(pos, *end, m);
+    return t;
+}
+
+/**
+ * @brief Order the unpinned run [first, last) starting from tilt pos.
+ */
+static void PlanRun(const ControlBatchEntry_t *entries, int first, int last, float pos,
+                    const float *end, const ControlBatchModel_t *m, int *out)
+{
+    int   k = last - first;
+    int   cand[CONTROL_BATCH_MAX];
+    float best;
+
+    for (int i = 0; i < k; i++) out[i] = first + i;
+    best = RunTime(entries, out, k, pos, end, m);
+
+    for (int down_first = 0; down_first <= 1; down_first++) {
+        float t;
+
+        Sweep(entries, first, last, pos, end, down_first, cand);
+        t = RunTime(entries, cand, k, pos, end, m);
+        if (t < best) {
+            best = t;
+            for (int i = 0; i < k; i++) out[i] = cand[i];
+        }
+    }
+}
+
+int ControlBatch_Plan(const ControlBatchEntry_t *entries, int n, float start_degree,
+                      const ControlBatchModel_t *model, ControlBatchPlan_t *plan)
+{
+    float pos = start_degree;
+    int   i   = 0;
+
+    if (!entries || !model || !plan || n <= 0 || n > CONTROL_BATCH_MAX)
+        return -1;
+
+    for (int k = 0; k < n; k++) {
+        const SessionConfig_t *s = &entries[k].session;
+
+        if (s->tilt_degree < 0 || s->tilt_degree > 90 || s->rotate_num < 0 ||
+            (s->rotate_dir != ROTATE_DIR_CW && s->rotate_dir != ROTATE_DIR_CCW))
+            return -1;
+        plan->order[k] = k;
+    }
+    plan->count       = n;
+    plan->submitted_s = ControlBatch_Predict(entries, plan->order, n, start_degree, model);
+
+    while (i < n) {
+        int   j = i;
+        float end;
+
+        if (entries[i].pinned) {
+            pos = Tilt(&entries[i]);
+            i++;
+            continue;
+        }
+
+        while (j < n && !entries[j].pinned) j++;
+
+        if (j < n) end = Tilt(&entries[j]);
+        PlanRun(entries, i, j, pos, (j < n) ? &end : NULL, model, &plan->order[i]);
+
+        pos = Tilt(&entries[plan->order[j - 1]]);
+        i   = j;
+    }
+
+    plan->predicted_s = ControlBatch_Predict(entries, plan->order, n, start_degree, model);
+    return 0;
+}
+
+/* -------------------------------------------------------------------------
+ * Program and report
+ * ------------------------------------------------------------------------- */
+
+int ControlBatch_Build(const ControlBatchEntry_t *entries, const ControlBatchPlan_t *plan,
+                       ControlProgram_t *program)
+{
+    ProgramStep_t src[2 * CONTROL_BATCH_MAX];
+    int n = 0;
+
+    if (!entries || !plan || !program || plan->count <= 0 || plan->count > CONTROL_BATCH_MAX)
+        return -1;
+
+    for (int k = 0; k < plan->count; k++) {
+        const SessionConfig_t *s = &entries[plan->order[k]].session;
+
+        src[n].op    = PROGRAM_OP_TILT;
+        src[n].value = s->tilt_degree;
+        src[n].dir   = ROTATE_DIR_CW;
+        n++;
+
+        src[n].op    = PROGRAM_OP_ROTATE;
+        src[n].value = s->rotate_num;
+        src[n].dir   = s->rotate_dir;
+        n++;
+    }
+    return ControlProgram_Compile(src, n, program);
+}
+
+void ControlBatch_PrintReport(const ControlBatchPlan_t *plan, uint64_t actual_ms)
+{
+    float gain = (plan->submitted_s > 0.0f)
+                 ? 100.0f * (plan->submitted_s - plan->predicted_s) / plan->submitted_s
+                 : 0.0f;
+
+    printf("Batch: %d sessions, submitted order %.1f s, planned %.1f s (%.1f%% less)\n",
+           plan->count, plan->submitted_s, plan->predicted_s, gain);
+
+    if (actual_ms > 0 && plan->predicted_s > 0.0f) {
+        float actual_s = (float)actual_ms / 1000.0f;
+
+        printf("Batch: actual %.1f s (%+.1f%% vs planned)\n", actual_s,
+               100.0f * (actual_s - plan->predicted_s) / plan->predicted_s);
+    }
+}
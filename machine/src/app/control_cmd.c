@@ -0,0 +1,151 @@
+/**
+ * @file control_cmd.c
+ * @brief Lock-free command queue from API threads into the control loop.
+ *
+ * Bounded MPSC ring. Slot state is kept relative to the lap of the ring so
+ * a zeroed ring is valid without initialization: for position pos, with
+ * lap = pos & ~MASK, a slot's state is
+ *
+ *   lap          free for the producer claiming pos
+ *   lap + 1      filled, ready for the consumer
+ *   lap + SIZE   consumed, free for pos + SIZE
+ */
+
+#include "control_cmd.h"
+#include "time_source.h"
+
+#define CMD_MASK  ((uint64_t)CONTROL_CMD_QUEUE_SIZE - 1)
+
+typedef struct {
+    uint64_t     state;
+    ControlCmd_t cmd;
+} CmdSlot_t;
+
+typedef struct {
+    uint64_t seq;      /* Sequence number whose result is stored, 0 = none */
+    int      result;
+} CmdDone_t;
+
+static CmdSlot_t g_slots[CONTROL_CMD_QUEUE_SIZE];
+static CmdDone_t g_done[CONTROL_CMD_QUEUE_SIZE];
+static uint64_t  g_tail    = 0;   /* Next position to claim (producers) */
+static uint64_t  g_head    = 0;   /* Next position to take (consumer) */
+static uint64_t  g_dropped = 0;
+static uint64_t  g_last    = 0;   /* Last completed sequence number */
+
+/* -------------------------------------------------------------------------
+ * Producers
+ * ------------------------------------------------------------------------- */
+
+uint64_t ControlCmd_Submit(const ControlCmd_t *cmd)
+{
+    uint64_t pos = __atomic_load_n(&g_tail, __ATOMIC_RELAXED);
+    CmdSlot_t *slot;
+
+    for (;;) {
+        uint64_t lap = pos & ~CMD_MASK;
+        uint64_t state;
+
+        slot  = &g_slots[pos & CMD_MASK];
+        state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+
+        if (state == lap) {
+            /* On failure pos is reloaded with the current tail */
+            if (__atomic_compare_exchange_n(&g_tail, &pos, pos + 1, 0,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if ((int64_t)(state - lap) < 0) {
+            /* Slot still holds the previous lap: full */
+            __atomic_add_fetch(&g_dropped, 1, __ATOMIC_RELAXED);
+            return 0;
+        } else {
+            pos = __atomic_load_n(&g_tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->cmd = *cmd;
+    __atomic_store_n(&slot->state, (pos & ~CMD_MASK) + 1, __ATOMIC_RELEASE);
+    return pos + 1;
+}
+
+int ControlCmd_Poll(uint64_t seq, int *result)
+{
+    const CmdDone_t *d = &g_done[(seq - 1) & CMD_MASK];
+    uint64_t s;
+    int r;
+
+    if (seq == 0 || seq > __atomic_load_n(&g_tail, __ATOMIC_ACQUIRE))
+        return -1;
+
+    s = __atomic_load_n(&d->seq, __ATOMIC_ACQUIRE);
+    if (s < seq)
+        return 0;
+    if (s > seq)
+        return -1;
+
+    r = __atomic_load_n(&d->result, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    /* Recycled while reading */
+    if (__atomic_load_n(&d->seq, __ATOMIC_RELAXED) != seq)
+        return -1;
+
+    if (result) *result = r;
+    return 1;
+}
+
+int ControlCmd_Wait(uint64_t seq, uint32_t timeout_ms, int *result)
+{
+    uint64_t start = TimeSource_NowMs();
+    int ret;
+
+    while ((ret = ControlCmd_Poll(seq, result)) == 0) {
+        if (TimeSource_NowMs() - start >= timeout_ms)
+            return 0;
+        TimeSource_SleepMs(1);
+    }
+    return ret;
+}
+
+uint64_t ControlCmd_LastCompleted(void)
+{
+    return __atomic_load_n(&g_last, __ATOMIC_ACQUIRE);
+}
+
+uint64_t ControlCmd_Dropped(void)
+{
+    return __atomic_load_n(&g_dropped, __ATOMIC_RELAXED);
+}
+
+/* -------------------------------------------------------------------------
+ * Consumer (control thread)
+ * ------------------------------------------------------------------------- */
+
+int ControlCmd_Next(ControlCmd_t *cmd, uint64_t *seq)
+{
+    uint64_t pos = g_head;
+    CmdSlot_t *slot = &g_slots[pos & CMD_MASK];
+
+    if (__atomic_load_n(&slot->state, __ATOMIC_ACQUIRE) != (pos & ~CMD_MASK) + 1)
+        return 0;
+
+    *cmd = slot->cmd;
+    *seq = pos + 1;
+
+    __atomic_store_n(&slot->state, (pos & ~CMD_MASK) + CONTROL_CMD_QUEUE_SIZE,
+                     __ATOMIC_RELEASE);
+    g_head = pos + 1;
+    return 1;
+}
+
+void ControlCmd_Complete(uint64_t seq, int result)
+{
+    CmdDone_t *d = &g_done[(seq - 1) & CMD_MASK];
+
+    /* Invalidate, write, publish: a reader never pairs seq with a stale result */
+    __atomic_store_n(&d->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&d->result, result, __ATOMIC_RELAXED);
+    __atomic_store_n(&d->seq, seq, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_last, seq, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,252 @@
+/**
+ * @file control_program.c
+ * @brief Session program validation, compilation and text parser.
+ *
+ * Execution lives in control.c (Control_StartProgram()).
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "control_program.h"
+
+/* -------------------------------------------------------------------------
+ * Compiler
+ * ------------------------------------------------------------------------- */
+
+static int CheckStep(const ProgramStep_t *s, int index)
+{
+    const char *why = NULL;
+
+    switch (s->op) {
+    case PROGRAM_OP_TILT:
+        if (s->value < 0 || s->value > 90)
+            why = "tilt out of range (0-90)";
+        break;
+    case PROGRAM_OP_ROTATE:
+        if (s->value < 0)
+            why = "negative rotate";
+        else if (s->dir != ROTATE_DIR_CW && s->dir != ROTATE_DIR_CCW)
+            why = "bad rotate direction";
+        break;
+    case PROGRAM_OP_DWELL:
+        if (s->value < 0 || s->value > CONTROL_PROGRAM_MAX_DWELL_MS)
+            why = "dwell out of range";
+        break;
+    case PROGRAM_OP_REPEAT:
+        if (s->value < 1 || s->value > CONTROL_PROGRAM_MAX_REPEAT)
+            why = "repeat count out of range";
+        break;
+    case PROGRAM_OP_END:
+        break;
+    default:
+        why = "unknown operation";
+        break;
+    }
+
+    if (why) {
+        fprintf(stderr, "ControlProgram: step %d: %s\n", index, why);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Emit src[*pos..] into out until the END closing this depth.
+ */
+static int Emit(const ProgramStep_t *src, int n, int *pos, ControlProgram_t *out, int depth)
+{
+    while (*pos < n) {
+        const ProgramStep_t *s = &src[*pos];
+        int index = *pos;
+
+        if (CheckStep(s, index) != 0)
+            return -1;
+        (*pos)++;
+
+        if (s->op == PROGRAM_OP_END) {
+            if (depth == 0) {
+                fprintf(stderr, "ControlProgram: step %d: end without repeat\n", index);
+                return -1;
+            }
+            return 0;
+        }
+
+        if (s->op == PROGRAM_OP_REPEAT) {
+            int first = out->count;
+            int len;
+
+            if (depth + 1 > CONTROL_PROGRAM_MAX_DEPTH) {
+                fprintf(stderr, "ControlProgram: step %d: repeat nested too deep\n", index);
+                return -1;
+            }
+            if (Emit(src, n, pos, out, depth + 1) != 0)
+                return -1;
+
+            len = out->count - first;
+            if ((long)len * s->value > CONTROL_PROGRAM_MAX_STEPS - first) {
+                fprintf(stderr, "ControlProgram: step %d: more than %d steps unrolled\n",
+                        index, CONTROL_PROGRAM_MAX_STEPS);
+                return -1;
+            }
+            for (int r = 1; r < s->value; r++) {
+                memcpy(&out->steps[out->count], &out->steps[first], len * sizeof(out->steps[0]));
+                out->count += len;
+            }
+            continue;
+        }
+
+        /* Nothing to move or wait for */
+        if ((s->op == PROGRAM_OP_ROTATE || s->op == PROGRAM_OP_DWELL) && s->value == 0)
+            continue;
+
+        if (out->count >= CONTROL_PROGRAM_MAX_STEPS) {
+            fprintf(stderr, "ControlProgram: step %d: more than %d steps\n",
+                    index, CONTROL_PROGRAM_MAX_STEPS);
+            return -1;
+        }
+        out->steps[out->count++] = *s;
+    }
+
+    if (depth > 0) {
+        fprintf(stderr, "ControlProgram: repeat without end\n");
+        return -1;
+    }
+    return 0;
+}
+
+int ControlProgram_Compile(const ProgramStep_t *src, int n, ControlProgram_t *out)
+{
+    int pos = 0;
+
+    if (!src || !out || n <= 0)
+        return -1;
+
+    out->count = 0;
+    if (Emit(src, n, &pos, out, 0) != 0)
+        return -1;
+
+    if (out->count == 0) {
+        fprintf(stderr, "ControlProgram: no steps\n");
+        return -1;
+    }
+    return out->count;
+}
+
+/* -------------------------------------------------------------------------
+ * Text parser
+ * ------------------------------------------------------------------------- */
+
+/* Copy the next word into buf; returns 0 at the end of the statement */
+static int NextWord(const char **p, char *buf, size_t len)
+{
+    size_t i = 0;
+
+    while (**p == ' ' || **p == '\t' || **p == '\r')
+        (*p)++;
+
+    while (**p && !isspace((unsigned char)**p) && **p != ';' && **p != '#') {
+        if (i + 1 < len)
+            buf[i++] = **p;
+        (*p)++;
+    }
+    buf[i] = '\0';
+    return i > 0;
+}
+
+static int ParseInt(const char *word, int *out)
+{
+    char *end;
+    long v;
+
+    errno = 0;
+    v = strtol(word, &end, 10);
+    if (errno || end == word || *end || v < -2147483647L || v > 2147483647L)
+        return -1;
+    *out = (int)v;
+    return 0;
+}
+
+/* Parse one statement (op and arguments) */
+static int ParseStatement(const char **p, ProgramStep_t *s)
+{
+    char op[16], arg[16];
+
+    memset(s, 0, sizeof(*s));
+    NextWord(p, op, sizeof(op));
+
+    if (strcmp(op, "tilt") == 0)        s->op = PROGRAM_OP_TILT;
+    else if (strcmp(op, "rotate") == 0) s->op = PROGRAM_OP_ROTATE;
+    else if (strcmp(op, "dwell") == 0)  s->op = PROGRAM_OP_DWELL;
+    else if (strcmp(op, "repeat") == 0) s->op = PROGRAM_OP_REPEAT;
+    else if (strcmp(op, "end") == 0)    s->op = PROGRAM_OP_END;
+    else return -1;
+
+    if (s->op == PROGRAM_OP_ROTATE) {
+        if (!NextWord(p, arg, sizeof(arg)))
+            return -1;
+        if (strcmp(arg, "cw") == 0)       s->dir = ROTATE_DIR_CW;
+        else if (strcmp(arg, "ccw") == 0) s->dir = ROTATE_DIR_CCW;
+        else return -1;
+    }
+
+    if (s->op != PROGRAM_OP_END) {
+        if (!NextWord(p, arg, sizeof(arg)) || ParseInt(arg, &s->value) != 0)
+            return -1;
+    }
+
+    /* Nothing else before the end of the statement */
+    return NextWord(p, arg, sizeof(arg)) ? -1 : 0;
+}
+
+int ControlProgram_Parse(const char *text, ControlProgram_t *out)
+{
+    ProgramStep_t src[CONTROL_PROGRAM_MAX_SOURCE];
+    const char *p = text;
+    int line = 1;
+    int n = 0;
+
+    if (!text || !out)
+        return -1;
+
+    while (*p) {
+        const char *start;
+        char word[16];
+
+        /* Skip blank statements and comments */
+        if (isspace((unsigned char)*p) || *p == ';') {
+            if (*p == '\n') line++;
+            p++;
+            continue;
+        }
+        if (*p == '#') {
+            while (*p && *p != '\n') p++;
+            continue;
+        }
+
+        start = p;
+        if (!NextWord(&p, word, sizeof(word)))
+            return -1;
+        p = start;
+
+        if (n >= CONTROL_PROGRAM_MAX_SOURCE) {
+            fprintf(stderr, "ControlProgram: line %d: more than %d statements\n",
+                    line, CONTROL_PROGRAM_MAX_SOURCE);
+            return -1;
+        }
+        if (ParseStatement(&p, &src[n]) != 0) {
+            fprintf(stderr, "ControlProgram: line %d: cannot parse '%s'\n", line, word);
+            return -1;
+        }
+        n++;
+    }
+
+    if (n == 0) {
+        fprintf(stderr, "ControlProgram: no steps\n");
+        return -1;
+    }
+    return ControlProgram_Compile(src, n, out);
+}
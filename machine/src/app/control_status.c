@@ -0,0 +1,133 @@
+/**
+ * @file control_status.c
+ * @brief Seqlock-published machine status snapshot.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "control_status.h"
+
+static ControlStatusBlock_t g_local = {
+    .magic   = CONTROL_STATUS_MAGIC,
+    .version = CONTROL_STATUS_VERSION,
+    .size    = sizeof(ControlStatusBlock_t),
+};
+
+/* Block being published to: g_local, or the shm mapping after Share() */
+static ControlStatusBlock_t *g_blk = &g_local;
+
+/* -------------------------------------------------------------------------
+ * Writer
+ * ------------------------------------------------------------------------- */
+
+void ControlStatus_Publish(const ControlStatus_t *st)
+{
+    ControlStatusBlock_t *blk = g_blk;
+    uint32_t seq = blk->seq;
+
+    __atomic_store_n(&blk->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&blk->status, st, sizeof(*st));
+    __atomic_store_n(&blk->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/* -------------------------------------------------------------------------
+ * Readers
+ * ------------------------------------------------------------------------- */
+
+int ControlStatus_ReadBlock(const ControlStatusBlock_t *blk, ControlStatus_t *out)
+{
+    for (int i = 0; i < CONTROL_STATUS_RETRIES; i++) {
+        uint32_t s1 = __atomic_load_n(&blk->seq, __ATOMIC_ACQUIRE);
+
+        if (s1 & 1)
+            continue;
+
+        memcpy(out, &blk->status, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if (__atomic_load_n(&blk->seq, __ATOMIC_RELAXED) == s1)
+            return 0;
+    }
+    return -1;
+}
+
+int ControlStatus_Read(ControlStatus_t *out)
+{
+    return ControlStatus_ReadBlock(__atomic_load_n(&g_blk, __ATOMIC_ACQUIRE), out);
+}
+
+/* -------------------------------------------------------------------------
+ * Shared memory
+ * ------------------------------------------------------------------------- */
+
+int ControlStatus_Share(const char *name)
+{
+    ControlStatusBlock_t *blk;
+    int fd;
+
+    if (g_blk != &g_local)
+        return -1;
+
+    fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "ControlStatus: shm_open %s: %s\n", name, strerror(errno));
+        return -1;
+    }
+
+    if (ftruncate(fd, sizeof(*blk)) < 0) {
+        fprintf(stderr, "ControlStatus: ftruncate %s: %s\n", name, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    blk = mmap(NULL, sizeof(*blk), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (blk == MAP_FAILED) {
+        fprintf(stderr, "ControlStatus: mmap %s: %s\n", name, strerror(errno));
+        return -1;
+    }
+
+    /* Even sequence, current snapshot, then the header readers check */
+    blk->seq = 0;
+    memcpy(&blk->status, &g_local.status, sizeof(blk->status));
+    blk->version = CONTROL_STATUS_VERSION;
+    blk->size    = sizeof(*blk);
+    __atomic_store_n(&blk->magic, CONTROL_STATUS_MAGIC, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&g_blk, blk, __ATOMIC_RELEASE);
+    return 0;
+}
+
+const ControlStatusBlock_t *ControlStatus_Attach(const char *name)
+{
+    ControlStatusBlock_t *blk;
+    int fd = shm_open(name, O_RDONLY, 0);
+
+    if (fd < 0)
+        return NULL;
+
+    blk = mmap(NULL, sizeof(*blk), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (blk == MAP_FAILED)
+        return NULL;
+
+    if (__atomic_load_n(&blk->magic, __ATOMIC_ACQUIRE) != CONTROL_STATUS_MAGIC ||
+        blk->version != CONTROL_STATUS_VERSION ||
+        blk->size != sizeof(*blk)) {
+        munmap(blk, sizeof(*blk));
+        return NULL;
+    }
+    return blk;
+}
+
+void ControlStatus_Detach(const ControlStatusBlock_t *blk)
+{
+    if (blk)
+        munmap((void *)blk, sizeof(*blk));
+}
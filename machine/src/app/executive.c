@@ -0,0 +1,129 @@
+/**
+ * @file executive.c
+ * @brief Multi-rate cyclic executive on one base tick.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "executive.h"
+#include "io_scan.h"
+#include "hal.h"
+#include "time_source.h"
+
+typedef struct
+{
+    ExecTaskStats_t stats;
+    ExecTaskFn_t    fn;
+    uint32_t        divider;   /* Run every divider base ticks */
+    int             id;        /* Registration order */
+} ExecTask_t;
+
+static uint32_t   g_base_us = 1000U;
+static ExecTask_t g_tasks[EXEC_MAX_TASKS];
+static int        g_num_tasks = 0;
+static ExecTick_t g_tick = { 0, 0 };
+static int        g_in_tick = 0;
+static int        g_in_task = 0;
+
+void Exec_Init(uint32_t base_us)
+{
+    g_base_us   = base_us ? base_us : 1U;
+    g_num_tasks = 0;
+    g_tick.count = 0;
+    g_tick.t_us  = 0;
+    memset(g_tasks, 0, sizeof(g_tasks));
+}
+
+int Exec_AddTask(const char *name, uint32_t period_us, int priority,
+                 ExecTaskFn_t fn)
+{
+    ExecTask_t t;
+    int i;
+
+    if (!fn || g_num_tasks >= EXEC_MAX_TASKS)
+        return -1;
+
+    memset(&t, 0, sizeof(t));
+    t.fn      = fn;
+    t.id      = g_num_tasks;
+    t.divider = (period_us + g_base_us / 2) / g_base_us;
+    if (t.divider == 0) t.divider = 1;
+
+    t.stats.name      = name ? name : "task";
+    t.stats.period_us = t.divider * g_base_us;
+    t.stats.priority  = priority;
+
+    /* Keep the table sorted by priority; equal priorities keep their order */
+    for (i = g_num_tasks; i > 0 && g_tasks[i - 1].stats.priority > priority; i--)
+        g_tasks[i] = g_tasks[i - 1];
+    g_tasks[i] = t;
+    g_num_tasks++;
+
+    return t.id;
+}
+
+void Exec_Tick(void)
+{
+    io_scan_inputs();
+
+    g_tick.t_us = hal_cycle().t_us;
+    g_in_tick = 1;
+
+    for (int i = 0; i < g_num_tasks; i++) {
+        ExecTask_t *t = &g_tasks[i];
+        uint64_t start, exec;
+
+        if (g_tick.count % t->divider != 0)
+            continue;
+
+        start = TimeSource_NowUs();
+        g_in_task = 1;
+        t->fn(&g_tick);
+        g_in_task = 0;
+        exec = TimeSource_NowUs() - start;
+
+        t->stats.runs++;
+        if (exec > t->stats.exec_max_us) t->stats.exec_max_us = exec;
+    }
+
+    g_in_tick = 0;
+    g_tick.count++;
+
+    io_scan_outputs();
+}
+
+int Exec_InTask(void)
+{
+    return g_in_task;
+}
+
+const ExecTick_t *Exec_Now(void)
+{
+    return g_in_tick ? &g_tick : NULL;
+}
+
+int Exec_GetTaskStats(int id, ExecTaskStats_t *stats)
+{
+    for (int i = 0; i < g_num_tasks; i++) {
+        if (g_tasks[i].id == id) {
+            *stats = g_tasks[i].stats;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void Exec_PrintStats(void)
+{
+    printf("Executive: base %u us, %llu ticks\n", g_base_us,
+           (unsigned long long)g_tick.count);
+
+    for (int i = 0; i < g_num_tasks; i++) {
+        const ExecTaskStats_t *s = &g_tasks[i].stats;
+        printf("  %-10s prio %2d  every %7u us  %10llu runs  exec max %llu us\n",
+               s->name, s->priority, s->period_us,
+               (unsigned long long)s->runs,
+               (unsigned long long)s->exec_max_us);
+    }
+}
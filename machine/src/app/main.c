@@ -2,54 +2,201 @@
  * @file main.c
  * @brief Main loop for the machine controller.
  *
- * Initializes the control state machine and continuously monitors
- * ESTOP and executes periodic ticks.
+ * Initializes the control state machine and runs the cyclic executive
+ * (executive.h) on a fixed-period loop (rt_loop.h). The loop period is the
+ * executive's base tick; ESTOP supervision runs every base tick (1 kHz by
+ * default), the axis engines and status publishing at 10 Hz.
+ *
+ * ESTOP is also watched by the safety thread (safety.h), which switches
+ * the relays off on its own within one 1 ms poll. With -f it runs under
+ * SCHED_FIFO above the main loop; in virtual time, where there is no
+ * second thread, it is polled as the first executive task instead.
+ *
+ * Usage: main [-p period_us] [-f fifo_priority] [-c cpu] [-m] [-s stats_sec]
+ *
+ *   -p  base tick period in µs (default 1000, minimum 1000)
+ *   -f  run under SCHED_FIFO at this priority (1–99)
+ *   -c  pin to this CPU (e.g. one isolated with isolcpus=)
+ *   -m  mlockall() current and future memory
+ *   -s  print loop and task statistics every N seconds (0 = only at exit,
+ *       at most 4294)
+ *
+ * With CONTROL_STATUS_SHM=<name> (e.g. /machine_status) the per-tick status
+ * snapshot (control_status.h) is published in POSIX shared memory for
+ * other processes.
+ *
+ * With CONTROL_STOPBAND_FILE=<path> the learned tilt stop-band offsets
+ * (control_stopband.h) are loaded at start and saved at exit.
+ *
+ * SIGINT/SIGTERM end the loop and print the latency, task and safety
+ * statistics.
  */
 
+#include <signal.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include "control.h"
+#include "control_status.h"
+#include "control_stopband.h"
+#include "executive.h"
+#include "rt_loop.h"
+#include "safety.h"
+
+#define MAIN_STATUS_PERIOD_US  100000U
 
-static int ReadEStopButton(void); // TODO: connect to motion.c later
+static volatile sig_atomic_t g_running = 1;
+static RtLoop_t g_loop;
+
+static void OnSignal(int sig)
+{
+    (void)sig;
+    g_running = 0;
+}
 
 /**
- * @brief Program entry point.
- *
- * Initializes the control module and enters the main loop.
- * Periodically checks ESTOP and calls Control_Tick().
- *
- * @return Always returns 0.
+ * @brief Publish the machine status when it changes.
  */
-int main(void)
+static void MainTask_Status(const ExecTick_t *tick)
 {
-    Control_Init();
+    static MachineStatus_t last_st = (MachineStatus_t)-1;
+    MachineStatus_t st = Control_GetStatus();
 
-    while (1) {
-        int estop_pressed = ReadEStopButton();
-        if (estop_pressed) {
-            Control_NotifyEStopActive();
-        }
-
-        Control_Tick();
+    (void)tick;
 
-        MachineStatus_t st = Control_GetStatus();
+    if (st != last_st) {
         printf("Machine status: %d\n", (int)st);
-
-        usleep(100000); // 100 ms tick
+        last_st = st;
     }
+}
 
-    return 0;
+/**
+ * @brief Poll ESTOP when the safety thread is not running.
+ */
+static void MainTask_Safety(const ExecTick_t *tick)
+{
+    (void)tick;
+
+    Safety_Poll();
+}
+
+/**
+ * @brief Print loop, task and safety statistics.
+ */
+static void PrintStats(void)
+{
+    SafetyStats_t safety;
+
+    RtLoop_PrintStats(&g_loop.stats);
+    Exec_PrintStats();
+    Safety_GetStats(&safety);
+    Safety_PrintStats(&safety);
+}
+
+static void MainTask_Telemetry(const ExecTick_t *tick)
+{
+    (void)tick;
+
+    PrintStats();
+}
+
+static void Usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-p period_us] [-f fifo_priority] [-c cpu] [-m] [-s stats_sec]\n",
+            prog);
 }
 
 /**
- * @brief Read the ESTOP button state.
+ * @brief Program entry point.
  *
- * Dummy implementation. Real implementation will call motion.c.
+ * Initializes the control module, registers the tasks and runs one
+ * executive tick per loop period.
  *
- * @return 1 if ESTOP is pressed, 0 otherwise.
+ * @return 0 on normal exit, 1 on invalid arguments.
  */
-static int ReadEStopButton(void)
+int main(int argc, char *argv[])
 {
-    // TODO: call motion.c: ReadEStopButton()
+    RtLoopConfig_t cfg;
+    RtLoopConfig_t safety_cfg;
+    unsigned stats_sec = 0;
+    int safety_thread;
+    const char *shm;
+    const char *stop_band;
+    int opt;
+
+    RtLoop_DefaultConfig(&cfg);
+    cfg.period_us = 1000U;   /* executive base tick */
+
+    while ((opt = getopt(argc, argv, "p:f:c:ms:")) != -1) {
+        switch (opt) {
+        case 'p': cfg.period_us     = (uint32_t)strtoul(optarg, NULL, 0); break;
+        case 'f': cfg.fifo_priority = atoi(optarg);                      break;
+        case 'c': cfg.cpu           = atoi(optarg);                      break;
+        case 'm': cfg.lock_memory   = 1;                                 break;
+        case 's': {
+            unsigned long sec = strtoul(optarg, NULL, 0);
+
+            if (sec > UINT32_MAX / 1000000U) {   /* task period is uint32_t us */
+                fprintf(stderr, "main: -s %s exceeds %u s\n",
+                        optarg, (unsigned)(UINT32_MAX / 1000000U));
+                return 1;
+            }
+            stats_sec = (unsigned)sec;
+            break;
+        }
+        default:
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+
+    RtLoop_Setup(&cfg);
+    Control_Init();
+
+    shm = getenv(CONTROL_STATUS_SHM_ENV);
+    if (shm && *shm && ControlStatus_Share(shm) == 0)
+        printf("Status snapshot shared as %s\n", shm);
+
+    stop_band = getenv(CONTROL_STOPBAND_FILE_ENV);
+    if (stop_band && *stop_band && ControlStopBand_Load(stop_band) == 0)
+        printf("Stop bands loaded from %s\n", stop_band);
+
+    Safety_DefaultConfig(&safety_cfg);
+    safety_cfg.cpu = cfg.cpu;
+    if (cfg.fifo_priority <= 0)
+        safety_cfg.fifo_priority = 0;
+    else if (safety_cfg.fifo_priority <= cfg.fifo_priority)
+        safety_cfg.fifo_priority = cfg.fifo_priority < 99 ? cfg.fifo_priority + 1 : 99;
+    safety_thread = (Safety_Start(&safety_cfg) == 0);
+
+    RtLoop_Start(&g_loop, cfg.period_us);
+    printf("Main loop: period %u us, SCHED_FIFO %d, CPU %d, mlock %d\n",
+           g_loop.period_us, cfg.fifo_priority, cfg.cpu, cfg.lock_memory);
+
+    Exec_Init(g_loop.period_us);
+    if (!safety_thread) {
+        Exec_AddTask("safety", 0, -1, MainTask_Safety);
+    }
+    Control_RegisterTasks();
+    Exec_AddTask("status", MAIN_STATUS_PERIOD_US, 20, MainTask_Status);
+    if (stats_sec) {
+        Exec_AddTask("telemetry", stats_sec * 1000000U, 30, MainTask_Telemetry);
+    }
+
+    while (g_running) {
+        RtLoop_Wait(&g_loop);
+        Exec_Tick();
+        RtLoop_Done(&g_loop);
+    }
+
+    Safety_Stop();
+    if (stop_band && *stop_band)
+        ControlStopBand_Save(stop_band);
+    PrintStats();
     return 0;
 }
@@ -0,0 +1,192 @@
+/**
+ * @file rt_loop.c
+ * @brief Fixed-period main loop with absolute deadlines and jitter stats.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "rt_loop.h"
+#include "time_source.h"
+
+/* -------------------------------------------------------------------------
+ * Setup
+ * ------------------------------------------------------------------------- */
+
+void RtLoop_DefaultConfig(RtLoopConfig_t *cfg)
+{
+    cfg->period_us     = 100000U;
+    cfg->fifo_priority = 0;
+    cfg->cpu           = -1;
+    cfg->lock_memory   = 0;
+}
+
+int RtLoop_Setup(const RtLoopConfig_t *cfg)
+{
+    int ret = 0;
+
+    if (cfg->lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        fprintf(stderr, "RtLoop: mlockall: %s\n", strerror(errno));
+        ret = -1;
+    }
+
+    if (cfg->cpu >= 0) {
+        cpu_set_t set;
+
+        CPU_ZERO(&set);
+        CPU_SET(cfg->cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) < 0) {
+            fprintf(stderr, "RtLoop: CPU %d affinity: %s\n", cfg->cpu,
+                    strerror(errno));
+            ret = -1;
+        }
+    }
+
+    if (cfg->fifo_priority > 0) {
+        struct sched_param sp;
+
+        memset(&sp, 0, sizeof(sp));
+        sp.sched_priority = cfg->fifo_priority;
+        if (sched_setscheduler(0, SCHED_FIFO, &sp) < 0) {
+            fprintf(stderr, "RtLoop: SCHED_FIFO %d: %s\n", cfg->fifo_priority,
+                    strerror(errno));
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+/* -------------------------------------------------------------------------
+ * Loop
+ * ------------------------------------------------------------------------- */
+
+void RtLoop_ResetStats(RtLoop_t *loop)
+{
+    memset(&loop->stats, 0, sizeof(loop->stats));
+    loop->stats.lat_min_us = UINT64_MAX;
+}
+
+void RtLoop_Start(RtLoop_t *loop, uint32_t period_us)
+{
+    if (period_us < RT_LOOP_MIN_PERIOD_US)
+        period_us = RT_LOOP_MIN_PERIOD_US;
+
+    loop->period_us   = period_us;
+    loop->deadline_us = TimeSource_NowUs();
+    loop->wake_us     = loop->deadline_us;
+    RtLoop_ResetStats(loop);
+}
+
+unsigned RtLoop_Bucket(uint64_t us)
+{
+    unsigned b = 0;
+
+    while (us && b < RT_LOOP_HIST_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void RtLoop_Wait(RtLoop_t *loop)
+{
+    RtLoopStats_t *st = &loop->stats;
+    uint64_t lat;
+
+    TimeSource_SleepUntilUs(loop->deadline_us);
+
+    loop->wake_us = TimeSource_NowUs();
+    lat = loop->wake_us > loop->deadline_us ? loop->wake_us - loop->deadline_us : 0;
+
+    st->ticks++;
+    st->lat_sum_us += lat;
+    if (lat < st->lat_min_us) st->lat_min_us = lat;
+    if (lat > st->lat_max_us) st->lat_max_us = lat;
+    st->hist[RtLoop_Bucket(lat)]++;
+}
+
+void RtLoop_Done(RtLoop_t *loop)
+{
+    RtLoopStats_t *st = &loop->stats;
+    uint64_t now = TimeSource_NowUs();
+    uint64_t exec = now - loop->wake_us;
+
+    if (exec > st->exec_max_us) st->exec_max_us = exec;
+
+    loop->deadline_us += loop->period_us;
+
+    /* Overrun: stay on the grid, skip the deadlines already passed */
+    if (now > loop->deadline_us) {
+        uint64_t late = (now - loop->deadline_us) / loop->period_us;
+
+        st->overruns++;
+        st->missed += late;
+        loop->deadline_us += late * loop->period_us;
+    }
+}
+
+/* -------------------------------------------------------------------------
+ * Reporting
+ * ------------------------------------------------------------------------- */
+
+uint64_t RtLoop_HistPercentile(const uint64_t *hist, uint64_t count,
+                               uint64_t max_us, double pct)
+{
+    uint64_t need, seen = 0;
+
+    if (count == 0)
+        return 0;
+
+    need = (uint64_t)((double)count * pct / 100.0 + 0.5);
+    if (need == 0) need = 1;
+
+    for (unsigned b = 0; b < RT_LOOP_HIST_BUCKETS; b++) {
+        seen += hist[b];
+        if (seen >= need)
+            return b == 0 ? 0 : (1ULL << b) - 1;
+    }
+    return max_us;
+}
+
+uint64_t RtLoop_LatencyPercentile(const RtLoopStats_t *stats, double pct)
+{
+    return RtLoop_HistPercentile(stats->hist, stats->ticks, stats->lat_max_us, pct);
+}
+
+void RtLoop_PrintHist(const uint64_t *hist)
+{
+    for (unsigned b = 0; b < RT_LOOP_HIST_BUCKETS; b++) {
+        if (!hist[b]) continue;
+        printf("  %8llu - %8llu us: %llu\n",
+               (unsigned long long)(b == 0 ? 0 : 1ULL << (b - 1)),
+               (unsigned long long)(b == 0 ? 0 : (1ULL << b) - 1),
+               (unsigned long long)hist[b]);
+    }
+}
+
+void RtLoop_PrintStats(const RtLoopStats_t *stats)
+{
+    if (stats->ticks == 0) {
+        printf("RtLoop: no ticks\n");
+        return;
+    }
+
+    printf("RtLoop: %llu ticks, %llu overruns, %llu missed deadlines\n",
+           (unsigned long long)stats->ticks,
+           (unsigned long long)stats->overruns,
+           (unsigned long long)stats->missed);
+    printf("RtLoop: wake-up latency min %llu / avg %llu / p99 < %llu / max %llu us, "
+           "exec max %llu us\n",
+           (unsigned long long)stats->lat_min_us,
+           (unsigned long long)(stats->lat_sum_us / stats->ticks),
+           (unsigned long long)RtLoop_LatencyPercentile(stats, 99.0) + 1,
+           (unsigned long long)stats->lat_max_us,
+           (unsigned long long)stats->exec_max_us);
+
+    RtLoop_PrintHist(stats->hist);
+}
@@ -0,0 +1,216 @@
+/**
+ * @file safety.c
+ * @brief ESTOP safety thread: relays off within one poll of the press.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "safety.h"
+#include "control.h"
+#include "hal.h"
+#include "mio_addr.h"
+#include "ro_addr.h"
+#include "time_source.h"
+
+/* DI_ESTOP (motion.h) is DI4; the input is inverted, 0 = pressed */
+#define SAFETY_ESTOP_OFFSET  DI4_OFFSET
+#define SAFETY_ESTOP_BIT     DI4_BIT
+
+static pthread_mutex_t g_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static SafetyStats_t   g_stats = { .lat_min_us = UINT64_MAX };
+
+static pthread_t      g_thread;
+static RtLoopConfig_t g_cfg;
+static int            g_started    = 0;
+static int            g_running    = 0;
+static int            g_tripped    = 0;
+static int            g_read_fails = 0;
+static uint64_t       g_prev_us    = 0;   /* Previous poll, 0 = none yet */
+
+/* -------------------------------------------------------------------------
+ * Trip
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Force the relays off, latch ESTOP and record the latency.
+ *
+ * @param t_prev Previous poll (the press happened after it).
+ * @param t_seen Poll that saw the press.
+ */
+static void Safety_Trip(uint64_t t_prev, uint64_t t_seen)
+{
+    int ret = hal_force_off(RO1_OFFSET, 1);
+    uint64_t t_done = TimeSource_NowUs();
+    uint64_t lat = t_done - t_prev;
+    uint64_t write = t_done - t_seen;
+
+    Control_NotifyEStopActive();
+    __atomic_store_n(&g_tripped, 1, __ATOMIC_RELEASE);
+
+    pthread_mutex_lock(&g_stats_lock);
+    if (ret < 0) g_stats.write_errors++;
+    g_stats.trips++;
+    g_stats.lat_sum_us += lat;
+    if (lat < g_stats.lat_min_us) g_stats.lat_min_us = lat;
+    if (lat > g_stats.lat_max_us) g_stats.lat_max_us = lat;
+    if (lat > SAFETY_LATENCY_TARGET_US) g_stats.over_target++;
+    if (write > g_stats.write_max_us) g_stats.write_max_us = write;
+    g_stats.hist[RtLoop_Bucket(lat)]++;
+    pthread_mutex_unlock(&g_stats_lock);
+}
+
+int Safety_Poll(void)
+{
+    uint64_t now = TimeSource_NowUs();
+    uint64_t prev = g_prev_us ? g_prev_us : now;
+    int raw = hal_get_bit(SAFETY_ESTOP_OFFSET, SAFETY_ESTOP_BIT);
+    int pressed;
+
+    g_prev_us = now;
+
+    if (raw < 0) {
+        g_read_fails++;
+        pressed = g_read_fails >= SAFETY_READ_FAULT_LIMIT;
+    } else {
+        g_read_fails = 0;
+        pressed = (raw == 0);
+    }
+
+    pthread_mutex_lock(&g_stats_lock);
+    g_stats.polls++;
+    if (raw < 0) g_stats.read_errors++;
+    pthread_mutex_unlock(&g_stats_lock);
+
+    if (pressed && !Safety_IsTripped())
+        Safety_Trip(prev, now);
+
+    return Safety_IsTripped();
+}
+
+int Safety_IsTripped(void)
+{
+    return __atomic_load_n(&g_tripped, __ATOMIC_ACQUIRE);
+}
+
+int Safety_Reset(void)
+{
+    if (hal_get_bit(SAFETY_ESTOP_OFFSET, SAFETY_ESTOP_BIT) != 1)
+        return -1;
+
+    hal_force_release();
+    __atomic_store_n(&g_tripped, 0, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/* -------------------------------------------------------------------------
+ * Thread
+ * ------------------------------------------------------------------------- */
+
+void Safety_DefaultConfig(RtLoopConfig_t *cfg)
+{
+    RtLoop_DefaultConfig(cfg);
+    cfg->period_us     = SAFETY_PERIOD_US;
+    cfg->fifo_priority = SAFETY_FIFO_PRIORITY;
+}
+
+static void *Safety_Thread(void *arg)
+{
+    RtLoop_t loop;
+
+    (void)arg;
+
+    RtLoop_Setup(&g_cfg);
+    RtLoop_Start(&loop, g_cfg.period_us);
+    g_prev_us = 0;
+
+    while (__atomic_load_n(&g_running, __ATOMIC_ACQUIRE)) {
+        RtLoop_Wait(&loop);
+        Safety_Poll();
+        RtLoop_Done(&loop);
+
+        pthread_mutex_lock(&g_stats_lock);
+        g_stats.loop = loop.stats;
+        pthread_mutex_unlock(&g_stats_lock);
+    }
+    return NULL;
+}
+
+int Safety_Start(const RtLoopConfig_t *cfg)
+{
+    if (g_started || TimeSource_IsVirtual())
+        return -1;
+
+    g_cfg = *cfg;
+    g_cfg.lock_memory = 0;
+    __atomic_store_n(&g_running, 1, __ATOMIC_RELEASE);
+
+    if (pthread_create(&g_thread, NULL, Safety_Thread, NULL) != 0) {
+        fprintf(stderr, "Safety: cannot create thread\n");
+        return -1;
+    }
+    g_started = 1;
+    return 0;
+}
+
+void Safety_Stop(void)
+{
+    if (!g_started)
+        return;
+
+    __atomic_store_n(&g_running, 0, __ATOMIC_RELEASE);
+    pthread_join(g_thread, NULL);
+    g_started = 0;
+}
+
+/* -------------------------------------------------------------------------
+ * Statistics
+ * ------------------------------------------------------------------------- */
+
+void Safety_GetStats(SafetyStats_t *stats)
+{
+    pthread_mutex_lock(&g_stats_lock);
+    *stats = g_stats;
+    pthread_mutex_unlock(&g_stats_lock);
+}
+
+void Safety_ResetStats(void)
+{
+    pthread_mutex_lock(&g_stats_lock);
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_stats.lat_min_us = UINT64_MAX;
+    pthread_mutex_unlock(&g_stats_lock);
+}
+
+uint64_t Safety_LatencyPercentile(const SafetyStats_t *stats, double pct)
+{
+    return RtLoop_HistPercentile(stats->hist, stats->trips, stats->lat_max_us, pct);
+}
+
+void Safety_PrintStats(const SafetyStats_t *stats)
+{
+    printf("Safety: %llu polls, %llu trips, %llu read errors, %llu write errors\n",
+           (unsigned long long)stats->polls,
+           (unsigned long long)stats->trips,
+           (unsigned long long)stats->read_errors,
+           (unsigned long long)stats->write_errors);
+
+    if (stats->trips) {
+        printf("Safety: ESTOP-to-relays-off min %llu / avg %llu / p99 < %llu / max %llu us, "
+               "%llu over %u us, write max %llu us\n",
+               (unsigned long long)stats->lat_min_us,
+               (unsigned long long)(stats->lat_sum_us / stats->trips),
+               (unsigned long long)Safety_LatencyPercentile(stats, 99.0) + 1,
+               (unsigned long long)stats->lat_max_us,
+               (unsigned long long)stats->over_target,
+               SAFETY_LATENCY_TARGET_US,
+               (unsigned long long)stats->write_max_us);
+        RtLoop_PrintHist(stats->hist);
+    }
+
+    if (stats->loop.ticks) {
+        printf("Safety poll loop:\n");
+        RtLoop_PrintStats(&stats->loop);
+    }
+}
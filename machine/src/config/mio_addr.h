@@ -5,6 +5,12 @@
    MIO OFFSETS (from piTest)
    ============================================================ */
 
+/* ----------------------------
+   INPUT REGION (DI, AI, status)
+   ---------------------------- */
+#define MIO_INPUT_OFFSET  13
+#define MIO_INPUT_LENGTH  34
+
 /* ----------------------------
    DIGITAL INPUTS (DI1–DI4)
    ---------------------------- */
@@ -11,11 +11,14 @@
 #include <math.h>
 #include <stdint.h>
 #include <stdio.h>
-#include <time.h>
 #include "control_rotate.h"
+#include "time_source.h"
+#include "executive.h"
+#include "control_tick.h"
 #include "machine_state.h"
 #include "motion.h"
 #include "mio.h"
+#include "di_edge.h"
 
 /* TODO:
  * - Add timing/position compensation for precision control.
@@ -84,7 +87,8 @@ static struct
     uint64_t timeout_ms;    /**< Homing timeout */
     int      last_raw;      /**< Last raw sensor read */
     int      last_home;     /**< Last interpreted home read */
-} g_home = { 0, 0, 0, 0, -1, -1 };
+    int      edge_sub;      /**< di_edge subscriber for the home sensor */
+} g_home = { 0, 0, 0, 0, -1, -1, -1 };
 
 /**
  * @brief Internal motion state.
@@ -113,29 +117,41 @@ static struct
 /**
  * @brief Get a monotonic timestamp in milliseconds.
  *
+ * Real or virtual time, see @ref time_source.h. Inside a control tick
+ * this is the timestamp of the tick (control_tick.h), shared by every
+ * engine call of that tick.
+ *
  * @return Monotonic time in milliseconds.
  */
 static uint64_t ControlRotate_NowMs(void)
 {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+    const ControlTick_t *tick = ControlTick_Now();
+    const ExecTick_t *exec;
+
+    if (tick) return ControlTick_Ms(tick);
+
+    exec = Exec_Now();
+    return exec ? exec->t_us / 1000ULL : TimeSource_NowMs();
 }
 
 /**
  * @brief Check whether a new control tick should run.
  *
+ * @param tick         Context of the current tick.
  * @param last_tick_ms Pointer to the last tick timestamp.
  * @param interval_ms  Control interval in milliseconds.
- * @return 1 if a tick should run, 0 otherwise.
+ * @return 1 if a tick should run (always inside an executive task),
+ *         0 otherwise.
  */
-static int ControlRotate_ShouldTick(uint64_t *last_tick_ms, int interval_ms)
+static int ControlRotate_ShouldTick(const ControlTick_t *tick,
+                                    uint64_t *last_tick_ms, int interval_ms)
 {
-    uint64_t now = ControlRotate_NowMs();
+    uint64_t now = ControlTick_Ms(tick);
 
     if (!last_tick_ms) return 1;
 
-    if (interval_ms <= 0) {
+    /* Called from an executive task: the task period is the rate */
+    if (interval_ms <= 0 || tick->paced) {
         *last_tick_ms = now;
         return 1;
     }
@@ -145,13 +161,42 @@ static int ControlRotate_ShouldTick(uint64_t *last_tick_ms, int interval_ms)
         return 1;
     }
 
+    /* Nothing to do until the next tick; lets virtual time move on */
+    TimeSource_IdleUntilUs((*last_tick_ms + (uint64_t)interval_ms) * 1000ULL);
+
     return 0;
 }
 
+/**
+ * @brief Block until the next control tick is due.
+ *
+ * Used by the blocking wrappers between service calls instead of spinning.
+ * While homing, a home sensor edge (di_edge.h) wakes the caller at once.
+ *
+ * @param last_tick_ms Last tick of the sequence being serviced.
+ */
+static void ControlRotate_WaitTick(uint64_t last_tick_ms)
+{
+    int interval_ms = (g_cal.control_time_ms > 0) ? g_cal.control_time_ms : 1;
+    int fd = g_home.active ? di_edge_fd(g_home.edge_sub) : -1;
+
+    TimeSource_WaitUntilUs((last_tick_ms + (uint64_t)interval_ms) * 1000ULL, fd);
+}
+
 /* -------------------------------------------------------------------------
  * Motion helpers
  * ------------------------------------------------------------------------- */
 
+/**
+ * @brief Calibrated rotate speed.
+ *
+ * @return Degrees per second (rpm * 6).
+ */
+float ControlRotate_DegPerSec(void)
+{
+    return g_cal.rpm * 6.0f;
+}
+
 /**
  * @brief Convert degrees to duration (ms) using fixed 1 rpm.
  *
@@ -225,6 +270,27 @@ static void ControlRotate_LogHomeSensor(const char *tag, int raw, int home)
            tag, raw, home);
 }
 
+/**
+ * @brief Check for a home-sensor edge since the last call.
+ *
+ * The edge is captured by the IO scan (di_edge.h), so a home window that
+ * is crossed between two control ticks is still seen, at IO cycle
+ * latency instead of control_time_ms.
+ *
+ * @return 1 if the sensor went from "not touched" to "touched".
+ */
+static int ControlRotate_HomeEdge(void)
+{
+    DiEdge_t edge;
+
+    if (g_home.edge_sub < 0) return 0;
+    if (di_edge_next(g_home.edge_sub, &edge) <= 0) return 0;
+
+    di_edge_flush(g_home.edge_sub);
+    ControlRotate_LogHomeSensor("home-edge", edge.level, 1);
+    return 1;
+}
+
 /* -------------------------------------------------------------------------
  * Home / Check
  * ------------------------------------------------------------------------- */
@@ -284,6 +350,12 @@ RotateResult_t ControlRotate_BeginHome(void)
     g_home.last_raw  = ControlRotate_ReadHomeRaw();
     g_home.last_home = home;
 
+    /* Touched = falling raw edge (inverted sensor) */
+    if (g_home.edge_sub < 0)
+        g_home.edge_sub = di_edge_subscribe(DI_EDGE_CH(DI_PROXI_ROTATE),
+                                            DI_EDGE_FALLING);
+    di_edge_flush(g_home.edge_sub);
+
     if (g_home.last_raw >= 0) {
         ControlRotate_LogHomeSensor("home-start", g_home.last_raw, home);
     }
@@ -294,14 +366,15 @@ RotateResult_t ControlRotate_BeginHome(void)
 }
 
 /**
- * @brief Service the non-blocking homing sequence.
+ * @brief Service the non-blocking homing sequence for one control tick.
  *
+ * @param tick Context of the current tick (control_tick.h).
  * @return ROTATE_RUNNING while moving,
  *         ROTATE_OK when homed,
  *         ROTATE_PAUSED or ROTATE_STOPPED on request,
  *         ROTATE_ERROR on fault.
  */
-RotateResult_t ControlRotate_ServiceHome(void)
+RotateResult_t ControlRotate_ServiceHomeTick(const ControlTick_t *tick)
 {
     if (!g_home.active) {
         return ROTATE_OK;
@@ -321,7 +394,16 @@ RotateResult_t ControlRotate_ServiceHome(void)
         return ROTATE_STOPPED;
     }
 
-    if (!ControlRotate_ShouldTick(&g_home.last_tick_ms, g_cal.control_time_ms)) {
+    if (ControlRotate_HomeEdge()) {
+        RelayRotate(0, 0);
+        g_home.active = 0;
+        g_rotate_is_homed = 1;
+        g_rotate_est_deg  = 0.0f;
+        g_machine.rotate_state = AXIS_IDLE;
+        return ROTATE_OK;
+    }
+
+    if (!ControlRotate_ShouldTick(tick, &g_home.last_tick_ms, g_cal.control_time_ms)) {
         return ROTATE_RUNNING;
     }
 
@@ -350,7 +432,7 @@ RotateResult_t ControlRotate_ServiceHome(void)
         return ROTATE_OK;
     }
 
-    uint64_t now = ControlRotate_NowMs();
+    uint64_t now = ControlTick_Ms(tick);
     if (now - g_home.start_ms > g_home.timeout_ms) {
         RelayRotate(0, 0);
         g_home.active = 0;
@@ -361,6 +443,26 @@ RotateResult_t ControlRotate_ServiceHome(void)
     return ROTATE_RUNNING;
 }
 
+/**
+ * @brief Service the non-blocking homing sequence.
+ *
+ * Uses the open control tick, or a context of its own outside one.
+ *
+ * @return See ControlRotate_ServiceHomeTick().
+ */
+RotateResult_t ControlRotate_ServiceHome(void)
+{
+    ControlTick_t own, *tick = ControlTick_Now();
+    RotateResult_t r;
+
+    if (tick) return ControlRotate_ServiceHomeTick(tick);
+
+    ControlTick_Begin(&own, 0);
+    r = ControlRotate_ServiceHomeTick(&own);
+    ControlTick_End(&own);
+    return r;
+}
+
 /**
  * @brief Blocking homing routine.
  *
@@ -372,12 +474,10 @@ int ControlRotate_Home(void)
     if (r == ROTATE_OK) return 0;
     if (r == ROTATE_ERROR) return -1;
 
-    while (1) {
-        r = ControlRotate_ServiceHome();
-        if (r == ROTATE_RUNNING) continue;
-        if (r == ROTATE_OK) return 0;
-        return -1;
-    }
+    while ((r = ControlRotate_ServiceHome()) == ROTATE_RUNNING)
+        ControlRotate_WaitTick(g_home.last_tick_ms);
+
+    return (r == ROTATE_OK) ? 0 : -1;
 }
 
 /**
@@ -510,14 +610,15 @@ RotateResult_t ControlRotate_RotateMoveToDegree(RotateDirection_t dir,
 }
 
 /**
- * @brief Service the non-blocking rotation motion.
+ * @brief Service the non-blocking rotation motion for one control tick.
  *
+ * @param tick Context of the current tick (control_tick.h).
  * @return ROTATE_RUNNING while motion is in progress,
  *         ROTATE_OK when target reached,
  *         ROTATE_PAUSED or ROTATE_STOPPED on request,
  *         ROTATE_ERROR on fault.
  */
-RotateResult_t ControlRotate_Service(void)
+RotateResult_t ControlRotate_ServiceTick(const ControlTick_t *tick)
 {
     if (!g_motion.active) {
         return ROTATE_OK;
@@ -537,11 +638,11 @@ RotateResult_t ControlRotate_Service(void)
         return ROTATE_STOPPED;
     }
 
-    if (!ControlRotate_ShouldTick(&g_motion.last_tick_ms, g_cal.control_time_ms)) {
+    if (!ControlRotate_ShouldTick(tick, &g_motion.last_tick_ms, g_cal.control_time_ms)) {
         return ROTATE_RUNNING;
     }
 
-    uint64_t now = ControlRotate_NowMs();
+    uint64_t now = ControlTick_Ms(tick);
 
     if (g_motion.mode == ROTATE_MODE_DEGREE) {
         float elapsed_ms = (float)(now - g_motion.start_ms);
@@ -646,6 +747,26 @@ RotateResult_t ControlRotate_Service(void)
     return ROTATE_ERROR;
 }
 
+/**
+ * @brief Service the non-blocking rotation motion.
+ *
+ * Uses the open control tick, or a context of its own outside one.
+ *
+ * @return See ControlRotate_ServiceTick().
+ */
+RotateResult_t ControlRotate_Service(void)
+{
+    ControlTick_t own, *tick = ControlTick_Now();
+    RotateResult_t r;
+
+    if (tick) return ControlRotate_ServiceTick(tick);
+
+    ControlTick_Begin(&own, 0);
+    r = ControlRotate_ServiceTick(&own);
+    ControlTick_End(&own);
+    return r;
+}
+
 /* -------------------------------------------------------------------------
  * Misc
  * ------------------------------------------------------------------------- */
@@ -663,6 +784,16 @@ int ControlRotate_ReadPosition(int *count_out)
     return 0;
 }
 
+/**
+ * @brief Read the estimated rotation position in degrees (unrounded).
+ *
+ * @return Estimated degrees since home.
+ */
+float ControlRotate_ReadDegree(void)
+{
+    return g_rotate_est_deg;
+}
+
 /**
  * @brief Read the elapsed motion time in milliseconds.
  *
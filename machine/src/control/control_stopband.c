@@ -0,0 +1,154 @@
+/**
+ * @file control_stopband.c
+ * @brief Learned tilt stop-band corrections.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "control_stopband.h"
+#include "json_utils.h"
+
+#define STOPBAND_JSON_MAX_SIZE  4096
+
+/* Upper travel edge of each bin but the last (V) */
+static const float k_bin_edges[CONTROL_STOPBAND_BINS - 1] = { 0.5f, 2.0f };
+
+static struct
+{
+    float    offset;    /**< Added to the calibrated band (V) */
+    unsigned moves;     /**< Moves learned from */
+} g_bins[2][CONTROL_STOPBAND_BINS];     /* [up][bin] */
+
+static float ControlStopBand_Clamp(float v, float lo, float hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+int ControlStopBand_Bin(float travel_volts)
+{
+    float t = fabsf(travel_volts);
+    int bin = 0;
+
+    while (bin < CONTROL_STOPBAND_BINS - 1 && t >= k_bin_edges[bin])
+        bin++;
+    return bin;
+}
+
+float ControlStopBand_Get(int up, float travel_volts, float base_volts)
+{
+    float band = base_volts + g_bins[up ? 1 : 0][ControlStopBand_Bin(travel_volts)].offset;
+
+    return ControlStopBand_Clamp(band, 0.0f, CONTROL_STOPBAND_MAX_V);
+}
+
+int ControlStopBand_Learn(int up, float travel_volts, float error_volts)
+{
+    int bin = ControlStopBand_Bin(travel_volts);
+
+    if (!(fabsf(error_volts) <= CONTROL_STOPBAND_MAX_OFFSET_V))
+        return -1;
+
+    /* Overshoot: stop earlier next time */
+    g_bins[up ? 1 : 0][bin].offset = ControlStopBand_Clamp(
+        g_bins[up ? 1 : 0][bin].offset + CONTROL_STOPBAND_GAIN * error_volts,
+        -CONTROL_STOPBAND_MAX_OFFSET_V, CONTROL_STOPBAND_MAX_OFFSET_V);
+    g_bins[up ? 1 : 0][bin].moves++;
+    return 0;
+}
+
+float ControlStopBand_Offset(int up, int bin, unsigned *moves)
+{
+    if (bin < 0 || bin >= CONTROL_STOPBAND_BINS) {
+        if (moves) *moves = 0;
+        return 0.0f;
+    }
+
+    if (moves) *moves = g_bins[up ? 1 : 0][bin].moves;
+    return g_bins[up ? 1 : 0][bin].offset;
+}
+
+void ControlStopBand_Reset(void)
+{
+    for (int d = 0; d < 2; d++) {
+        for (int b = 0; b < CONTROL_STOPBAND_BINS; b++) {
+            g_bins[d][b].offset = 0.0f;
+            g_bins[d][b].moves  = 0;
+        }
+    }
+}
+
+int ControlStopBand_Save(const char *path)
+{
+    char tmp[512];
+    FILE *fp;
+    int ok;
+
+    if (!path || snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp))
+        return -1;
+
+    fp = fopen(tmp, "w");
+    if (!fp) {
+        fprintf(stderr, "ControlStopBand: cannot write %s\n", tmp);
+        return -1;
+    }
+
+    fprintf(fp, "{\n  \"tilt_stop_band\": {\n");
+    for (int d = 0; d < 2; d++) {
+        for (int b = 0; b < CONTROL_STOPBAND_BINS; b++) {
+            const char *dir = d ? "out" : "in";
+            int last = (d == 1 && b == CONTROL_STOPBAND_BINS - 1);
+
+            fprintf(fp, "    \"%s_%d\": %.4f,\n", dir, b, g_bins[d][b].offset);
+            fprintf(fp, "    \"moves_%s_%d\": %u%s\n", dir, b, g_bins[d][b].moves,
+                    last ? "" : ",");
+        }
+    }
+    fprintf(fp, "  }\n}\n");
+
+    ok = (fflush(fp) == 0);
+    ok = (fclose(fp) == 0) && ok;
+
+    /* Replace the old file only once the new one is complete */
+    if (!ok || rename(tmp, path) != 0) {
+        fprintf(stderr, "ControlStopBand: cannot write %s\n", path);
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+int ControlStopBand_Load(const char *path)
+{
+    char *json = NULL;
+    JsonSpan_t span;
+
+    if (!path || JsonUtils_ReadFileToBuffer(path, &json, NULL, STOPBAND_JSON_MAX_SIZE) != 0)
+        return -1;
+
+    if (!JsonUtils_FindObjectSpan(json, "tilt_stop_band", &span)) {
+        fprintf(stderr, "ControlStopBand: no tilt_stop_band in %s\n", path);
+        free(json);
+        return -1;
+    }
+
+    for (int d = 0; d < 2; d++) {
+        for (int b = 0; b < CONTROL_STOPBAND_BINS; b++) {
+            char key[32];
+            double v;
+
+            snprintf(key, sizeof(key), "%s_%d", d ? "out" : "in", b);
+            if (JsonUtils_ParseNumberInSpan(span, key, &v))
+                g_bins[d][b].offset = ControlStopBand_Clamp((float)v,
+                                                            -CONTROL_STOPBAND_MAX_OFFSET_V,
+                                                            CONTROL_STOPBAND_MAX_OFFSET_V);
+
+            snprintf(key, sizeof(key), "moves_%s_%d", d ? "out" : "in", b);
+            if (JsonUtils_ParseNumberInSpan(span, key, &v) && v >= 0.0)
+                g_bins[d][b].moves = (unsigned)v;
+        }
+    }
+
+    free(json);
+    return 0;
+}
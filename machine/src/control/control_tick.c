@@ -0,0 +1,58 @@
+/**
+ * @file control_tick.c
+ * @brief Per-tick context for the axis engines.
+ */
+
+#include <stddef.h>
+#include "control_tick.h"
+#include "executive.h"
+#include "hal.h"
+#include "io_scan.h"
+#include "motion.h"
+#include "time_source.h"
+
+static ControlTick_t *g_current = NULL;
+
+void ControlTick_Begin(ControlTick_t *tick, uint64_t count)
+{
+    const ExecTick_t *exec = Exec_Now();
+
+    tick->count     = count;
+    tick->paced     = Exec_InTask();
+    tick->tilt_adc  = -1;
+    tick->tilt_read = 0;
+
+    if (exec)
+        tick->t_us = exec->t_us;
+    else if (io_scan_is_valid())
+        tick->t_us = hal_cycle().t_us;
+    else
+        tick->t_us = TimeSource_NowUs();
+
+    g_current = tick;
+}
+
+void ControlTick_End(ControlTick_t *tick)
+{
+    if (g_current == tick)
+        g_current = NULL;
+}
+
+ControlTick_t *ControlTick_Now(void)
+{
+    return g_current;
+}
+
+uint64_t ControlTick_Ms(const ControlTick_t *tick)
+{
+    return tick->t_us / 1000ULL;
+}
+
+int ControlTick_TiltAdc(ControlTick_t *tick)
+{
+    if (!tick->tilt_read) {
+        tick->tilt_adc  = ReadTiltPosition();
+        tick->tilt_read = 1;
+    }
+    return tick->tilt_adc;
+}
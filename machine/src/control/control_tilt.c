@@ -8,23 +8,29 @@
  *   - Homing (non-blocking)
  *   - Non-blocking motion engine with pause/stop handling
  *   - Stop-band compensation (in/out, in volts)
+ *   - Predictive stop from an alpha-beta position/velocity estimate
+ *   - Stop bands learned from the settled position of each move
+ *   - Fine positioning with timed relay pulses
+ *   - Velocity-based stall detection with a captured sample window
  */
 
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
-#include <time.h>
-#include <unistd.h>
 #include "control_tilt.h"
+#include "time_source.h"
+#include "executive.h"
+#include "control_tick.h"
+#include "control_stopband.h"
 #include "motion.h"
 #include "machine_state.h"
+#include "di_edge.h"
 
 /* TODO:
  * - Apply home-offset compensation after prox triggers.
  * - Enforce minimum-voltage safety near mechanical stop.
  * - Add timeout protection for homing and moves.
- * - Add jam/no-movement detection.
  * - Add optional heartbeat/watchdog integration.
  */
 
@@ -44,6 +50,12 @@ static struct
     float max_angle;
     float min_angle;
     int   control_time_ms;
+    int   stop_predict;
+    float coast_ms;
+    int   learn_stop_band;
+    float fine_window;
+    float fine_tolerance;
+    float fine_volts_per_ms;
 } g_cal = {
     .seat_time_ms    = 200,
     .min_volts       = 0.29f,
@@ -54,7 +66,13 @@ static struct
     .sec_per_degree  = 0.5f,
     .max_angle       = 75.0f,
     .min_angle       = 0.0f,
-    .control_time_ms = 100
+    .control_time_ms = 100,
+    .stop_predict    = 0,
+    .coast_ms        = 400.0f,
+    .learn_stop_band = 1,
+    .fine_window     = 0.0f,
+    .fine_tolerance  = 0.02f,
+    .fine_volts_per_ms = 0.001f
 };
 
 static int   g_tilt_is_homed = 0;
@@ -64,17 +82,52 @@ static float g_last_degree   = 0.0f;
  * Internal motion state
  * ------------------------------------------------------------------------- */
 
+/**
+ * @brief Sub-states of a move.
+ */
+typedef enum
+{
+    TILT_PHASE_BULK = 0,    /**< Relay on until the stop decision */
+    TILT_PHASE_SETTLE,      /**< Relay off, waiting for the coast to end */
+    TILT_PHASE_PULSE        /**< Timed fine-positioning pulse */
+} TiltPhase_t;
+
 static struct
 {
-    int      active;
-    int      target_adc;
-    int      direction_up;
-    int      last_adc;
-    uint64_t start_ms;
-    uint64_t last_progress_ms;
-    uint64_t last_tick_ms;
-    uint64_t timeout_ms;
-} g_motion = { 0, 0, 0, 0, 0, 0, 0, 0 };
+    int         active;
+    int         target_adc;
+    int         goal_adc;
+    int         direction_up;
+    int         last_adc;
+    uint64_t    start_ms;
+    uint64_t    last_progress_ms;
+    uint64_t    last_tick_ms;
+    uint64_t    timeout_ms;
+    TiltPhase_t phase;
+    uint64_t    release_ms;         /* Relay off time (SETTLE) */
+    int         pulses;             /* Pulses driven so far */
+    int         pulse_up;
+    int         pulse_ms;
+    int         pulse_start_adc;
+    uint64_t    pulse_end_ms;
+} g_motion = { 0 };
+
+/* Learned fine pulse gain (V/ms) per direction [up], 0 = not yet */
+static float g_pulse_gain[2] = { 0.0f, 0.0f };
+
+/**
+ * @brief Alpha-beta estimate of the tilt position and velocity.
+ *
+ * Fed with the ADC sample of every control tick of a move; restarted at
+ * rest by each BeginMoveToVolt().
+ */
+static struct
+{
+    float    x;                 /**< Position (ADC counts) */
+    float    v;                 /**< Velocity (counts/s) */
+    float    dt;                /**< Last update interval (s) */
+    uint64_t t_ms;              /**< Time of the last update */
+} g_est = { 0.0f, 0.0f, 0.0f, 0 };
 
 /**
  * @brief Internal homing state.
@@ -87,38 +140,103 @@ static struct
     uint64_t last_progress_ms;  /**< Last time motion progressed */
     uint64_t last_tick_ms;      /**< Last tick time */
     uint64_t timeout_ms;        /**< Homing timeout */
-} g_home = { 0, 0, 0, 0, 0, 0 };
+    int      edge_sub;          /**< di_edge subscriber for the home sensor */
+} g_home = { 0, 0, 0, 0, 0, 0, -1 };
+
+/**
+ * @brief Stall detector for the current move or homing.
+ */
+static struct
+{
+    uint64_t     start_ms;          /**< Relay switched on */
+    int          slow_ticks;        /**< Consecutive ticks below the threshold */
+    int          count;             /**< Samples in the ring */
+    unsigned     head;              /**< Next slot */
+    TiltSample_t ring[TILT_STALL_SAMPLES];
+} g_stall;
+
+static TiltStallEvent_t g_stall_event;
+static int              g_stall_trips = 0;
+
+/**
+ * @brief Last band-mode move, waiting to be learned from once settled.
+ */
+static struct
+{
+    int      pending;           /**< 1 until learned or discarded */
+    int      direction_up;      /**< Direction of the move */
+    int      goal_adc;          /**< Target of the move */
+    float    travel_volts;      /**< Distance from start to target */
+    uint64_t stop_ms;           /**< Relay release time */
+} g_learn = { 0, 0, 0, 0.0f, 0 };
 
 static const uint64_t k_timeout_margin_ms     = 2000U;
 static const uint64_t k_stall_timeout_ms      = 2000U;
 static const int      k_progress_adc_threshold = 5;
+static const float    k_est_alpha              = 0.5f;
+static const float    k_est_beta               = 0.3f;
+static const uint64_t k_est_min_dt_ms          = 20U;
+static const int      k_settle_coasts          = 4;
+static const uint64_t k_settle_default_ms      = 2000U;
+static const uint64_t k_stall_grace_ms         = 300U;
+static const uint64_t k_stall_startup_ms       = 600U;
+static const float    k_stall_startup_ratio    = 0.2f;
+static const float    k_stall_run_ratio        = 0.5f;
+static const int      k_stall_slow_ticks       = 2;
+static const int      k_fine_max_pulses        = 8;
+static const int      k_fine_min_pulse_ms      = 5;
+static const int      k_fine_max_pulse_ms      = 500;
 
 /**
  * @brief Get a monotonic timestamp in milliseconds.
  *
+ * Real or virtual time, see @ref time_source.h. Inside a control tick
+ * this is the timestamp of the tick (control_tick.h), shared by every
+ * engine call of that tick.
+ *
  * @return Monotonic time in milliseconds.
  */
 static uint64_t ControlTilt_NowMs(void)
 {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+    const ControlTick_t *tick = ControlTick_Now();
+    const ExecTick_t *exec;
+
+    if (tick) return ControlTick_Ms(tick);
+
+    exec = Exec_Now();
+    return exec ? exec->t_us / 1000ULL : TimeSource_NowMs();
+}
+
+/**
+ * @brief Read the tilt ADC, once per control tick.
+ *
+ * @return ADC counts, or -1 on error.
+ */
+static int ControlTilt_ReadAdc(void)
+{
+    ControlTick_t *tick = ControlTick_Now();
+
+    return tick ? ControlTick_TiltAdc(tick) : ReadTiltPosition();
 }
 
 /**
  * @brief Check whether a new control tick should run.
  *
+ * @param tick         Context of the current tick.
  * @param last_tick_ms Pointer to the last tick timestamp.
  * @param interval_ms  Control interval in milliseconds.
- * @return 1 if a tick should run, 0 otherwise.
+ * @return 1 if a tick should run (always inside an executive task),
+ *         0 otherwise.
  */
-static int ControlTilt_ShouldTick(uint64_t *last_tick_ms, int interval_ms)
+static int ControlTilt_ShouldTick(const ControlTick_t *tick,
+                                  uint64_t *last_tick_ms, int interval_ms)
 {
-    uint64_t now = ControlTilt_NowMs();
+    uint64_t now = ControlTick_Ms(tick);
 
     if (!last_tick_ms) return 1;
 
-    if (interval_ms <= 0) {
+    /* Called from an executive task: the task period is the rate */
+    if (interval_ms <= 0 || tick->paced) {
         *last_tick_ms = now;
         return 1;
     }
@@ -128,9 +246,383 @@ static int ControlTilt_ShouldTick(uint64_t *last_tick_ms, int interval_ms)
         return 1;
     }
 
+    /* Nothing to do until the next tick; lets virtual time move on */
+    TimeSource_IdleUntilUs((*last_tick_ms + (uint64_t)interval_ms) * 1000ULL);
+
     return 0;
 }
 
+/**
+ * @brief Block until the next control tick is due.
+ *
+ * Used by the blocking wrappers between service calls instead of spinning.
+ * While homing, a home sensor edge (di_edge.h) wakes the caller at once;
+ * during a fine pulse, the end of the pulse does.
+ *
+ * @param last_tick_ms Last tick of the sequence being serviced.
+ */
+static void ControlTilt_WaitTick(uint64_t last_tick_ms)
+{
+    int interval_ms = (g_cal.control_time_ms > 0) ? g_cal.control_time_ms : 1;
+    int fd = g_home.active ? di_edge_fd(g_home.edge_sub) : -1;
+    uint64_t due_ms = last_tick_ms + (uint64_t)interval_ms;
+
+    /* A fine pulse ends between ticks */
+    if (g_motion.active && g_motion.phase == TILT_PHASE_PULSE &&
+        g_motion.pulse_end_ms < due_ms)
+        due_ms = g_motion.pulse_end_ms;
+
+    TimeSource_WaitUntilUs(due_ms * 1000ULL, fd);
+}
+
+/* -------------------------------------------------------------------------
+ * Position/velocity estimate
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Restart the estimate at rest.
+ *
+ * @param adc Current position (ADC counts).
+ * @param now Current time (ms).
+ */
+static void ControlTilt_EstimateReset(int adc, uint64_t now)
+{
+    g_est.x    = (float)adc;
+    g_est.v    = 0.0f;
+    g_est.dt   = 0.0f;
+    g_est.t_ms = now;
+}
+
+/**
+ * @brief Correct the estimate with the ADC sample of a control tick.
+ *
+ * @param adc Sample of the tick (ADC counts).
+ * @param now Timestamp of the tick (ms).
+ */
+static void ControlTilt_EstimateUpdate(int adc, uint64_t now)
+{
+    float dt, x, r;
+
+    /* The first tick of a move runs at (or just after) the Begin time */
+    if (now < g_est.t_ms + k_est_min_dt_ms) return;
+
+    dt = (float)(now - g_est.t_ms) / 1000.0f;
+    x  = g_est.x + g_est.v * dt;
+    r  = (float)adc - x;
+
+    g_est.x    = x + k_est_alpha * r;
+    g_est.v   += k_est_beta * r / dt;
+    g_est.dt   = dt;
+    g_est.t_ms = now;
+}
+
+/**
+ * @brief Predictive stop: should the relay drop on this tick?
+ *
+ * Once released the actuator coasts roughly velocity x coast_ms further.
+ * Stop when that lands on or past the goal, or when landing from here is
+ * closer to the goal than landing one control period later.
+ *
+ * @param adc Sample of the tick (ADC counts).
+ * @return 1 to release the relay now, 0 to keep driving.
+ */
+static int ControlTilt_PredictStop(int adc)
+{
+    float sign   = g_motion.direction_up ? 1.0f : -1.0f;
+    float coast  = (g_cal.coast_ms > 0.0f) ? g_cal.coast_ms / 1000.0f : 0.0f;
+    float period = (g_est.dt > 0.0f) ? g_est.dt
+                                     : (float)g_cal.control_time_ms / 1000.0f;
+    float togo   = sign * ((float)g_motion.goal_adc - g_est.x);
+    float speed  = sign * g_est.v;
+    float short_now, short_next;
+
+    /* Already there, whatever the estimate says */
+    if (sign * (float)(g_motion.goal_adc - adc) <= 0.0f) return 1;
+
+    /* Still spinning up or not moving: no prediction yet */
+    if (speed <= 0.0f) return 0;
+
+    short_now  = togo - speed * coast;
+    short_next = togo - speed * (period + coast);
+
+    if (short_now <= 0.0f) return 1;
+    return short_next < 0.0f && -short_next > short_now;
+}
+
+/* -------------------------------------------------------------------------
+ * Stall detection
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Calibrated full speed of the actuator.
+ *
+ * @return Volts per second, from sec_per_degree and the volt/degree span.
+ */
+static float ControlTilt_ExpectedSpeed(void)
+{
+    float span_deg  = g_cal.max_angle - g_cal.min_angle;
+    float span_volt = g_cal.max_volts - g_cal.min_volts;
+
+    if (span_deg <= 0.0f) return 0.0f;
+    return fabsf(span_volt / span_deg) / ControlTilt_SecPerDegree();
+}
+
+/**
+ * @brief Restart the stall detector when the relay switches on.
+ *
+ * @param now Current time (ms).
+ */
+static void ControlTilt_StallReset(uint64_t now)
+{
+    g_stall.start_ms   = now;
+    g_stall.slow_ticks = 0;
+    g_stall.count      = 0;
+    g_stall.head       = 0;
+}
+
+/**
+ * @brief Record a control tick and check for a stall.
+ *
+ * For the first k_stall_grace_ms the relay may still be reversing a
+ * coasting actuator and nothing is checked. Then the estimated speed
+ * towards the target must reach k_stall_startup_ratio of the calibrated
+ * speed until k_stall_startup_ms, and k_stall_run_ratio after that;
+ * k_stall_slow_ticks ticks in a row below it trip. Call after
+ * ControlTilt_EstimateUpdate().
+ *
+ * @param up     Commanded direction.
+ * @param adc    Sample of the tick (ADC counts).
+ * @param now    Timestamp of the tick (ms).
+ * @param homing 1 while homing (for the event record).
+ * @return 1 on a stall trip, 0 otherwise.
+ */
+static int ControlTilt_CheckStall(int up, int adc, uint64_t now, int homing)
+{
+    TiltSample_t *smp = &g_stall.ring[g_stall.head];
+    float    expected = ControlTilt_ExpectedSpeed();
+    float    speed    = (up ? g_est.v : -g_est.v) / 1000.0f;
+    uint64_t since    = now - g_stall.start_ms;
+    int      startup  = since < k_stall_startup_ms;
+    float    min_speed;
+
+    smp->t_ms  = now;
+    smp->adc   = adc;
+    smp->speed = g_est.v / 1000.0f;
+    g_stall.head = (g_stall.head + 1) % TILT_STALL_SAMPLES;
+    if (g_stall.count < TILT_STALL_SAMPLES) g_stall.count++;
+
+    if (since < k_stall_grace_ms || g_est.dt <= 0.0f || expected <= 0.0f) return 0;
+
+    min_speed = expected * (startup ? k_stall_startup_ratio : k_stall_run_ratio);
+    if (speed >= min_speed) {
+        g_stall.slow_ticks = 0;
+        return 0;
+    }
+    if (++g_stall.slow_ticks < k_stall_slow_ticks) return 0;
+
+    g_stall_event.t_ms           = now;
+    g_stall_event.homing         = homing;
+    g_stall_event.direction_up   = up;
+    g_stall_event.startup        = startup;
+    g_stall_event.expected_speed = expected;
+    g_stall_event.min_speed      = min_speed;
+    g_stall_event.count          = g_stall.count;
+    for (int i = 0; i < g_stall.count; i++) {
+        unsigned slot = (g_stall.head + TILT_STALL_SAMPLES - (unsigned)g_stall.count +
+                         (unsigned)i) % TILT_STALL_SAMPLES;
+        g_stall_event.samples[i] = g_stall.ring[slot];
+    }
+    g_stall_trips++;
+
+    fprintf(stderr, "ControlTilt: stall %s at %.3f V, %.3f V/s (min %.3f V/s)\n",
+            homing ? "homing" : (up ? "out" : "in"), adc / 1000.0f, speed, min_speed);
+    return 1;
+}
+
+/* -------------------------------------------------------------------------
+ * Stop-band learning
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Learn from the last move, at rest at @p adc.
+ *
+ * @param adc Settled position (ADC counts).
+ */
+static void ControlTilt_LearnFrom(int adc)
+{
+    float error = (float)(g_learn.direction_up ? adc - g_learn.goal_adc
+                                               : g_learn.goal_adc - adc) / 1000.0f;
+
+    ControlStopBand_Learn(g_learn.direction_up, g_learn.travel_volts, error);
+    g_learn.pending = 0;
+}
+
+/**
+ * @brief Learn from the last move once the actuator has settled.
+ *
+ * Settled = k_settle_coasts coast time constants after the relay dropped.
+ * The first position seen after that feeds control_stopband.h; a new move
+ * started earlier discards the sample, since the coast was cut short.
+ *
+ * @param adc Current position (ADC counts).
+ * @param now Current time (ms).
+ * @param discard 1 to drop a sample that is not settled yet.
+ */
+static void ControlTilt_LearnSettled(int adc, uint64_t now, int discard)
+{
+    uint64_t settle_ms = (g_cal.coast_ms > 0.0f)
+                         ? (uint64_t)(k_settle_coasts * g_cal.coast_ms)
+                         : k_settle_default_ms;
+
+    if (!g_learn.pending || adc < 0) return;
+
+    if (now - g_learn.stop_ms < settle_ms) {
+        if (discard) g_learn.pending = 0;
+        return;
+    }
+
+    ControlTilt_LearnFrom(adc);
+}
+
+/* -------------------------------------------------------------------------
+ * Fine positioning
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Check whether the final pulse approach is configured.
+ */
+static int ControlTilt_FineEnabled(void)
+{
+    return g_cal.fine_tolerance > 0.0f && g_cal.fine_window > g_cal.fine_tolerance;
+}
+
+/**
+ * @brief Pulse gain for a direction: learned, else the calibrated one.
+ */
+static float ControlTilt_PulseGain(int up)
+{
+    float gain = g_pulse_gain[up ? 1 : 0];
+
+    if (gain > 0.0f) return gain;
+    return (g_cal.fine_volts_per_ms > 0.0f) ? g_cal.fine_volts_per_ms : 0.001f;
+}
+
+/**
+ * @brief Learn the pulse gain from how far the last pulse moved.
+ *
+ * Divides by the time the relay was actually on, which is longer than
+ * pulse_ms when the pulse ended on a later service call.
+ *
+ * @param adc Settled position after the pulse (ADC counts).
+ */
+static void ControlTilt_LearnPulse(int adc)
+{
+    int   moved = g_motion.pulse_up ? adc - g_motion.pulse_start_adc
+                                    : g_motion.pulse_start_adc - adc;
+    float gain  = ControlTilt_PulseGain(g_motion.pulse_up);
+    float on_ms = (float)(g_motion.release_ms -
+                          (g_motion.pulse_end_ms - (uint64_t)g_motion.pulse_ms));
+
+    if (on_ms < 1.0f) on_ms = 1.0f;
+
+    /* Too short to move at all: the gain is far too high */
+    if (moved < k_progress_adc_threshold)
+        gain *= 0.5f;
+    else
+        gain += 0.5f * ((float)moved / 1000.0f / on_ms - gain);
+
+    if (gain < 1e-5f) gain = 1e-5f;
+    if (gain > 1e-2f) gain = 1e-2f;
+    g_pulse_gain[g_motion.pulse_up ? 1 : 0] = gain;
+}
+
+/**
+ * @brief Enter the settle phase with the relay off.
+ */
+static void ControlTilt_Release(uint64_t now)
+{
+    RelayTilt(0, 0);
+    g_motion.phase      = TILT_PHASE_SETTLE;
+    g_motion.release_ms = now;
+}
+
+/**
+ * @brief End a fine pulse once its time is up.
+ *
+ * Called on every service call, not only on control ticks, so a pulse can
+ * be shorter than the control period. Under the executive the command task
+ * services the move while ControlTilt_InPulse() is set, so pulses end
+ * within one base tick.
+ *
+ * @param tick Context of the current tick.
+ * @return TILT_RUNNING while the pulse is on, TILT_OK once it has ended.
+ */
+static TiltResult_t ControlTilt_ServicePulse(const ControlTick_t *tick)
+{
+    uint64_t now = ControlTick_Ms(tick);
+
+    if (now >= g_motion.pulse_end_ms) {
+        ControlTilt_Release(now);
+        return TILT_OK;
+    }
+
+    /* Nothing to do until the pulse ends; lets virtual time move on */
+    if (!tick->paced)
+        TimeSource_IdleUntilUs(g_motion.pulse_end_ms * 1000ULL);
+    return TILT_RUNNING;
+}
+
+/**
+ * @brief Settle phase: wait out the coast, then finish or pulse again.
+ *
+ * Settled = one coast time constant after release and an estimated
+ * velocity whose remaining coast is within a quarter of the tolerance,
+ * or k_settle_coasts time constants at most.
+ *
+ * @param adc Sample of the tick (ADC counts).
+ * @param now Timestamp of the tick (ms).
+ * @return TILT_RUNNING while settling or pulsing, TILT_OK when done.
+ */
+static TiltResult_t ControlTilt_ServiceFine(int adc, uint64_t now)
+{
+    float    coast     = (g_cal.coast_ms > 0.0f) ? g_cal.coast_ms : 400.0f;
+    float    tol       = g_cal.fine_tolerance * 1000.0f;
+    uint64_t since     = now - g_motion.release_ms;
+    int      error     = g_motion.goal_adc - adc;
+    int      up        = error > 0;
+    float    pulse_ms;
+
+    if (since < (uint64_t)(k_settle_coasts * coast) &&
+        (since < (uint64_t)coast || fabsf(g_est.v) * coast / 1000.0f > tol / 4.0f))
+        return TILT_RUNNING;
+
+    if (g_motion.pulses == 0) {
+        if (g_learn.pending) ControlTilt_LearnFrom(adc);
+    } else {
+        ControlTilt_LearnPulse(adc);
+    }
+
+    if (!ControlTilt_FineEnabled() ||
+        (float)abs(error) <= tol ||
+        (float)abs(error) > g_cal.fine_window * 1000.0f ||
+        g_motion.pulses >= k_fine_max_pulses)
+        return TILT_OK;
+
+    pulse_ms = (float)abs(error) / 1000.0f / ControlTilt_PulseGain(up);
+    if (pulse_ms < (float)k_fine_min_pulse_ms) pulse_ms = (float)k_fine_min_pulse_ms;
+    if (pulse_ms > (float)k_fine_max_pulse_ms) pulse_ms = (float)k_fine_max_pulse_ms;
+
+    g_motion.phase           = TILT_PHASE_PULSE;
+    g_motion.pulses++;
+    g_motion.pulse_up        = up;
+    g_motion.pulse_ms        = (int)(pulse_ms + 0.5f);
+    g_motion.pulse_start_adc = adc;
+    g_motion.pulse_end_ms    = now + (uint64_t)g_motion.pulse_ms;
+
+    RelayTilt(up, 1);
+    return TILT_RUNNING;
+}
+
 /* -------------------------------------------------------------------------
  * Calibration
  * ------------------------------------------------------------------------- */
@@ -154,6 +646,12 @@ void ControlTilt_ApplyCalibration(const TiltCalibration_t *cfg)
     g_cal.max_angle       = cfg->max_angle;
     g_cal.min_angle       = cfg->min_angle;
     g_cal.control_time_ms = cfg->control_time_ms;
+    g_cal.stop_predict    = cfg->stop_predict;
+    g_cal.coast_ms        = cfg->coast_ms;
+    g_cal.learn_stop_band = cfg->learn_stop_band;
+    g_cal.fine_window     = cfg->fine_window;
+    g_cal.fine_tolerance  = cfg->fine_tolerance;
+    g_cal.fine_volts_per_ms = cfg->fine_volts_per_ms;
 }
 
 /* -------------------------------------------------------------------------
@@ -194,6 +692,16 @@ float ControlTilt_VoltToTilt(float volts)
            (volts - g_cal.min_volts) * (span_deg / span_volt);
 }
 
+/**
+ * @brief Calibrated tilt speed.
+ *
+ * @return Seconds per degree (0.5 if the calibration has none).
+ */
+float ControlTilt_SecPerDegree(void)
+{
+    return (g_cal.sec_per_degree > 0.0f) ? g_cal.sec_per_degree : 0.5f;
+}
+
 /**
  * @brief Compute a conservative timeout for a tilt move.
  *
@@ -239,11 +747,13 @@ static uint64_t ControlTilt_ComputeHomeTimeoutMs(void)
 /**
  * @brief Read raw tilt voltage from ADC.
  *
+ * Inside a control tick this is the tick's sample (control_tick.h).
+ *
  * @return Voltage value, or negative on error.
  */
 float ControlTilt_ReadVolt(void)
 {
-    int adc = ReadTiltPosition();
+    int adc = ControlTilt_ReadAdc();
     if (adc < 0) return -1.0f;
     return adc / 1000.0f;
 }
@@ -263,6 +773,49 @@ float ControlTilt_ReadDegree(void)
     return deg;
 }
 
+/**
+ * @brief Estimated tilt velocity of the current move.
+ *
+ * @return Volts per second, positive when pulling OUT.
+ */
+float ControlTilt_ReadSpeed(void)
+{
+    return g_est.v / 1000.0f;
+}
+
+/**
+ * @brief Learned fine-positioning pulse gain.
+ *
+ * @param up 1 for pulses OUT, 0 for pulses IN.
+ * @return Volts per ms of pulse (the calibrated value until learned).
+ */
+float ControlTilt_ReadPulseGain(int up)
+{
+    return ControlTilt_PulseGain(up);
+}
+
+/**
+ * @brief Check whether a fine-positioning pulse is on.
+ *
+ * @return 1 while the relay is on for a timed pulse, 0 otherwise.
+ */
+int ControlTilt_InPulse(void)
+{
+    return g_motion.active && g_motion.phase == TILT_PHASE_PULSE;
+}
+
+/**
+ * @brief Last stall trip, for diagnosis.
+ *
+ * @param out Optional output for the last event.
+ * @return Number of stall trips so far.
+ */
+int ControlTilt_GetStallEvent(TiltStallEvent_t *out)
+{
+    if (out && g_stall_trips > 0) *out = g_stall_event;
+    return g_stall_trips;
+}
+
 /**
  * @brief Check whether the tilt axis is at the HOME position.
  *
@@ -277,6 +830,22 @@ int ControlTilt_CheckHome(void)
  * Homing (non-blocking)
  * ------------------------------------------------------------------------- */
 
+/**
+ * @brief Check for a home-sensor edge captured by the IO scan (di_edge.h).
+ *
+ * @return 1 if the sensor triggered since homing began.
+ */
+static int ControlTilt_HomeEdge(void)
+{
+    DiEdge_t edge;
+
+    if (g_home.edge_sub < 0) return 0;
+    if (di_edge_next(g_home.edge_sub, &edge) <= 0) return 0;
+
+    di_edge_flush(g_home.edge_sub);
+    return 1;
+}
+
 /**
  * @brief Begin a non-blocking homing sequence.
  *
@@ -286,6 +855,8 @@ int ControlTilt_CheckHome(void)
  */
 TiltResult_t ControlTilt_BeginHome(void)
 {
+    g_learn.pending = 0;
+
     /* Already homed? */
     if (ReadHomeTilt()) {
         g_tilt_is_homed = 1;
@@ -304,23 +875,33 @@ TiltResult_t ControlTilt_BeginHome(void)
     g_home.last_tick_ms     = 0;
     g_home.timeout_ms       = ControlTilt_ComputeHomeTimeoutMs();
 
-    g_home.last_adc = ReadTiltPosition();
+    g_home.last_adc = ControlTilt_ReadAdc();
     if (g_home.last_adc < 0) g_home.last_adc = 0;
 
+    ControlTilt_EstimateReset(g_home.last_adc, now);
+    ControlTilt_StallReset(now);
+
+    /* Triggered = falling raw edge (inverted sensor) */
+    if (g_home.edge_sub < 0)
+        g_home.edge_sub = di_edge_subscribe(DI_EDGE_CH(DI_PROXI_TILT),
+                                            DI_EDGE_FALLING);
+    di_edge_flush(g_home.edge_sub);
+
     RelayTilt(0, 1);  /* 0 = IN direction */
 
     return TILT_RUNNING;
 }
 
 /**
- * @brief Service the non-blocking homing sequence.
+ * @brief Service the non-blocking homing sequence for one control tick.
  *
+ * @param tick Context of the current tick (control_tick.h).
  * @return TILT_RUNNING while moving,
  *         TILT_OK when homed,
  *         TILT_PAUSED or TILT_STOPPED on request,
  *         TILT_ERROR on fault.
  */
-TiltResult_t ControlTilt_ServiceHome(void)
+TiltResult_t ControlTilt_ServiceHomeTick(ControlTick_t *tick)
 {
     if (!g_home.active) {
         return TILT_OK;
@@ -342,12 +923,21 @@ TiltResult_t ControlTilt_ServiceHome(void)
         return TILT_STOPPED;
     }
 
-    if (!ControlTilt_ShouldTick(&g_home.last_tick_ms,
+    /* Check HOME sensor: edge at IO cycle rate, level at control rate */
+    if (ControlTilt_HomeEdge()) {
+        RelayTilt(0, 0);
+        g_home.active = 0;
+        g_tilt_is_homed = 1;
+        g_machine.tilt_state = AXIS_IDLE;
+
+        return TILT_OK;
+    }
+
+    if (!ControlTilt_ShouldTick(tick, &g_home.last_tick_ms,
                                 g_cal.control_time_ms)) {
         return TILT_RUNNING;
     }
 
-    /* Check HOME sensor */
     if (ReadHomeTilt()) {
         RelayTilt(0, 0);
         g_home.active = 0;
@@ -357,7 +947,7 @@ TiltResult_t ControlTilt_ServiceHome(void)
         return TILT_OK;
     }
 
-    int current_adc = ReadTiltPosition();
+    int current_adc = ControlTick_TiltAdc(tick);
     if (current_adc < 0) {
         RelayTilt(0, 0);
         g_home.active = 0;
@@ -365,13 +955,16 @@ TiltResult_t ControlTilt_ServiceHome(void)
         return TILT_ERROR;
     }
 
+    uint64_t now = ControlTick_Ms(tick);
     if (abs(current_adc - g_home.last_adc) >= k_progress_adc_threshold) {
         g_home.last_adc = current_adc;
-        g_home.last_progress_ms = ControlTilt_NowMs();
+        g_home.last_progress_ms = now;
     }
 
-    uint64_t now = ControlTilt_NowMs();
-    if (now - g_home.last_progress_ms > k_stall_timeout_ms) {
+    ControlTilt_EstimateUpdate(current_adc, now);
+
+    if (ControlTilt_CheckStall(0, current_adc, now, 1) ||
+        now - g_home.last_progress_ms > k_stall_timeout_ms) {
         RelayTilt(0, 0);
         g_home.active = 0;
         g_machine.tilt_state = AXIS_IDLE;
@@ -388,6 +981,26 @@ TiltResult_t ControlTilt_ServiceHome(void)
     return TILT_RUNNING;
 }
 
+/**
+ * @brief Service the non-blocking homing sequence.
+ *
+ * Uses the open control tick, or a context of its own outside one.
+ *
+ * @return See ControlTilt_ServiceHomeTick().
+ */
+TiltResult_t ControlTilt_ServiceHome(void)
+{
+    ControlTick_t own, *tick = ControlTick_Now();
+    TiltResult_t r;
+
+    if (tick) return ControlTilt_ServiceHomeTick(tick);
+
+    ControlTick_Begin(&own, 0);
+    r = ControlTilt_ServiceHomeTick(&own);
+    ControlTick_End(&own);
+    return r;
+}
+
 /**
  * @brief Blocking homing routine.
  *
@@ -399,12 +1012,10 @@ int ControlTilt_Home(void)
     if (r == TILT_OK) return 0;
     if (r == TILT_ERROR) return -1;
 
-    while (1) {
-        r = ControlTilt_ServiceHome();
-        if (r == TILT_RUNNING) continue;
-        if (r == TILT_OK)      return 0;
-        return -1; /* paused or stopped or error */
-    }
+    while ((r = ControlTilt_ServiceHome()) == TILT_RUNNING)
+        ControlTilt_WaitTick(g_home.last_tick_ms);
+
+    return (r == TILT_OK) ? 0 : -1; /* paused or stopped or error */
 }
 
 /* -------------------------------------------------------------------------
@@ -431,18 +1042,53 @@ TiltResult_t ControlTilt_BeginMoveToVolt(float target_volt)
         return TILT_ERROR;
     }
 
-    int current_adc = ReadTiltPosition();
+    int current_adc = ControlTilt_ReadAdc();
     if (current_adc < 0) {
         return TILT_ERROR;
     }
 
+    uint64_t now = ControlTilt_NowMs();
+    ControlTilt_LearnSettled(current_adc, now, 1);
+
     float current_volt = current_adc / 1000.0f;
+    int   goal_adc     = (int)(target_volt * 1000.0f + 0.5f);
 
     int up = (current_volt < target_volt) ? 1 : 0;
 
-    float compensated_volt =
-        up ? (target_volt - g_cal.stop_band_out)
-           : (target_volt + g_cal.stop_band_in);
+    /* Fine positioning: small errors are left to the pulses alone */
+    if (ControlTilt_FineEnabled()) {
+        int error = abs(goal_adc - current_adc);
+
+        if ((float)error <= g_cal.fine_tolerance * 1000.0f) {
+            g_motion.active      = 0;
+            g_machine.tilt_state = AXIS_IDLE;
+            return TILT_OK;
+        }
+
+        if ((float)error <= g_cal.fine_window * 1000.0f) {
+            g_motion.active       = 1;
+            g_motion.goal_adc     = goal_adc;
+            g_motion.direction_up = up;
+            g_motion.phase        = TILT_PHASE_SETTLE;
+            g_motion.release_ms   = 0;      /* at rest: pulse on the first tick */
+            g_motion.pulses       = 0;
+            g_motion.last_tick_ms = 0;
+            ControlTilt_EstimateReset(current_adc, now);
+
+            g_machine.tilt_state = AXIS_RUNNING_TILT;
+            g_machine.resume_requested = 0;
+            return TILT_RUNNING;
+        }
+    }
+
+    /* Predictive stop: the band only decides whether to move at all */
+    float band = g_cal.stop_predict ? g_cal.deadband
+                                    : (up ? g_cal.stop_band_out : g_cal.stop_band_in);
+
+    if (!g_cal.stop_predict && g_cal.learn_stop_band)
+        band = ControlStopBand_Get(up, target_volt - current_volt, band);
+
+    float compensated_volt = up ? (target_volt - band) : (target_volt + band);
 
     if (compensated_volt < g_cal.min_volts)
         compensated_volt = g_cal.min_volts;
@@ -462,10 +1108,18 @@ TiltResult_t ControlTilt_BeginMoveToVolt(float target_volt)
 
     g_motion.active       = 1;
     g_motion.target_adc   = compensated_adc;
+    g_motion.goal_adc     = goal_adc;
     g_motion.direction_up = up;
     g_motion.last_adc     = current_adc;
+    g_motion.phase        = TILT_PHASE_BULK;
+    g_motion.pulses       = 0;
 
-    uint64_t now = ControlTilt_NowMs();
+    g_learn.direction_up  = up;
+    g_learn.goal_adc      = g_motion.goal_adc;
+    g_learn.travel_volts  = fabsf(target_volt - current_volt);
+
+    ControlTilt_EstimateReset(current_adc, now);
+    ControlTilt_StallReset(now);
     g_motion.start_ms         = now;
     g_motion.last_progress_ms = now;
     g_motion.last_tick_ms     = 0;
@@ -480,6 +1134,23 @@ TiltResult_t ControlTilt_BeginMoveToVolt(float target_volt)
     return TILT_RUNNING;
 }
 
+/**
+ * @brief Check that a target degree is inside the calibrated range.
+ *
+ * @param degree Target angle in degrees.
+ * @return 1 if ControlTilt_BeginMoveToDegree() would accept it, 0 otherwise.
+ */
+int ControlTilt_CheckDegree(float degree)
+{
+    float volt;
+
+    if (degree < g_cal.min_angle || degree > g_cal.max_angle)
+        return 0;
+
+    volt = ControlTilt_TiltToVolt(degree);
+    return volt >= g_cal.min_volts && volt <= g_cal.max_volts;
+}
+
 /**
  * @brief Begin a non-blocking move to a target degree.
  *
@@ -501,91 +1172,118 @@ TiltResult_t ControlTilt_BeginMoveToDegree(float target_degree)
 }
 
 /**
- * @brief Service the non-blocking tilt motion.
+ * @brief Service the non-blocking tilt motion for one control tick.
  *
+ * The position is read once per tick (ControlTick_TiltAdc()) and feeds the
+ * velocity estimate. The relay drops when the position crosses the stop
+ * band, or with stop_predict when the predicted coast-down lands closest
+ * to the target. With fine positioning the move then settles and
+ * continues with timed pulses until inside fine_tolerance.
+ *
+ * @param tick Context of the current tick (control_tick.h).
  * @param actual_volt_out Optional output for current voltage.
  * @return TILT_RUNNING while moving,
  *         TILT_OK when target reached,
  *         TILT_PAUSED or TILT_STOPPED on request,
  *         TILT_ERROR on fault.
  */
-TiltResult_t ControlTilt_Service(float *actual_volt_out)
+TiltResult_t ControlTilt_ServiceTick(ControlTick_t *tick, float *actual_volt_out)
 {
-    if (!g_motion.active) {
-        if (actual_volt_out) {
-            *actual_volt_out = ControlTilt_ReadVolt();
-        }
-        return TILT_OK;
-    }
-
-    if (g_machine.stop_requested) {
-        RelayTilt(0, 0);
-        g_motion.active      = 0;
-        g_machine.tilt_state = AXIS_IDLE;
-        if (actual_volt_out) *actual_volt_out = ControlTilt_ReadVolt();
-        return TILT_STOPPED;
-    }
+    TiltResult_t r = TILT_RUNNING;
 
-    if (g_machine.pause_requested) {
+    if (!g_motion.active) {
+        if (g_learn.pending)
+            ControlTilt_LearnSettled(ControlTick_TiltAdc(tick), ControlTick_Ms(tick), 0);
+        r = TILT_OK;
+    } else if (g_machine.stop_requested) {
         RelayTilt(0, 0);
         g_motion.active      = 0;
         g_machine.tilt_state = AXIS_IDLE;
-        if (actual_volt_out) *actual_volt_out = ControlTilt_ReadVolt();
-        return TILT_PAUSED;
-    }
-
-    if (!ControlTilt_ShouldTick(&g_motion.last_tick_ms,
-                                g_cal.control_time_ms)) {
-        if (actual_volt_out) *actual_volt_out = ControlTilt_ReadVolt();
-        return TILT_RUNNING;
-    }
-
-    int current_adc = ReadTiltPosition();
-    if (current_adc < 0) {
+        r = TILT_STOPPED;
+    } else if (g_machine.pause_requested) {
         RelayTilt(0, 0);
         g_motion.active      = 0;
         g_machine.tilt_state = AXIS_IDLE;
-        return TILT_ERROR;
-    }
+        r = TILT_PAUSED;
+    } else if (g_motion.phase == TILT_PHASE_PULSE &&
+               ControlTilt_ServicePulse(tick) == TILT_RUNNING) {
+        /* Relay on until the pulse ends */
+    } else if (ControlTilt_ShouldTick(tick, &g_motion.last_tick_ms,
+                                      g_cal.control_time_ms)) {
+        int current_adc = ControlTick_TiltAdc(tick);
+        uint64_t now    = ControlTick_Ms(tick);
+
+        if (current_adc < 0) {
+            RelayTilt(0, 0);
+            g_motion.active      = 0;
+            g_machine.tilt_state = AXIS_IDLE;
+            return TILT_ERROR;
+        }
 
-    if (abs(current_adc - g_motion.last_adc) >= k_progress_adc_threshold) {
-        g_motion.last_adc = current_adc;
-        g_motion.last_progress_ms = ControlTilt_NowMs();
+        ControlTilt_EstimateUpdate(current_adc, now);
+
+        if (g_motion.phase == TILT_PHASE_BULK) {
+            if (abs(current_adc - g_motion.last_adc) >= k_progress_adc_threshold) {
+                g_motion.last_adc = current_adc;
+                g_motion.last_progress_ms = now;
+            }
+
+            if (ControlTilt_CheckStall(g_motion.direction_up, current_adc, now, 0) ||
+                now - g_motion.last_progress_ms > k_stall_timeout_ms ||
+                now - g_motion.start_ms > g_motion.timeout_ms) {
+                RelayTilt(0, 0);
+                g_motion.active      = 0;
+                g_machine.tilt_state = AXIS_IDLE;
+                return TILT_ERROR;
+            }
+
+            if (g_cal.stop_predict
+                    ? ControlTilt_PredictStop(current_adc)
+                    : ((g_motion.direction_up && current_adc >= g_motion.target_adc) ||
+                       (!g_motion.direction_up && current_adc <= g_motion.target_adc))) {
+                g_learn.pending = !g_cal.stop_predict && g_cal.learn_stop_band;
+                g_learn.stop_ms = now;
+
+                ControlTilt_Release(now);
+                if (!ControlTilt_FineEnabled()) {
+                    g_motion.active      = 0;
+                    g_machine.tilt_state = AXIS_IDLE;
+                    r = TILT_OK;
+                }
+            }
+        } else if (ControlTilt_ServiceFine(current_adc, now) == TILT_OK) {
+            g_motion.active      = 0;
+            g_machine.tilt_state = AXIS_IDLE;
+            r = TILT_OK;
+        }
     }
 
-    uint64_t now = ControlTilt_NowMs();
-    if (now - g_motion.last_progress_ms > k_stall_timeout_ms) {
-        RelayTilt(0, 0);
-        g_motion.active      = 0;
-        g_machine.tilt_state = AXIS_IDLE;
-        return TILT_ERROR;
-    }
-
-    if (now - g_motion.start_ms > g_motion.timeout_ms) {
-        RelayTilt(0, 0);
-        g_motion.active      = 0;
-        g_machine.tilt_state = AXIS_IDLE;
-        return TILT_ERROR;
+    if (actual_volt_out) {
+        int adc = ControlTick_TiltAdc(tick);
+        *actual_volt_out = (adc < 0) ? -1.0f : adc / 1000.0f;
     }
+    return r;
+}
 
-    if (g_motion.direction_up && current_adc >= g_motion.target_adc) {
-        RelayTilt(0, 0);
-        g_motion.active      = 0;
-        g_machine.tilt_state = AXIS_IDLE;
-        if (actual_volt_out) *actual_volt_out = ControlTilt_ReadVolt();
-        return TILT_OK;
-    }
+/**
+ * @brief Service the non-blocking tilt motion.
+ *
+ * Uses the open control tick, or a context of its own outside one.
+ *
+ * @param actual_volt_out Optional output for current voltage.
+ * @return See ControlTilt_ServiceTick().
+ */
+TiltResult_t ControlTilt_Service(float *actual_volt_out)
+{
+    ControlTick_t own, *tick = ControlTick_Now();
+    TiltResult_t r;
 
-    if (!g_motion.direction_up && current_adc <= g_motion.target_adc) {
-        RelayTilt(0, 0);
-        g_motion.active      = 0;
-        g_machine.tilt_state = AXIS_IDLE;
-        if (actual_volt_out) *actual_volt_out = ControlTilt_ReadVolt();
-        return TILT_OK;
-    }
+    if (tick) return ControlTilt_ServiceTick(tick, actual_volt_out);
 
-    if (actual_volt_out) *actual_volt_out = current_adc / 1000.0f;
-    return TILT_RUNNING;
+    ControlTick_Begin(&own, 0);
+    r = ControlTilt_ServiceTick(&own, actual_volt_out);
+    ControlTick_End(&own);
+    return r;
 }
 
 /* -------------------------------------------------------------------------
@@ -608,12 +1306,10 @@ TiltResult_t ControlTilt_MoveToVolt(float target_volt,
         return r;
     }
 
-    while (1) {
-        r = ControlTilt_Service(actual_volt_out);
-        if (r != TILT_RUNNING) {
-            return r;
-        }
-    }
+    while ((r = ControlTilt_Service(actual_volt_out)) == TILT_RUNNING)
+        ControlTilt_WaitTick(g_motion.last_tick_ms);
+
+    return r;
 }
 
 /**
@@ -663,6 +1359,7 @@ int ControlTilt_Pause(void)
     RelayTilt(0, 0);
     g_motion.active      = 0;
     g_home.active        = 0;
+    g_learn.pending      = 0;
     g_machine.tilt_state = AXIS_IDLE;
     printf("[Tilt] Paused at %.2f deg\n", g_last_degree);
     return 0;
@@ -0,0 +1,148 @@
+/**
+ * @file ai_filter.c
+ * @brief Per-channel AI sample rings and filters.
+ *
+ * All channels are sampled in the same IO cycle, so the rings share one
+ * write index and one timestamp per slot.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "ai_filter.h"
+
+typedef struct
+{
+    uint16_t value[AI_FILTER_DEPTH];
+    float    ema;
+    float    alpha;     /* 0 = AI_FILTER_EMA_ALPHA */
+} AiFilterChan_t;
+
+static AiFilterChan_t g_chan[AI_FILTER_CHANNELS];
+static uint64_t       g_t_us[AI_FILTER_DEPTH];
+static uint64_t       g_count = 0;      /* Cycles fed since the last reset */
+
+void ai_filter_update(const uint8_t *ai, uint64_t t_us)
+{
+    unsigned slot = (unsigned)(g_count % AI_FILTER_DEPTH);
+    int gap;
+
+    gap = (g_count == 0) ||
+          t_us - g_t_us[(g_count - 1) % AI_FILTER_DEPTH] > AI_FILTER_WINDOW_US;
+
+    for (int i = 0; i < AI_FILTER_CHANNELS; i++) {
+        AiFilterChan_t *c = &g_chan[i];
+        float alpha = (c->alpha > 0.0f) ? c->alpha : AI_FILTER_EMA_ALPHA;
+        uint16_t v;
+
+        memcpy(&v, ai + 2 * i, sizeof(v));
+        c->value[slot] = v;
+
+        if (gap)
+            c->ema = (float)v;
+        else
+            c->ema += alpha * ((float)v - c->ema);
+    }
+
+    g_t_us[slot] = t_us;
+    g_count++;
+}
+
+void ai_filter_reset(void)
+{
+    for (int i = 0; i < AI_FILTER_CHANNELS; i++) {
+        memset(g_chan[i].value, 0, sizeof(g_chan[i].value));
+        g_chan[i].ema = 0.0f;
+    }
+    memset(g_t_us, 0, sizeof(g_t_us));
+    g_count = 0;
+}
+
+int ai_filter_set_ema_alpha(int ch, float alpha)
+{
+    if (ch < 1 || ch > AI_FILTER_CHANNELS || !(alpha > 0.0f && alpha <= 1.0f))
+        return -1;
+
+    g_chan[ch - 1].alpha = alpha;
+    return 0;
+}
+
+int ai_filter_count(int ch, int n)
+{
+    uint64_t newest;
+    int k;
+
+    if (ch < 1 || ch > AI_FILTER_CHANNELS || g_count == 0 || n < 1)
+        return 0;
+
+    if (n > AI_FILTER_DEPTH) n = AI_FILTER_DEPTH;
+    if ((uint64_t)n > g_count) n = (int)g_count;
+
+    newest = g_t_us[(g_count - 1) % AI_FILTER_DEPTH];
+    for (k = 1; k < n; k++) {
+        if (newest - g_t_us[(g_count - 1 - k) % AI_FILTER_DEPTH] > AI_FILTER_WINDOW_US)
+            break;
+    }
+    return k;
+}
+
+/* Copy the samples the filters use, newest first; returns how many */
+static int ai_filter_window(int ch, int n, uint16_t *out)
+{
+    int k = ai_filter_count(ch, n);
+
+    for (int i = 0; i < k; i++)
+        out[i] = g_chan[ch - 1].value[(g_count - 1 - i) % AI_FILTER_DEPTH];
+    return k;
+}
+
+int ai_filter_raw(int ch)
+{
+    uint16_t v;
+
+    return ai_filter_window(ch, 1, &v) == 1 ? v : -1;
+}
+
+int ai_filter_mean(int ch, int n)
+{
+    uint16_t v[AI_FILTER_DEPTH];
+    uint32_t sum = 0;
+    int k = ai_filter_window(ch, n, v);
+
+    if (k == 0) return -1;
+
+    for (int i = 0; i < k; i++)
+        sum += v[i];
+    return (int)((sum + (uint32_t)k / 2) / (uint32_t)k);
+}
+
+int ai_filter_median(int ch, int n)
+{
+    uint16_t v[AI_FILTER_DEPTH];
+    int k = ai_filter_window(ch, n, v);
+
+    if (k == 0) return -1;
+
+    /* Insertion sort: at most AI_FILTER_DEPTH samples */
+    for (int i = 1; i < k; i++) {
+        uint16_t x = v[i];
+        int j = i - 1;
+
+        while (j >= 0 && v[j] > x) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = x;
+    }
+
+    if (k % 2) return v[k / 2];
+    return ((int)v[k / 2 - 1] + (int)v[k / 2]) / 2;
+}
+
+int ai_filter_ema(int ch)
+{
+    if (ch < 1 || ch > AI_FILTER_CHANNELS || g_count == 0)
+        return -1;
+
+    return (int)(g_chan[ch - 1].ema + 0.5f);
+}
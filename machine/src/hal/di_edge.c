@@ -0,0 +1,292 @@
+/**
+ * @file di_edge.c
+ * @brief DI edge ring and eventfd subscribers.
+ *
+ * Ring slots use a sequence word like a seqlock: the producer clears it,
+ * writes the edge, then stores edge number + 1. A consumer accepts a slot
+ * only if the word equals the edge it expects before and after copying,
+ * so a slot overwritten by a wrap is detected and counted as lost instead
+ * of being returned torn.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include "di_edge.h"
+
+#define DI_EDGE_CHANNELS  4
+#define DI_EDGE_MASK      (DI_EDGE_RING_SIZE - 1)
+
+typedef struct
+{
+    uint64_t seq;      /* Edge number + 1, 0 while being written */
+    DiEdge_t edge;
+} DiEdgeSlot_t;
+
+enum { SUB_FREE = 0, SUB_CLAIMED, SUB_ACTIVE };
+
+typedef struct
+{
+    int      state;    /* SUB_* */
+    unsigned ch_mask;
+    unsigned edges;
+    int      fd;       /* Kept open for the slot's lifetime, see unsubscribe */
+    int      has_fd;
+    uint64_t tail;     /* Next edge number to read */
+    uint64_t lost;
+} DiEdgeSub_t;
+
+static DiEdgeSlot_t g_ring[DI_EDGE_RING_SIZE];
+static uint64_t     g_head   = 0;      /* Edges published */
+static int          g_levels = -1;     /* DI1–DI4 as of the last cycle */
+
+static DiEdgeSub_t  g_subs[DI_EDGE_MAX_SUBS];
+
+static DiEdgeSub_t *di_edge_sub(int sub)
+{
+    if (sub < 0 || sub >= DI_EDGE_MAX_SUBS)
+        return NULL;
+    if (__atomic_load_n(&g_subs[sub].state, __ATOMIC_ACQUIRE) != SUB_ACTIVE)
+        return NULL;
+    return &g_subs[sub];
+}
+
+static int di_edge_matches(const DiEdgeSub_t *s, const DiEdge_t *e)
+{
+    unsigned dir = e->level ? DI_EDGE_RISING : DI_EDGE_FALLING;
+    return (s->ch_mask & DI_EDGE_CH(e->ch)) && (s->edges & dir);
+}
+
+/* -------------------------------------------------------------------------
+ * Producer
+ * ------------------------------------------------------------------------- */
+
+static void di_edge_publish(uint8_t ch, uint8_t level, uint64_t t_us)
+{
+    uint64_t idx = g_head;
+    DiEdgeSlot_t *slot = &g_ring[idx & DI_EDGE_MASK];
+    uint64_t one = 1;
+
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->edge.t_us  = t_us;
+    slot->edge.seq   = idx;
+    slot->edge.ch    = ch;
+    slot->edge.level = level;
+
+    __atomic_store_n(&slot->seq, idx + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&g_head, idx + 1, __ATOMIC_RELEASE);
+
+    for (int i = 0; i < DI_EDGE_MAX_SUBS; i++) {
+        DiEdgeSub_t *s = di_edge_sub(i);
+        if (s && di_edge_matches(s, &slot->edge)) {
+            /* EAGAIN (counter saturated) is fine: the edge is in the ring */
+            ssize_t n = write(s->fd, &one, sizeof(one));
+            (void)n;
+        }
+    }
+}
+
+void di_edge_update(uint8_t di_byte, uint64_t t_us)
+{
+    int levels = di_byte & ((1 << DI_EDGE_CHANNELS) - 1);
+    int changed;
+
+    if (g_levels < 0) {
+        __atomic_store_n(&g_levels, levels, __ATOMIC_RELAXED);
+        return;
+    }
+
+    changed = levels ^ g_levels;
+    if (!changed)
+        return;
+
+    for (int ch = 1; ch <= DI_EDGE_CHANNELS; ch++) {
+        if (changed & DI_EDGE_CH(ch))
+            di_edge_publish((uint8_t)ch, (levels & DI_EDGE_CH(ch)) ? 1 : 0, t_us);
+    }
+
+    __atomic_store_n(&g_levels, levels, __ATOMIC_RELAXED);
+}
+
+int di_edge_level(int ch)
+{
+    int levels = __atomic_load_n(&g_levels, __ATOMIC_RELAXED);
+
+    if (levels < 0 || ch < 1 || ch > DI_EDGE_CHANNELS)
+        return -1;
+    return (levels & DI_EDGE_CH(ch)) ? 1 : 0;
+}
+
+/* -------------------------------------------------------------------------
+ * Subscribers
+ * ------------------------------------------------------------------------- */
+
+int di_edge_subscribe(unsigned ch_mask, unsigned edges)
+{
+    for (int i = 0; i < DI_EDGE_MAX_SUBS; i++) {
+        DiEdgeSub_t *s = &g_subs[i];
+        int expected = SUB_FREE;
+
+        if (!__atomic_compare_exchange_n(&s->state, &expected, SUB_CLAIMED, 0,
+                                         __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            continue;
+
+        if (!s->has_fd) {
+            s->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (s->fd < 0) {
+                __atomic_store_n(&s->state, SUB_FREE, __ATOMIC_RELEASE);
+                return -1;
+            }
+            s->has_fd = 1;
+        }
+
+        s->ch_mask = ch_mask;
+        s->edges   = edges;
+        s->tail    = __atomic_load_n(&g_head, __ATOMIC_ACQUIRE);
+        s->lost    = 0;
+
+        __atomic_store_n(&s->state, SUB_ACTIVE, __ATOMIC_RELEASE);
+        return i;
+    }
+
+    return -1;
+}
+
+void di_edge_unsubscribe(int sub)
+{
+    DiEdgeSub_t *s = di_edge_sub(sub);
+    uint64_t v;
+
+    if (!s)
+        return;
+
+    /* The eventfd is not closed: the producer may still hold the number,
+     * and a recycled descriptor would receive its writes. The next
+     * subscriber of this slot reuses it. */
+    __atomic_store_n(&s->state, SUB_CLAIMED, __ATOMIC_RELEASE);
+    while (read(s->fd, &v, sizeof(v)) > 0)
+        ;
+    __atomic_store_n(&s->state, SUB_FREE, __ATOMIC_RELEASE);
+}
+
+int di_edge_fd(int sub)
+{
+    DiEdgeSub_t *s = di_edge_sub(sub);
+    return s ? s->fd : -1;
+}
+
+int di_edge_next(int sub, DiEdge_t *e)
+{
+    DiEdgeSub_t *s = di_edge_sub(sub);
+
+    if (!s)
+        return -1;
+
+    for (;;) {
+        uint64_t head = __atomic_load_n(&g_head, __ATOMIC_ACQUIRE);
+        const DiEdgeSlot_t *slot;
+        DiEdge_t copy;
+        uint64_t seq;
+
+        if (s->tail == head)
+            return 0;
+
+        if (head - s->tail > DI_EDGE_RING_SIZE) {
+            s->lost += head - DI_EDGE_RING_SIZE - s->tail;
+            s->tail  = head - DI_EDGE_RING_SIZE;
+        }
+
+        slot = &g_ring[s->tail & DI_EDGE_MASK];
+        seq  = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq == s->tail + 1) {
+            memcpy(&copy, &slot->edge, sizeof(copy));
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq)
+                seq = 0;
+        }
+
+        s->tail++;
+
+        if (seq != s->tail) {
+            s->lost++;          /* Overwritten while we were behind */
+            continue;
+        }
+
+        if (di_edge_matches(s, &copy)) {
+            *e = copy;
+            return 1;
+        }
+    }
+}
+
+static int64_t di_edge_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int di_edge_wait(int sub, DiEdge_t *e, int timeout_ms)
+{
+    int64_t deadline = di_edge_now_ms() + timeout_ms;
+    int fd = di_edge_fd(sub);
+
+    if (fd < 0)
+        return -1;
+
+    for (;;) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN, .revents = 0 };
+        int wait_ms = timeout_ms;
+        uint64_t v;
+        int ret;
+
+        ret = di_edge_next(sub, e);
+        if (ret != 0)
+            return ret;
+
+        if (timeout_ms > 0) {
+            int64_t left = deadline - di_edge_now_ms();
+            if (left <= 0)
+                return 0;
+            wait_ms = (int)left;
+        } else if (timeout_ms == 0) {
+            return 0;
+        }
+
+        ret = poll(&pfd, 1, wait_ms);
+        if (ret < 0 && errno != EINTR)
+            return -1;
+        if (ret == 0)
+            return 0;
+
+        /* Clear the counter before looking, so a later edge re-arms it */
+        while (read(fd, &v, sizeof(v)) > 0)
+            ;
+    }
+}
+
+void di_edge_flush(int sub)
+{
+    DiEdgeSub_t *s = di_edge_sub(sub);
+    uint64_t v;
+
+    if (!s)
+        return;
+
+    while (read(s->fd, &v, sizeof(v)) > 0)
+        ;
+    s->tail = __atomic_load_n(&g_head, __ATOMIC_ACQUIRE);
+}
+
+uint64_t di_edge_lost(int sub)
+{
+    DiEdgeSub_t *s = di_edge_sub(sub);
+    return s ? s->lost : 0;
+}
@@ -0,0 +1,447 @@
+/**
+ * @file hal_core.c
+ * @brief Backend selection, dispatch, IO cycle counter and trace hooks.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal.h"
+#include "hal_trace.h"
+#include "time_source.h"
+
+/* -------------------------------------------------------------------------
+ * Backends
+ * ------------------------------------------------------------------------- */
+
+extern const HalBackend_t hal_revpi_backend;
+extern const HalBackend_t hal_mmap_backend;
+extern const HalBackend_t hal_sim_backend;
+extern const HalBackend_t hal_replay_backend;
+
+static const HalBackend_t *const g_backends[] = {
+    &hal_revpi_backend,
+    &hal_mmap_backend,
+    &hal_sim_backend,
+    &hal_replay_backend,
+};
+
+#define HAL_NUM_BACKENDS (sizeof(g_backends) / sizeof(g_backends[0]))
+
+static const HalBackend_t *g_selected = NULL;
+static const HalBackend_t *g_active   = NULL;
+
+static HalCycle_t g_cycle = { 0, 0 };
+
+/* -------------------------------------------------------------------------
+ * Locking
+ * ------------------------------------------------------------------------- */
+
+/*
+ * One recursive lock serializes every call into the backend: piControlIf
+ * seeks and reads on a shared fd, the sim image and the trace are plain
+ * memory. Priority inheritance keeps a SCHED_FIFO caller (safety.c) from
+ * waiting behind a preempted lower-priority holder for longer than one
+ * access.
+ */
+static pthread_mutex_t g_lock;
+static pthread_once_t  g_lock_once = PTHREAD_ONCE_INIT;
+
+static void hal_lock_init(void)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&g_lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+static void hal_lock(void)
+{
+    pthread_once(&g_lock_once, hal_lock_init);
+    pthread_mutex_lock(&g_lock);
+}
+
+static void hal_unlock(void)
+{
+    pthread_mutex_unlock(&g_lock);
+}
+
+/* -------------------------------------------------------------------------
+ * Forced-off range
+ * ------------------------------------------------------------------------- */
+
+#define HAL_FORCE_BUF_SIZE  PICONTROL_IMAGE_SIZE
+
+static uint32_t g_force_off = 0;
+static uint32_t g_force_len = 0;              /* 0 = nothing forced */
+static uint8_t  g_force_buf[HAL_FORCE_BUF_SIZE];
+
+static int hal_force_overlaps(uint32_t offset, uint32_t length)
+{
+    return g_force_len &&
+           offset < g_force_off + g_force_len &&
+           g_force_off < offset + length;
+}
+
+/**
+ * @brief Copy @p data to @p buf with the forced range zeroed.
+ */
+static const uint8_t *hal_force_mask(uint32_t offset, uint32_t length,
+                                     const uint8_t *data, uint8_t *buf)
+{
+    uint32_t lo = offset > g_force_off ? offset : g_force_off;
+    uint32_t hi = offset + length < g_force_off + g_force_len
+                ? offset + length : g_force_off + g_force_len;
+
+    memcpy(buf, data, length);
+    memset(buf + (lo - offset), 0, hi - lo);
+    return buf;
+}
+
+static const HalBackend_t *hal_find(const char *name)
+{
+    for (size_t i = 0; i < HAL_NUM_BACKENDS; i++) {
+        if (strcmp(g_backends[i]->name, name) == 0)
+            return g_backends[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Resolve the backend to open: HAL_BACKEND, hal_select(), default.
+ */
+static const HalBackend_t *hal_resolve(void)
+{
+    const char *env = getenv(HAL_BACKEND_ENV);
+    const HalBackend_t *b;
+
+    if (env && *env) {
+        b = hal_find(env);
+        if (b)
+            return b;
+        fprintf(stderr, "HAL: unknown backend '%s', using %s\n", env,
+                g_selected ? g_selected->name : HAL_BACKEND_DEFAULT);
+    }
+
+    return g_selected ? g_selected : hal_find(HAL_BACKEND_DEFAULT);
+}
+
+/**
+ * @brief Open the backend on first use.
+ */
+static const HalBackend_t *hal_backend(void)
+{
+    if (!g_active && hal_init() < 0)
+        return NULL;
+    return g_active;
+}
+
+/* -------------------------------------------------------------------------
+ * Selection
+ * ------------------------------------------------------------------------- */
+
+int hal_select(const char *name)
+{
+    const HalBackend_t *b = name ? hal_find(name) : NULL;
+
+    if (!b) {
+        fprintf(stderr, "HAL: unknown backend '%s'\n", name ? name : "(null)");
+        return -1;
+    }
+
+    g_selected = b;
+    return 0;
+}
+
+int hal_init(void)
+{
+    const HalBackend_t *b;
+    const char *trace;
+
+    hal_lock();
+    if (g_active) {
+        hal_unlock();
+        return 0;
+    }
+
+    b = hal_resolve();
+    if (b->open() < 0) {
+        hal_unlock();
+        return -1;
+    }
+
+    g_active = b;
+    g_cycle.count = 0;
+    g_cycle.t_us = 0;
+
+    trace = getenv(HAL_TRACE_ENV);
+    if (trace && *trace && !hal_trace_active())
+        hal_trace_start(trace);
+
+    hal_unlock();
+    return 0;
+}
+
+void hal_close(void)
+{
+    hal_lock();
+    hal_trace_stop();
+
+    if (g_active) {
+        g_active->close();
+        g_active = NULL;
+    }
+    hal_unlock();
+}
+
+const char *hal_backend_name(void)
+{
+    return g_active ? g_active->name : hal_resolve()->name;
+}
+
+/* -------------------------------------------------------------------------
+ * Access
+ * ------------------------------------------------------------------------- */
+
+/*
+ * Successful accesses are appended to the trace, if one is being recorded
+ * (hal_trace.h). Writes are recorded as issued to the backend (with any
+ * forced range already zeroed), reads as returned.
+ */
+
+int hal_read(uint32_t offset, uint32_t length, uint8_t *data)
+{
+    const HalBackend_t *b;
+    int ret;
+
+    hal_lock();
+    b = hal_backend();
+    ret = b ? b->read(offset, length, data) : -1;
+
+    if (ret >= 0 && hal_trace_active())
+        hal_trace_read(offset, length, data);
+    hal_unlock();
+    return ret;
+}
+
+int hal_write(uint32_t offset, uint32_t length, const uint8_t *data)
+{
+    const HalBackend_t *b;
+    int ret;
+
+    hal_lock();
+    b = hal_backend();
+
+    if (hal_force_overlaps(offset, length)) {
+        if (length > HAL_FORCE_BUF_SIZE) {
+            hal_unlock();
+            return -1;
+        }
+        data = hal_force_mask(offset, length, data, g_force_buf);
+    }
+
+    ret = b ? b->write(offset, length, data) : -1;
+
+    if (ret >= 0 && hal_trace_active())
+        hal_trace_write(offset, length, data);
+    hal_unlock();
+    return ret;
+}
+
+int hal_readv(const SPISegment *seg, int count)
+{
+    const HalBackend_t *b;
+    int ret;
+
+    hal_lock();
+    b = hal_backend();
+    ret = b ? b->readv(seg, count) : -1;
+
+    if (ret >= 0 && hal_trace_active()) {
+        for (int i = 0; i < count; i++)
+            hal_trace_read(seg[i].Offset, seg[i].Length, seg[i].pData);
+    }
+    hal_unlock();
+    return ret;
+}
+
+/**
+ * @brief Gather write with every segment that touches the forced range
+ *        redirected to a masked copy.
+ */
+static int hal_writev_forced(const HalBackend_t *b, const SPISegment *seg,
+                             int count)
+{
+    SPISegment masked[count];
+    uint32_t used = 0;
+    int ret;
+
+    for (int i = 0; i < count; i++) {
+        masked[i] = seg[i];
+        if (!hal_force_overlaps(seg[i].Offset, seg[i].Length))
+            continue;
+        if (seg[i].Length > HAL_FORCE_BUF_SIZE - used)
+            return -1;
+        hal_force_mask(seg[i].Offset, seg[i].Length, seg[i].pData,
+                       &g_force_buf[used]);
+        masked[i].pData = &g_force_buf[used];
+        used += seg[i].Length;
+    }
+
+    ret = b->writev(masked, count);
+
+    if (ret >= 0 && hal_trace_active()) {
+        for (int i = 0; i < count; i++)
+            hal_trace_write(masked[i].Offset, masked[i].Length, masked[i].pData);
+    }
+    return ret;
+}
+
+int hal_writev(const SPISegment *seg, int count)
+{
+    const HalBackend_t *b;
+    int ret;
+
+    hal_lock();
+    b = hal_backend();
+
+    if (b && g_force_len && count > 0) {
+        ret = hal_writev_forced(b, seg, count);
+        hal_unlock();
+        return ret;
+    }
+
+    ret = b ? b->writev(seg, count) : -1;
+
+    if (ret >= 0 && hal_trace_active()) {
+        for (int i = 0; i < count; i++)
+            hal_trace_write(seg[i].Offset, seg[i].Length, seg[i].pData);
+    }
+    hal_unlock();
+    return ret;
+}
+
+int hal_get_bit(uint32_t offset, uint8_t bit)
+{
+    const HalBackend_t *b;
+    int ret;
+
+    hal_lock();
+    b = hal_backend();
+    ret = b ? b->get_bit(offset, bit) : -1;
+
+    if (ret >= 0 && hal_trace_active())
+        hal_trace_get_bit(offset, bit, ret);
+    hal_unlock();
+    return ret;
+}
+
+int hal_set_bit(uint32_t offset, uint8_t bit, int value)
+{
+    const HalBackend_t *b;
+    int ret;
+
+    hal_lock();
+    b = hal_backend();
+
+    if (value && hal_force_overlaps(offset + bit / 8, 1))
+        value = 0;
+
+    ret = b ? b->set_bit(offset, bit, value) : -1;
+
+    if (ret >= 0 && hal_trace_active())
+        hal_trace_set_bit(offset, bit, value);
+    hal_unlock();
+    return ret;
+}
+
+/* -------------------------------------------------------------------------
+ * Forced-off outputs
+ * ------------------------------------------------------------------------- */
+
+int hal_force_off(uint32_t offset, uint32_t length)
+{
+    const HalBackend_t *b;
+    int ret;
+
+    if (length == 0 || length > HAL_FORCE_BUF_SIZE)
+        return -1;
+
+    hal_lock();
+    g_force_off = offset;
+    g_force_len = length;
+
+    b = hal_backend();
+    memset(g_force_buf, 0, length);
+    ret = b ? b->write(offset, length, g_force_buf) : -1;
+
+    if (ret >= 0 && hal_trace_active())
+        hal_trace_write(offset, length, g_force_buf);
+    hal_unlock();
+    return ret;
+}
+
+void hal_force_release(void)
+{
+    hal_lock();
+    g_force_len = 0;
+    hal_unlock();
+}
+
+int hal_forced(void)
+{
+    int forced;
+
+    hal_lock();
+    forced = g_force_len != 0;
+    hal_unlock();
+    return forced;
+}
+
+int hal_wait_event(void)
+{
+    const HalBackend_t *b;
+
+    /* Blocks in the driver, so it must not hold the lock */
+    hal_lock();
+    b = hal_backend();
+    hal_unlock();
+    return (b && b->wait_event) ? b->wait_event() : -1;
+}
+
+/* -------------------------------------------------------------------------
+ * IO cycle
+ * ------------------------------------------------------------------------- */
+
+void hal_cycle_begin(void)
+{
+    const HalBackend_t *b;
+
+    hal_lock();
+    b = hal_backend();
+
+    g_cycle.count++;
+    g_cycle.t_us = TimeSource_NowUs();
+
+    if (hal_trace_active())
+        hal_trace_cycle(g_cycle.t_us);
+
+    if (b && b->cycle)
+        b->cycle(g_cycle.count, g_cycle.t_us);
+    hal_unlock();
+}
+
+HalCycle_t hal_cycle(void)
+{
+    HalCycle_t c;
+
+    hal_lock();
+    c = g_cycle;
+    hal_unlock();
+    return c;
+}
@@ -0,0 +1,268 @@
+/**
+ * @file hal_replay.c
+ * @brief Replay backend: serves the process image from a recorded trace.
+ *
+ * Every backend call consumes the next record of its kind from the trace
+ * (hal_trace.h): reads return the recorded bytes, writes are compared with
+ * the recorded ones, and the cycle hook steps to the next CYCLE record.
+ * Running the same control code on the replayed inputs therefore repeats
+ * the recorded session access for access. Any record that has to be
+ * skipped, and any write that differs from the recording, is counted as a
+ * mismatch (see hal_replay_stats()).
+ *
+ * In virtual time (time_source.h) the clock is moved to each record's
+ * timestamp as it is consumed, so timeouts and tick intervals see the
+ * recorded timing without waiting for it.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "time_source.h"
+#include "hal_trace.h"
+#include "hal.h"
+
+static char             g_replay_path[256] = "";
+static double           g_replay_speed = 0.0;
+static HalTraceReader_t g_reader;
+static HalReplayStats_t g_stats;
+
+static uint64_t g_trace_t0  = 0;   /* Header timestamp */
+static uint64_t g_replay_t0 = 0;   /* TimeSource_NowUs() at open */
+
+void hal_replay_set_file(const char *path)
+{
+    snprintf(g_replay_path, sizeof(g_replay_path), "%s", path ? path : "");
+}
+
+void hal_replay_set_speed(double speed)
+{
+    g_replay_speed = speed > 0.0 ? speed : 0.0;
+}
+
+HalReplayStats_t hal_replay_stats(void)
+{
+    return g_stats;
+}
+
+/**
+ * @brief Follow the recorded timing for a consumed record.
+ */
+static void hal_replay_pace(const HalTraceRecord_t *rec)
+{
+    uint64_t rel = rec->t_us - g_trace_t0;
+
+    if (TimeSource_IsVirtual()) {
+        TimeSource_IdleUntilUs(g_replay_t0 + rel);
+        return;
+    }
+
+    if (rec->type == HAL_TRACE_CYCLE && g_replay_speed > 0.0) {
+        uint64_t due = g_replay_t0 + (uint64_t)((double)rel / g_replay_speed);
+        uint64_t now = TimeSource_NowUs();
+        if (due > now)
+            TimeSource_SleepUs(due - now);
+    }
+}
+
+/**
+ * @brief Consume records up to and including the next one of @p type.
+ *
+ * @return 1 with @p rec filled, or 0 at the end of the trace.
+ */
+static int hal_replay_next(HalTraceType_t type, HalTraceRecord_t *rec)
+{
+    int ret;
+
+    if (g_stats.done)
+        return 0;
+
+    while ((ret = hal_trace_reader_next(&g_reader, rec)) > 0) {
+        g_stats.records++;
+        hal_replay_pace(rec);
+
+        if (rec->type == HAL_TRACE_CYCLE)
+            g_stats.cycles++;
+        if (rec->type == type)
+            return 1;
+
+        g_stats.mismatches++;
+    }
+
+    if (ret < 0)
+        fprintf(stderr, "HAL replay: corrupt record after %llu records\n",
+                (unsigned long long)g_stats.records);
+
+    g_stats.done = 1;
+    return 0;
+}
+
+/**
+ * @brief Count a range access that does not match its record.
+ */
+static void hal_replay_check(const HalTraceRecord_t *rec, uint32_t offset,
+                             uint32_t length, const uint8_t *data)
+{
+    if (rec->offset == offset && rec->length == length &&
+        (!data || memcmp(rec->data, data, length) == 0))
+        return;
+
+    if (g_stats.mismatches++ == 0)
+        fprintf(stderr, "HAL replay: first mismatch at record %llu "
+                "(offset %u length %u, recorded %u/%u)\n",
+                (unsigned long long)g_stats.records, offset, length,
+                rec->offset, rec->length);
+}
+
+static int hal_replay_open(void)
+{
+    const char *path = getenv(HAL_REPLAY_ENV);
+    const char *speed = getenv(HAL_REPLAY_SPEED_ENV);
+
+    if (!path || !*path)
+        path = g_replay_path;
+    if (!*path) {
+        fprintf(stderr, "HAL replay: no trace (set %s)\n", HAL_REPLAY_ENV);
+        return -1;
+    }
+    if (speed && *speed)
+        hal_replay_set_speed(atof(speed));
+
+    if (hal_trace_reader_open(&g_reader, path) < 0)
+        return -1;
+
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_trace_t0  = g_reader.t_us;
+    g_replay_t0 = TimeSource_NowUs();
+    return 0;
+}
+
+static void hal_replay_close(void)
+{
+    hal_trace_reader_close(&g_reader);
+}
+
+static int hal_replay_read(uint32_t offset, uint32_t length, uint8_t *data)
+{
+    HalTraceRecord_t rec;
+
+    if (offset > sizeof(g_reader.image) ||
+        length > sizeof(g_reader.image) - offset)
+        return -1;
+
+    if (!hal_replay_next(HAL_TRACE_READ, &rec)) {
+        errno = ENODATA;
+        return -1;
+    }
+
+    hal_replay_check(&rec, offset, length, NULL);
+    memcpy(data, &g_reader.image[offset], length);
+    return (int)length;
+}
+
+static int hal_replay_write(uint32_t offset, uint32_t length, const uint8_t *data)
+{
+    HalTraceRecord_t rec;
+
+    if (!hal_replay_next(HAL_TRACE_WRITE, &rec)) {
+        errno = ENODATA;
+        return -1;
+    }
+
+    hal_replay_check(&rec, offset, length, data);
+    return (int)length;
+}
+
+static int hal_replay_readv(const SPISegment *seg, int count)
+{
+    int total = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (hal_replay_read(seg[i].Offset, seg[i].Length, seg[i].pData) < 0)
+            return -1;
+        total += (int)seg[i].Length;
+    }
+    return total;
+}
+
+static int hal_replay_writev(const SPISegment *seg, int count)
+{
+    int total = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (hal_replay_write(seg[i].Offset, seg[i].Length, seg[i].pData) < 0)
+            return -1;
+        total += (int)seg[i].Length;
+    }
+    return total;
+}
+
+static int hal_replay_get_bit(uint32_t offset, uint8_t bit)
+{
+    HalTraceRecord_t rec;
+
+    offset += bit / 8;
+    bit %= 8;
+    if (offset >= sizeof(g_reader.image))
+        return -1;
+
+    if (!hal_replay_next(HAL_TRACE_GET_BIT, &rec)) {
+        errno = ENODATA;
+        return -1;
+    }
+
+    if (rec.offset != offset || rec.bit != bit)
+        g_stats.mismatches++;
+
+    return (g_reader.image[offset] >> bit) & 1;
+}
+
+static int hal_replay_set_bit(uint32_t offset, uint8_t bit, int value)
+{
+    HalTraceRecord_t rec;
+
+    offset += bit / 8;
+    bit %= 8;
+
+    if (!hal_replay_next(HAL_TRACE_SET_BIT, &rec)) {
+        errno = ENODATA;
+        return -1;
+    }
+
+    if (rec.offset != offset || rec.bit != bit || rec.value != (value ? 1 : 0))
+        g_stats.mismatches++;
+
+    return 0;
+}
+
+static int hal_replay_wait_event(void)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+static void hal_replay_cycle(uint64_t count, uint64_t t_us)
+{
+    HalTraceRecord_t rec;
+
+    (void)count;
+    (void)t_us;
+
+    hal_replay_next(HAL_TRACE_CYCLE, &rec);
+}
+
+const HalBackend_t hal_replay_backend = {
+    .name       = "replay",
+    .open       = hal_replay_open,
+    .close      = hal_replay_close,
+    .read       = hal_replay_read,
+    .write      = hal_replay_write,
+    .readv      = hal_replay_readv,
+    .writev     = hal_replay_writev,
+    .get_bit    = hal_replay_get_bit,
+    .set_bit    = hal_replay_set_bit,
+    .wait_event = hal_replay_wait_event,
+    .cycle      = hal_replay_cycle,
+};
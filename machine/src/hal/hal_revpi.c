@@ -0,0 +1,93 @@
+/**
+ * @file hal_revpi.c
+ * @brief RevPi backends: piControl read/write syscalls and mmap.
+ *
+ * Both backends are thin wrappers around piControlIf. "mmap" only differs
+ * in forcing PICONTROL_BACKEND_MMAP before the device is opened; if the
+ * mapping fails piControlIf stays on read/write.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "piControl.h"
+#include "piControlIf.h"
+#include "hal.h"
+
+static int hal_revpi_open(void)
+{
+    return piControlOpen();
+}
+
+static int hal_mmap_open(void)
+{
+    piControlSetBackend(PICONTROL_BACKEND_MMAP);
+    return piControlOpen();
+}
+
+static void hal_revpi_close(void)
+{
+    piControlClose();
+}
+
+static int hal_revpi_read(uint32_t offset, uint32_t length, uint8_t *data)
+{
+    return piControlRead(offset, length, data);
+}
+
+static int hal_revpi_write(uint32_t offset, uint32_t length, const uint8_t *data)
+{
+    return piControlWrite(offset, length, (uint8_t *)data);
+}
+
+static int hal_revpi_get_bit(uint32_t offset, uint8_t bit)
+{
+    SPIValue val = { 0 };
+
+    val.i16uAddress = (uint16_t)offset;
+    val.i8uBit = bit;
+
+    if (piControlGetBitValue(&val) < 0)
+        return -1;
+
+    return val.i8uValue;
+}
+
+static int hal_revpi_set_bit(uint32_t offset, uint8_t bit, int value)
+{
+    SPIValue val = { 0 };
+
+    val.i16uAddress = (uint16_t)offset;
+    val.i8uBit = bit;
+    val.i8uValue = value ? 1 : 0;
+
+    return piControlSetBitValue(&val) < 0 ? -1 : 0;
+}
+
+const HalBackend_t hal_revpi_backend = {
+    .name       = "revpi",
+    .open       = hal_revpi_open,
+    .close      = hal_revpi_close,
+    .read       = hal_revpi_read,
+    .write      = hal_revpi_write,
+    .readv      = piControlReadV,
+    .writev     = piControlWriteV,
+    .get_bit    = hal_revpi_get_bit,
+    .set_bit    = hal_revpi_set_bit,
+    .wait_event = piControlWaitForEvent,
+    .cycle      = NULL,
+};
+
+const HalBackend_t hal_mmap_backend = {
+    .name       = "mmap",
+    .open       = hal_mmap_open,
+    .close      = hal_revpi_close,
+    .read       = hal_revpi_read,
+    .write      = hal_revpi_write,
+    .readv      = piControlReadV,
+    .writev     = piControlWriteV,
+    .get_bit    = hal_revpi_get_bit,
+    .set_bit    = hal_revpi_set_bit,
+    .wait_event = piControlWaitForEvent,
+    .cycle      = NULL,
+};
@@ -0,0 +1,150 @@
+/**
+ * @file hal_sim.c
+ * @brief Simulation backend: in-memory process image.
+ *
+ * The image starts zeroed except for the DI byte, which is preset so that
+ * the inverted proximity and ESTOP inputs read "not detected".
+ *
+ * By default the image is connected to the plant model in sim_plant.c:
+ * before every access the plant is advanced to the current time (real or
+ * virtual, see @ref time_source.h), so the
+ * relay outputs move the simulated axes and the tilt AI and home/ESTOP DIs
+ * follow them. HAL_SIM_PLANT=0 leaves a bare image whose inputs tests
+ * drive through hal_write()/hal_set_bit().
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "piControlIf.h"
+#include "mio_addr.h"
+#include "sim_plant.h"
+#include "time_source.h"
+#include "hal.h"
+
+#define SIM_IMAGE_SIZE  PICONTROL_IMAGE_SIZE
+
+static uint8_t g_sim_image[SIM_IMAGE_SIZE];
+static int     g_sim_plant = 1;
+
+/**
+ * @brief Bring the plant inputs up to date before an access.
+ */
+static void hal_sim_update(void)
+{
+    if (g_sim_plant)
+        sim_plant_step(TimeSource_NowUs(), g_sim_image);
+}
+
+static int hal_sim_in_image(uint32_t offset, uint32_t length)
+{
+    return offset <= SIM_IMAGE_SIZE && length <= SIM_IMAGE_SIZE - offset;
+}
+
+static int hal_sim_open(void)
+{
+    const char *env = getenv("HAL_SIM_PLANT");
+
+    g_sim_plant = !(env && strcmp(env, "0") == 0);
+    memset(g_sim_image, 0, sizeof(g_sim_image));
+
+    /* DI1–DI4 high: sensors and ESTOP inactive (inverted logic) */
+    g_sim_image[DI1_OFFSET] = (1 << DI1_BIT) | (1 << DI2_BIT) |
+                              (1 << DI3_BIT) | (1 << DI4_BIT);
+    return 0;
+}
+
+static void hal_sim_close(void)
+{
+}
+
+static int hal_sim_read(uint32_t offset, uint32_t length, uint8_t *data)
+{
+    if (!hal_sim_in_image(offset, length))
+        return -1;
+
+    hal_sim_update();
+    memcpy(data, &g_sim_image[offset], length);
+    return (int)length;
+}
+
+static int hal_sim_write(uint32_t offset, uint32_t length, const uint8_t *data)
+{
+    if (!hal_sim_in_image(offset, length))
+        return -1;
+
+    hal_sim_update();
+    memcpy(&g_sim_image[offset], data, length);
+    return (int)length;
+}
+
+static int hal_sim_readv(const SPISegment *seg, int count)
+{
+    int total = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (hal_sim_read(seg[i].Offset, seg[i].Length, seg[i].pData) < 0)
+            return -1;
+        total += (int)seg[i].Length;
+    }
+    return total;
+}
+
+static int hal_sim_writev(const SPISegment *seg, int count)
+{
+    int total = 0;
+
+    for (int i = 0; i < count; i++) {
+        if (hal_sim_write(seg[i].Offset, seg[i].Length, seg[i].pData) < 0)
+            return -1;
+        total += (int)seg[i].Length;
+    }
+    return total;
+}
+
+static int hal_sim_get_bit(uint32_t offset, uint8_t bit)
+{
+    offset += bit / 8;
+    if (offset >= SIM_IMAGE_SIZE)
+        return -1;
+
+    hal_sim_update();
+    return (g_sim_image[offset] >> (bit % 8)) & 1;
+}
+
+static int hal_sim_set_bit(uint32_t offset, uint8_t bit, int value)
+{
+    offset += bit / 8;
+    if (offset >= SIM_IMAGE_SIZE)
+        return -1;
+
+    hal_sim_update();
+    if (value)
+        g_sim_image[offset] |=  (uint8_t)(1u << (bit % 8));
+    else
+        g_sim_image[offset] &= (uint8_t)~(1u << (bit % 8));
+    return 0;
+}
+
+static int hal_sim_wait_event(void)
+{
+    /* No driver, so no reset events */
+    errno = ENOSYS;
+    return -1;
+}
+
+const HalBackend_t hal_sim_backend = {
+    .name       = "sim",
+    .open       = hal_sim_open,
+    .close      = hal_sim_close,
+    .read       = hal_sim_read,
+    .write      = hal_sim_write,
+    .readv      = hal_sim_readv,
+    .writev     = hal_sim_writev,
+    .get_bit    = hal_sim_get_bit,
+    .set_bit    = hal_sim_set_bit,
+    .wait_event = hal_sim_wait_event,
+    .cycle      = NULL,
+};
@@ -0,0 +1,445 @@
+/**
+ * @file hal_trace.c
+ * @brief Process-image trace recorder and reader (format in hal_trace.h).
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "piControlIf.h"
+#include "time_source.h"
+#include "hal_trace.h"
+
+#define TRACE_IMAGE_SIZE  PICONTROL_IMAGE_SIZE
+
+/* Worst case READ/WRITE record: header fields plus 3 bytes per 2 changed */
+#define TRACE_RECORD_MAX  (2 * TRACE_IMAGE_SIZE + 32)
+
+/* -------------------------------------------------------------------------
+ * Recorder state
+ * ------------------------------------------------------------------------- */
+
+static int      g_fd = -1;
+static uint8_t *g_map = NULL;        /* Current chunk */
+static uint64_t g_map_off = 0;       /* File offset of the current chunk */
+static uint64_t g_len = 0;           /* Bytes recorded, header included */
+static uint64_t g_last_us = 0;       /* Timestamp of the previous record */
+static int      g_atexit = 0;
+
+static uint8_t  g_known[TRACE_IMAGE_SIZE];   /* Image as last recorded */
+static uint8_t  g_record[TRACE_RECORD_MAX];
+
+/* -------------------------------------------------------------------------
+ * Varints
+ * ------------------------------------------------------------------------- */
+
+static size_t trace_put_varint(uint8_t *p, uint64_t v)
+{
+    size_t n = 0;
+
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+/**
+ * @return 0 on success, -1 if the varint runs past @p end.
+ */
+static int trace_get_varint(const uint8_t **p, const uint8_t *end, uint64_t *v)
+{
+    uint64_t x = 0;
+    unsigned shift = 0;
+
+    while (*p < end && shift < 64) {
+        uint8_t b = *(*p)++;
+        x |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *v = x;
+            return 0;
+        }
+        shift += 7;
+    }
+    return -1;
+}
+
+/* -------------------------------------------------------------------------
+ * Mapped append
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Map the chunk starting at @p off, growing the file to cover it.
+ */
+static int trace_map_chunk(uint64_t off)
+{
+    void *m;
+
+    if (ftruncate(g_fd, (off_t)(off + HAL_TRACE_CHUNK)) < 0)
+        return -1;
+
+    m = mmap(NULL, HAL_TRACE_CHUNK, PROT_READ | PROT_WRITE, MAP_SHARED,
+             g_fd, (off_t)off);
+    if (m == MAP_FAILED)
+        return -1;
+
+    g_map = m;
+    g_map_off = off;
+    return 0;
+}
+
+static void trace_append(const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        size_t pos = (size_t)(g_len - g_map_off);
+        size_t n = HAL_TRACE_CHUNK - pos;
+
+        if (n == 0) {
+            munmap(g_map, HAL_TRACE_CHUNK);
+            g_map = NULL;
+            if (trace_map_chunk(g_map_off + HAL_TRACE_CHUNK) < 0) {
+                perror("HAL trace");
+                hal_trace_stop();
+                return;
+            }
+            continue;
+        }
+
+        if (n > len) n = len;
+        memcpy(g_map + pos, data, n);
+        g_len += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/**
+ * @brief Start a record in g_record: type and time delta.
+ */
+static size_t trace_begin(HalTraceType_t type)
+{
+    uint64_t now = TimeSource_NowUs();
+    uint64_t dt = now > g_last_us ? now - g_last_us : 0;
+
+    g_last_us += dt;
+    g_record[0] = (uint8_t)type;
+    return 1 + trace_put_varint(&g_record[1], dt);
+}
+
+/* -------------------------------------------------------------------------
+ * Recorder
+ * ------------------------------------------------------------------------- */
+
+int hal_trace_start(const char *path)
+{
+    HalTraceHeader_t hdr;
+
+    if (g_fd >= 0)
+        hal_trace_stop();
+
+    g_fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (g_fd < 0) {
+        fprintf(stderr, "HAL trace: cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (trace_map_chunk(0) < 0) {
+        fprintf(stderr, "HAL trace: cannot map %s: %s\n", path, strerror(errno));
+        close(g_fd);
+        g_fd = -1;
+        return -1;
+    }
+
+    /* Trim the file on a normal exit without hal_close() */
+    if (!g_atexit) {
+        atexit(hal_trace_stop);
+        g_atexit = 1;
+    }
+
+    memset(g_known, 0, sizeof(g_known));
+    g_len = 0;
+    g_last_us = TimeSource_NowUs();
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic       = HAL_TRACE_MAGIC;
+    hdr.version     = HAL_TRACE_VERSION;
+    hdr.header_size = sizeof(hdr);
+    hdr.image_size  = TRACE_IMAGE_SIZE;
+    hdr.t0_us       = g_last_us;
+    trace_append((const uint8_t *)&hdr, sizeof(hdr));
+
+    return 0;
+}
+
+void hal_trace_stop(void)
+{
+    if (g_fd < 0)
+        return;
+
+    if (g_map) {
+        munmap(g_map, HAL_TRACE_CHUNK);
+        g_map = NULL;
+    }
+
+    if (ftruncate(g_fd, (off_t)g_len) < 0)
+        perror("HAL trace");
+
+    close(g_fd);
+    g_fd = -1;
+}
+
+int hal_trace_active(void)
+{
+    return g_fd >= 0;
+}
+
+uint64_t hal_trace_bytes(void)
+{
+    return g_len;
+}
+
+void hal_trace_cycle(uint64_t t_us)
+{
+    size_t n;
+
+    (void)t_us;   /* Same clock as the record timestamp */
+
+    if (g_fd < 0) return;
+
+    n = trace_begin(HAL_TRACE_CYCLE);
+    trace_append(g_record, n);
+}
+
+/**
+ * @brief Append a READ or WRITE record, delta-encoded against g_known.
+ */
+static void trace_range(HalTraceType_t type, uint32_t offset, uint32_t length,
+                        const uint8_t *data)
+{
+    uint8_t *known;
+    uint32_t p = 0;
+    size_t n;
+
+    if (g_fd < 0) return;
+    if (offset > TRACE_IMAGE_SIZE || length > TRACE_IMAGE_SIZE - offset)
+        return;
+
+    known = &g_known[offset];
+
+    n = trace_begin(type);
+    n += trace_put_varint(&g_record[n], offset);
+    n += trace_put_varint(&g_record[n], length);
+
+    for (;;) {
+        uint32_t skip = 0;
+        uint32_t run = 0;
+
+        while (p + skip < length && data[p + skip] == known[p + skip])
+            skip++;
+        n += trace_put_varint(&g_record[n], skip);
+        p += skip;
+        if (p == length)
+            break;
+
+        /* A single unchanged byte is cheaper to copy than to skip */
+        while (p + run < length &&
+               (data[p + run] != known[p + run] ||
+                (p + run + 1 < length && data[p + run + 1] != known[p + run + 1])))
+            run++;
+
+        n += trace_put_varint(&g_record[n], run);
+        memcpy(&g_record[n], &data[p], run);
+        memcpy(&known[p], &data[p], run);
+        n += run;
+        p += run;
+    }
+
+    trace_append(g_record, n);
+}
+
+void hal_trace_read(uint32_t offset, uint32_t length, const uint8_t *data)
+{
+    trace_range(HAL_TRACE_READ, offset, length, data);
+}
+
+void hal_trace_write(uint32_t offset, uint32_t length, const uint8_t *data)
+{
+    trace_range(HAL_TRACE_WRITE, offset, length, data);
+}
+
+static void trace_bit(HalTraceType_t type, uint32_t offset, uint8_t bit, int value)
+{
+    size_t n;
+
+    if (g_fd < 0) return;
+
+    offset += bit / 8;
+    bit %= 8;
+    if (offset >= TRACE_IMAGE_SIZE) return;
+
+    if (value)
+        g_known[offset] |=  (uint8_t)(1u << bit);
+    else
+        g_known[offset] &= (uint8_t)~(1u << bit);
+
+    n = trace_begin(type);
+    n += trace_put_varint(&g_record[n], offset);
+    g_record[n++] = (uint8_t)(bit | (value ? 1u << 3 : 0));
+    trace_append(g_record, n);
+}
+
+void hal_trace_get_bit(uint32_t offset, uint8_t bit, int value)
+{
+    trace_bit(HAL_TRACE_GET_BIT, offset, bit, value);
+}
+
+void hal_trace_set_bit(uint32_t offset, uint8_t bit, int value)
+{
+    trace_bit(HAL_TRACE_SET_BIT, offset, bit, value);
+}
+
+/* -------------------------------------------------------------------------
+ * Reader
+ * ------------------------------------------------------------------------- */
+
+int hal_trace_reader_open(HalTraceReader_t *r, const char *path)
+{
+    const HalTraceHeader_t *hdr;
+    struct stat st;
+    void *m;
+    int fd;
+
+    memset(r, 0, sizeof(*r));
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "HAL trace: cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(HalTraceHeader_t)) {
+        fprintf(stderr, "HAL trace: %s is not a trace\n", path);
+        close(fd);
+        return -1;
+    }
+
+    m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        fprintf(stderr, "HAL trace: cannot map %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    hdr = m;
+    if (hdr->magic != HAL_TRACE_MAGIC || hdr->version != HAL_TRACE_VERSION ||
+        hdr->header_size < sizeof(*hdr) || hdr->header_size > st.st_size ||
+        hdr->image_size != sizeof(r->image)) {
+        fprintf(stderr, "HAL trace: %s is not a version %d trace\n",
+                path, HAL_TRACE_VERSION);
+        munmap(m, (size_t)st.st_size);
+        return -1;
+    }
+
+    r->base = m;
+    r->size = (size_t)st.st_size;
+    r->pos  = hdr->header_size;
+    r->t_us = hdr->t0_us;
+    return 0;
+}
+
+void hal_trace_reader_close(HalTraceReader_t *r)
+{
+    if (r->base)
+        munmap((void *)r->base, r->size);
+    r->base = NULL;
+    r->size = 0;
+}
+
+int hal_trace_reader_next(HalTraceReader_t *r, HalTraceRecord_t *rec)
+{
+    const uint8_t *p, *end;
+    uint64_t dt, off, len;
+
+    if (!r->base || r->pos >= r->size || r->base[r->pos] == HAL_TRACE_END)
+        return 0;
+
+    p   = &r->base[r->pos];
+    end = r->base + r->size;
+
+    memset(rec, 0, sizeof(*rec));
+    rec->type = (HalTraceType_t)*p++;
+
+    if (trace_get_varint(&p, end, &dt) < 0)
+        return -1;
+    r->t_us += dt;
+    rec->t_us = r->t_us;
+
+    switch (rec->type) {
+    case HAL_TRACE_CYCLE:
+        break;
+
+    case HAL_TRACE_READ:
+    case HAL_TRACE_WRITE: {
+        uint64_t pos = 0;
+
+        if (trace_get_varint(&p, end, &off) < 0 ||
+            trace_get_varint(&p, end, &len) < 0 ||
+            off > sizeof(r->image) || len > sizeof(r->image) - off)
+            return -1;
+
+        for (;;) {
+            uint64_t skip, run;
+
+            if (trace_get_varint(&p, end, &skip) < 0 || skip > len - pos)
+                return -1;
+            pos += skip;
+            if (pos == len)
+                break;
+
+            if (trace_get_varint(&p, end, &run) < 0 || run > len - pos ||
+                run > (uint64_t)(end - p))
+                return -1;
+            memcpy(&r->image[off + pos], p, run);
+            p += run;
+            pos += run;
+        }
+
+        rec->offset = (uint32_t)off;
+        rec->length = (uint32_t)len;
+        rec->data   = &r->image[off];
+        break;
+    }
+
+    case HAL_TRACE_GET_BIT:
+    case HAL_TRACE_SET_BIT:
+        if (trace_get_varint(&p, end, &off) < 0 || off >= sizeof(r->image) ||
+            p >= end)
+            return -1;
+
+        rec->offset = (uint32_t)off;
+        rec->length = 1;
+        rec->bit    = *p & 0x07;
+        rec->value  = (*p >> 3) & 1;
+        rec->data   = &r->image[off];
+        p++;
+
+        if (rec->value)
+            r->image[off] |=  (uint8_t)(1u << rec->bit);
+        else
+            r->image[off] &= (uint8_t)~(1u << rec->bit);
+        break;
+
+    default:
+        return -1;
+    }
+
+    r->pos = (size_t)(p - r->base);
+    return 1;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file io_scan.c
+ * @brief Implementation of the process-image scan cycle.
+ *
+ * The snapshot covers one contiguous window of the process image, from the
+ * start of the MIO input region up to and including the RO output byte.
+ * A single hal_read() of this window replaces the individual DI, AI and RO
+ * reads issued by one Control_Tick().
+ *
+ * The window also contains every output the machine drives (DO byte, AO
+ * words, RO byte), so it doubles as the shadow output image. Each output
+ * region keeps a dirty span that io_scan_outputs() writes back in one call.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hal.h"
+#include "ai_filter.h"
+#include "di_edge.h"
+#include "mio_addr.h"
+#include "ro_addr.h"
+#include "io_scan.h"
+
+/* -------------------------------------------------------------------------
+ * Scan window
+ * ------------------------------------------------------------------------- */
+
+#define IO_SCAN_OFFSET  MIO_INPUT_OFFSET
+#define IO_SCAN_END     (RO1_OFFSET + 1)
+#define IO_SCAN_LENGTH  (IO_SCAN_END - IO_SCAN_OFFSET)
+
+static uint8_t g_image[IO_SCAN_LENGTH];
+static int     g_valid = 0;
+
+/* -------------------------------------------------------------------------
+ * Output regions
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief One output region of the shadow image with its dirty span.
+ */
+typedef struct
+{
+    uint32_t offset;     /**< First byte of the region */
+    uint32_t length;     /**< Region length in bytes */
+    uint32_t dirty_lo;   /**< First dirty byte (valid if dirty_hi > dirty_lo) */
+    uint32_t dirty_hi;   /**< One past the last dirty byte */
+} IoScanRegion_t;
+
+static IoScanRegion_t g_outputs[] = {
+    { RO1_OFFSET, 1,                             0, 0 },   /* RO1–RO4 */
+    { DO1_OFFSET, 1,                             0, 0 },   /* DO1–DO4 */
+    { AO1_OFFSET, AO8_OFFSET + 2 - AO1_OFFSET,   0, 0 },   /* AO1–AO8 */
+};
+
+#define IO_SCAN_NUM_OUTPUTS (sizeof(g_outputs) / sizeof(g_outputs[0]))
+
+/**
+ * @brief Check whether [offset, offset + length) lies inside the window.
+ */
+static int io_scan_in_window(uint32_t offset, uint32_t length)
+{
+    return offset >= IO_SCAN_OFFSET &&
+           length <= IO_SCAN_LENGTH &&
+           offset + length <= IO_SCAN_END;
+}
+
+/**
+ * @brief Find the output region fully containing a byte range.
+ *
+ * @return Region pointer, or NULL if the range is not a staged output.
+ */
+static IoScanRegion_t *io_scan_find_output(uint32_t offset, uint32_t length)
+{
+    for (size_t i = 0; i < IO_SCAN_NUM_OUTPUTS; i++) {
+        IoScanRegion_t *r = &g_outputs[i];
+        if (offset >= r->offset && offset + length <= r->offset + r->length)
+            return r;
+    }
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------
+ * Scan cycle
+ * ------------------------------------------------------------------------- */
+
+int io_scan_inputs(void)
+{
+    g_valid = 0;
+
+    for (size_t i = 0; i < IO_SCAN_NUM_OUTPUTS; i++) {
+        g_outputs[i].dirty_lo = 0;
+        g_outputs[i].dirty_hi = 0;
+    }
+
+    hal_cycle_begin();
+
+    if (hal_read(IO_SCAN_OFFSET, IO_SCAN_LENGTH, g_image) != IO_SCAN_LENGTH)
+        return -1;
+
+    di_edge_update(g_image[DI1_OFFSET - IO_SCAN_OFFSET], hal_cycle().t_us);
+    ai_filter_update(&g_image[AI1_OFFSET - IO_SCAN_OFFSET], hal_cycle().t_us);
+
+    g_valid = 1;
+    return 0;
+}
+
+int io_scan_outputs(void)
+{
+    SPISegment seg[IO_SCAN_NUM_OUTPUTS];
+    int count = 0;
+    int ret = 0;
+
+    if (!g_valid) return 0;
+
+    for (size_t i = 0; i < IO_SCAN_NUM_OUTPUTS; i++) {
+        IoScanRegion_t *r = &g_outputs[i];
+
+        if (r->dirty_hi <= r->dirty_lo) continue;
+
+        seg[count].Offset = r->dirty_lo;
+        seg[count].Length = r->dirty_hi - r->dirty_lo;
+        seg[count].pData  = &g_image[r->dirty_lo - IO_SCAN_OFFSET];
+        count++;
+
+        r->dirty_lo = 0;
+        r->dirty_hi = 0;
+    }
+
+    /* One pwrite per dirty region, no lseek */
+    if (count > 0 && hal_writev(seg, count) < 0)
+        ret = -1;
+
+    g_valid = 0;
+    return ret;
+}
+
+int io_scan_is_valid(void)
+{
+    return g_valid;
+}
+
+/* -------------------------------------------------------------------------
+ * Access
+ * ------------------------------------------------------------------------- */
+
+int io_scan_read(uint32_t offset, uint32_t length, uint8_t *data)
+{
+    if (g_valid && io_scan_in_window(offset, length)) {
+        memcpy(data, &g_image[offset - IO_SCAN_OFFSET], length);
+        return (int)length;
+    }
+
+    return hal_read(offset, length, data);
+}
+
+int io_scan_write(uint32_t offset, uint32_t length, const uint8_t *data)
+{
+    IoScanRegion_t *r;
+
+    if (!g_valid || !io_scan_in_window(offset, length))
+        return hal_write(offset, length, data);
+
+    r = io_scan_find_output(offset, length);
+    if (!r) {
+        int ret = hal_write(offset, length, data);
+        if (ret >= 0)
+            memcpy(&g_image[offset - IO_SCAN_OFFSET], data, length);
+        return ret;
+    }
+
+    /* Stage in the shadow image; flushed by io_scan_outputs() */
+    memcpy(&g_image[offset - IO_SCAN_OFFSET], data, length);
+
+    if (r->dirty_hi <= r->dirty_lo) {
+        r->dirty_lo = offset;
+        r->dirty_hi = offset + length;
+    } else {
+        if (offset < r->dirty_lo)          r->dirty_lo = offset;
+        if (offset + length > r->dirty_hi) r->dirty_hi = offset + length;
+    }
+
+    return (int)length;
+}
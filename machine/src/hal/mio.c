@@ -2,17 +2,20 @@
  * @file mio.c
  * @brief Implementation of the RevPi MIO Hardware Abstraction Layer (HAL).
  *
- * This module wraps piControl read/write operations into channel-based
+ * This module wraps process-image read/write operations into channel-based
  * functions for digital and analog I/O. All offsets and bit positions
  * are defined in @ref mio_addr.h.
+ *
+ * Process-image access goes through io_scan.c, so reads inside a scan
+ * cycle are served from the per-tick snapshot.
  */
 
 #include <stdio.h>
 #include <stdint.h>
 #include <unistd.h>
 
-#include "piControl.h"
-#include "piControlIf.h"
+#include "hal.h"
+#include "io_scan.h"
 #include "mio_addr.h"
 #include "mio.h"
 
@@ -21,11 +24,11 @@
  * ------------------------------------------------------------------------- */
 
 /**
- * @brief Initialize the MIO HAL by opening the piControl device.
+ * @brief Initialize the MIO HAL by opening the selected HAL backend.
  */
 int mio_init(void)
 {
-    return piControlOpen();
+    return hal_init();
 }
 
 /* -------------------------------------------------------------------------
@@ -40,10 +43,10 @@ int mio_get_di(int ch)
     uint8_t value = 0;
 
     switch (ch) {
-        case 1: return piControlRead(DI1_OFFSET, 1, &value) < 0 ? -1 : (value >> DI1_BIT) & 1;
-        case 2: return piControlRead(DI2_OFFSET, 1, &value) < 0 ? -1 : (value >> DI2_BIT) & 1;
-        case 3: return piControlRead(DI3_OFFSET, 1, &value) < 0 ? -1 : (value >> DI3_BIT) & 1;
-        case 4: return piControlRead(DI4_OFFSET, 1, &value) < 0 ? -1 : (value >> DI4_BIT) & 1;
+        case 1: return io_scan_read(DI1_OFFSET, 1, &value) < 0 ? -1 : (value >> DI1_BIT) & 1;
+        case 2: return io_scan_read(DI2_OFFSET, 1, &value) < 0 ? -1 : (value >> DI2_BIT) & 1;
+        case 3: return io_scan_read(DI3_OFFSET, 1, &value) < 0 ? -1 : (value >> DI3_BIT) & 1;
+        case 4: return io_scan_read(DI4_OFFSET, 1, &value) < 0 ? -1 : (value >> DI4_BIT) & 1;
     }
     return -1;
 }
@@ -60,10 +63,10 @@ int mio_get_do(int ch)
     uint8_t value = 0;
 
     switch (ch) {
-        case 1: return piControlRead(DO1_OFFSET, 1, &value) < 0 ? -1 : (value >> DO1_BIT) & 1;
-        case 2: return piControlRead(DO2_OFFSET, 1, &value) < 0 ? -1 : (value >> DO2_BIT) & 1;
-        case 3: return piControlRead(DO3_OFFSET, 1, &value) < 0 ? -1 : (value >> DO3_BIT) & 1;
-        case 4: return piControlRead(DO4_OFFSET, 1, &value) < 0 ? -1 : (value >> DO4_BIT) & 1;
+        case 1: return io_scan_read(DO1_OFFSET, 1, &value) < 0 ? -1 : (value >> DO1_BIT) & 1;
+        case 2: return io_scan_read(DO2_OFFSET, 1, &value) < 0 ? -1 : (value >> DO2_BIT) & 1;
+        case 3: return io_scan_read(DO3_OFFSET, 1, &value) < 0 ? -1 : (value >> DO3_BIT) & 1;
+        case 4: return io_scan_read(DO4_OFFSET, 1, &value) < 0 ? -1 : (value >> DO4_BIT) & 1;
     }
     return -1;
 }
@@ -94,28 +97,28 @@ int mio_set_do(int ch, int value)
 
     switch (ch) {
         case 1:
-            piControlRead(DO1_OFFSET, 1, &byte);          // read existing byte
+            io_scan_read(DO1_OFFSET, 1, &byte);          // read existing byte
             if (value) byte |=  (1 << DO1_BIT);           // set bit
             else       byte &= ~(1 << DO1_BIT);           // clear bit
-            return piControlWrite(DO1_OFFSET, 1, &byte);
+            return io_scan_write(DO1_OFFSET, 1, &byte);
 
         case 2:
-            piControlRead(DO2_OFFSET, 1, &byte);
+            io_scan_read(DO2_OFFSET, 1, &byte);
             if (value) byte |=  (1 << DO2_BIT);
             else       byte &= ~(1 << DO2_BIT);
-            return piControlWrite(DO2_OFFSET, 1, &byte);
+            return io_scan_write(DO2_OFFSET, 1, &byte);
 
         case 3:
-            piControlRead(DO3_OFFSET, 1, &byte);
+            io_scan_read(DO3_OFFSET, 1, &byte);
             if (value) byte |=  (1 << DO3_BIT);
             else       byte &= ~(1 << DO3_BIT);
-            return piControlWrite(DO3_OFFSET, 1, &byte);
+            return io_scan_write(DO3_OFFSET, 1, &byte);
 
         case 4:
-            piControlRead(DO4_OFFSET, 1, &byte);
+            io_scan_read(DO4_OFFSET, 1, &byte);
             if (value) byte |=  (1 << DO4_BIT);
             else       byte &= ~(1 << DO4_BIT);
-            return piControlWrite(DO4_OFFSET, 1, &byte);
+            return io_scan_write(DO4_OFFSET, 1, &byte);
     }
     return -1;
 }
@@ -132,14 +135,14 @@ int mio_get_ai(int ch)
     uint16_t value = 0;
 
     switch (ch) {
-        case 1: return piControlRead(AI1_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 2: return piControlRead(AI2_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 3: return piControlRead(AI3_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 4: return piControlRead(AI4_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 5: return piControlRead(AI5_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 6: return piControlRead(AI6_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 7: return piControlRead(AI7_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 8: return piControlRead(AI8_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 1: return io_scan_read(AI1_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 2: return io_scan_read(AI2_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 3: return io_scan_read(AI3_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 4: return io_scan_read(AI4_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 5: return io_scan_read(AI5_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 6: return io_scan_read(AI6_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 7: return io_scan_read(AI7_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 8: return io_scan_read(AI8_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
     }
     return -1;
 }
@@ -156,14 +159,14 @@ int mio_get_ao(int ch)
     uint16_t value = 0;
 
     switch (ch) {
-        case 1: return piControlRead(AO1_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 2: return piControlRead(AO2_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 3: return piControlRead(AO3_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 4: return piControlRead(AO4_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 5: return piControlRead(AO5_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 6: return piControlRead(AO6_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 7: return piControlRead(AO7_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
-        case 8: return piControlRead(AO8_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 1: return io_scan_read(AO1_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 2: return io_scan_read(AO2_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 3: return io_scan_read(AO3_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 4: return io_scan_read(AO4_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 5: return io_scan_read(AO5_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 6: return io_scan_read(AO6_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 7: return io_scan_read(AO7_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
+        case 8: return io_scan_read(AO8_OFFSET, 2, (uint8_t *)&value) < 0 ? -1 : value;
     }
     return -1;
 }
@@ -174,14 +177,14 @@ int mio_get_ao(int ch)
 int mio_set_ao(int ch, uint16_t value)
 {
     switch (ch) {
-        case 1: return piControlWrite(AO1_OFFSET, 2, (uint8_t *)&value);
-        case 2: return piControlWrite(AO2_OFFSET, 2, (uint8_t *)&value);
-        case 3: return piControlWrite(AO3_OFFSET, 2, (uint8_t *)&value);
-        case 4: return piControlWrite(AO4_OFFSET, 2, (uint8_t *)&value);
-        case 5: return piControlWrite(AO5_OFFSET, 2, (uint8_t *)&value);
-        case 6: return piControlWrite(AO6_OFFSET, 2, (uint8_t *)&value);
-        case 7: return piControlWrite(AO7_OFFSET, 2, (uint8_t *)&value);
-        case 8: return piControlWrite(AO8_OFFSET, 2, (uint8_t *)&value);
+        case 1: return io_scan_write(AO1_OFFSET, 2, (uint8_t *)&value);
+        case 2: return io_scan_write(AO2_OFFSET, 2, (uint8_t *)&value);
+        case 3: return io_scan_write(AO3_OFFSET, 2, (uint8_t *)&value);
+        case 4: return io_scan_write(AO4_OFFSET, 2, (uint8_t *)&value);
+        case 5: return io_scan_write(AO5_OFFSET, 2, (uint8_t *)&value);
+        case 6: return io_scan_write(AO6_OFFSET, 2, (uint8_t *)&value);
+        case 7: return io_scan_write(AO7_OFFSET, 2, (uint8_t *)&value);
+        case 8: return io_scan_write(AO8_OFFSET, 2, (uint8_t *)&value);
     }
     return -1;
 }
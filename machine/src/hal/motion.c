@@ -3,13 +3,15 @@
  * @brief Implementation of mid-level motion control functions.
  *
  * These functions provide semantic machine operations by wrapping
- * low-level HAL calls (mio_get_di, mio_get_ai, ro_set_ro).
+ * low-level HAL calls (mio_get_di, mio_get_ai, ro_set_mask).
  */
 
 #include "motion.h"
 #include "mio.h"
 #include "ro.h"
-#include <unistd.h>   // for usleep()
+#include "io_scan.h"
+#include "ai_filter.h"
+#include "time_source.h"
 
 /* -------------------------------------------------------------------------
  * Read Functions
@@ -46,7 +48,9 @@ int ReadTiltADC(void)
 /**
  * @brief Read the tilt position with filtering.
  *
- * Reads the ADC three times with 1 ms spacing and returns the integer average.
+ * Inside a scan cycle: the mean of the last AI_TILT_FILTER_N scan samples
+ * (ai_filter.h), no read or sleep. Otherwise reads the ADC three times with
+ * 1 ms spacing and returns the integer average.
  * The ADC range is 0–10000 corresponding to 0–10 V.
  *
  * NOTE:
@@ -54,20 +58,25 @@ int ReadTiltADC(void)
  *   - The linear actuator's valid signal range is 0.95–9.23 V
  *     (≈950–9230 counts). Values below ~950 counts are outside the
  *     actuator's meaningful range and should be treated as "0°" or invalid.
+ *   - Inside a scan cycle all three reads would return the same snapshot
+ *     value; the IO cycle already sampled the channel, so its ring is used.
  *
  * @return Filtered ADC value (0–10000) or -1 on error.
  */
 int ReadTiltPosition(void)
 {
+    if (io_scan_is_valid())
+        return ai_filter_mean(AI_TILT_POS, AI_TILT_FILTER_N);
+
     int a = ReadTiltADC();
     if (a < 0) return -1;
 
-    usleep(1000);  // 1 ms
+    TimeSource_SleepUs(1000);  // 1 ms
 
     int b = ReadTiltADC();
     if (b < 0) return -1;
 
-    usleep(1000);  // 1 ms
+    TimeSource_SleepUs(1000);  // 1 ms
 
     int c = ReadTiltADC();
     if (c < 0) return -1;
@@ -79,24 +88,29 @@ int ReadTiltPosition(void)
  * Relay Control
  * ------------------------------------------------------------------------- */
 
+/*
+ * Direction and enable share the RO byte, so both are written with one
+ * ro_set_mask() call and change in the same IO cycle.
+ */
+
 void RelayRotate(int cw, int on)
 {
+    uint8_t mask = RO_MASK(RO_ROTATE_DIR) | RO_MASK(RO_ROTATE_EN);
+
     if (on) {
-        ro_set_ro(RO_ROTATE_DIR, cw ? 1 : 0);
-        ro_set_ro(RO_ROTATE_EN, 1);
+        ro_set_mask(mask, (cw ? RO_MASK(RO_ROTATE_DIR) : 0) | RO_MASK(RO_ROTATE_EN));
     } else {
-        ro_set_ro(RO_ROTATE_EN, 0);
-        ro_set_ro(RO_ROTATE_DIR, 0);
+        ro_set_mask(mask, 0);
     }
 }
 
 void RelayTilt(int up, int on)
 {
+    uint8_t mask = RO_MASK(RO_TILT_DIR) | RO_MASK(RO_TILT_EN);
+
     if (on) {
-        ro_set_ro(RO_TILT_DIR, up ? 1 : 0);
-        ro_set_ro(RO_TILT_EN, 1);
+        ro_set_mask(mask, (up ? RO_MASK(RO_TILT_DIR) : 0) | RO_MASK(RO_TILT_EN));
     } else {
-        ro_set_ro(RO_TILT_EN, 0);
-        ro_set_ro(RO_TILT_DIR, 0);
+        ro_set_mask(mask, 0);
     }
 }
@@ -18,12 +18,14 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
 
 #include <inttypes.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 
@@ -37,6 +39,86 @@
 
 int PiControlHandle_g = -1;
 
+/* process image mapping, NULL while the syscall backend is active */
+uint8_t *PiControlImage_g = NULL;
+
+/* requested backend; -1 means "not set, consult PICONTROL_BACKEND_ENV" */
+static int PiControlBackendReq_g = -1;
+
+/******************************************************************************/
+/***************************  Internal Functions  *****************************/
+/******************************************************************************/
+
+/***********************************************************************************/
+/*!
+ * @brief Resolve the requested backend
+ *
+ * An explicit piControlSetBackend() wins over the environment variable.
+ *
+ ************************************************************************************/
+static EPiControlBackend piControlRequestedBackend(void)
+{
+	const char *env;
+
+	if (PiControlBackendReq_g >= 0)
+		return (EPiControlBackend)PiControlBackendReq_g;
+
+	env = getenv(PICONTROL_BACKEND_ENV);
+	if (env && strcmp(env, "mmap") == 0)
+		return PICONTROL_BACKEND_MMAP;
+
+	return PICONTROL_BACKEND_SYSCALL;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Map the process image
+ *
+ * On failure the syscall backend stays active.
+ *
+ ************************************************************************************/
+static void piControlMap(void)
+{
+	void *p;
+
+	if (PiControlImage_g || PiControlHandle_g < 0)
+		return;
+
+	p = mmap(NULL, PICONTROL_IMAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+		 PiControlHandle_g, 0);
+	if (p == MAP_FAILED) {
+		fprintf(stderr, "Failed to mmap " PICONTROL_DEVICE
+			", using read/write: %s\n", strerror(errno));
+		return;
+	}
+
+	PiControlImage_g = p;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Unmap the process image
+ *
+ ************************************************************************************/
+static void piControlUnmap(void)
+{
+	if (PiControlImage_g) {
+		munmap(PiControlImage_g, PICONTROL_IMAGE_SIZE);
+		PiControlImage_g = NULL;
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Check a range against the mapped process image
+ *
+ ************************************************************************************/
+static int piControlInImage(uint32_t Offset, uint32_t Length)
+{
+	return Offset <= PICONTROL_IMAGE_SIZE &&
+	       Length <= PICONTROL_IMAGE_SIZE - Offset;
+}
+
 /******************************************************************************/
 /*******************************  Functions  **********************************/
 /******************************************************************************/
@@ -58,6 +140,9 @@ int piControlOpen(void)
 				strerror(errno));
 			return -1;
 		}
+
+		if (piControlRequestedBackend() == PICONTROL_BACKEND_MMAP)
+			piControlMap();
 	}
 
 	return 0;
@@ -72,6 +157,8 @@ int piControlOpen(void)
  ************************************************************************************/
 void piControlClose(void)
 {
+	piControlUnmap();
+
 	/* open handle if needed */
 	if (PiControlHandle_g > 0) {
 		close(PiControlHandle_g);
@@ -79,6 +166,45 @@ void piControlClose(void)
 	}
 }
 
+/***********************************************************************************/
+/*!
+ * @brief Select the process image backend
+ *
+ * PICONTROL_BACKEND_MMAP serves piControlRead/piControlWrite and the bit
+ * helpers from a shared mapping of the process image, so they cost a
+ * memory access instead of a syscall. If the mapping cannot be created the
+ * syscall backend is used. May be called before or after piControlOpen().
+ *
+ * @param[in]   backend
+ *
+ * @return 0 if the requested backend is active, -1 if it fell back
+ *
+ ************************************************************************************/
+int piControlSetBackend(EPiControlBackend backend)
+{
+	PiControlBackendReq_g = backend;
+
+	if (PiControlHandle_g < 0)
+		return 0;
+
+	if (backend == PICONTROL_BACKEND_MMAP)
+		piControlMap();
+	else
+		piControlUnmap();
+
+	return piControlGetBackend() == backend ? 0 : -1;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Get the active process image backend
+ *
+ ************************************************************************************/
+EPiControlBackend piControlGetBackend(void)
+{
+	return PiControlImage_g ? PICONTROL_BACKEND_MMAP : PICONTROL_BACKEND_SYSCALL;
+}
+
 /***********************************************************************************/
 /*!
  * @brief Reset Pi Control Interface
@@ -148,6 +274,20 @@ int piControlRead(uint32_t Offset, uint32_t Length, uint8_t * pData)
 	if (ret < 0)
 		return ret;
 
+	if (PiControlImage_g) {
+		if (!piControlInImage(Offset, Length)) {
+			fprintf(stderr,
+				"Failed to read data at offset %" PRIu32
+				" with length %" PRIu32 ": out of range\n",
+				Offset, Length);
+			return -1;
+		}
+		/* see everything the driver published before this read */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		memcpy(pData, PiControlImage_g + Offset, Length);
+		return Length;
+	}
+
 	/* seek */
 	if (lseek(PiControlHandle_g, Offset, SEEK_SET) < 0) {
 		fprintf(stderr,
@@ -191,6 +331,20 @@ int piControlWrite(uint32_t Offset, uint32_t Length, uint8_t * pData)
 	if (ret < 0)
 		return ret;
 
+	if (PiControlImage_g) {
+		if (!piControlInImage(Offset, Length)) {
+			fprintf(stderr,
+				"Failed to write data at offset %" PRIu32
+				" with length %" PRIu32 ": out of range\n",
+				Offset, Length);
+			return -1;
+		}
+		memcpy(PiControlImage_g + Offset, pData, Length);
+		/* make the new outputs visible before the next I/O cycle */
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		return Length;
+	}
+
 	/* seek */
 	if (lseek(PiControlHandle_g, Offset, SEEK_SET) < 0) {
 		fprintf(stderr,
@@ -212,6 +366,193 @@ int piControlWrite(uint32_t Offset, uint32_t Length, uint8_t * pData)
 	return BytesWritten;
 }
 
+/***********************************************************************************/
+/*!
+ * @brief Sort segment indices by offset
+ *
+ * Insertion sort; batches are at most PICONTROL_MAX_SEGMENTS long.
+ *
+ ************************************************************************************/
+static void piControlSortSegments(const SPISegment *pSeg, int Count, int *pIdx)
+{
+	int i, j, k;
+
+	for (i = 0; i < Count; i++) {
+		k = i;
+		for (j = i; j > 0 && pSeg[pIdx[j - 1]].Offset > pSeg[k].Offset; j--)
+			pIdx[j] = pIdx[j - 1];
+		pIdx[j] = k;
+	}
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Transfer one batch of segments
+ *
+ * Segments are sorted and grouped into spans. Each span costs one pread or
+ * pwrite (no lseek), or a memcpy when the process image is mapped. Reads
+ * merge segments closer than PICONTROL_READV_GAP; writes merge only exactly
+ * adjacent segments so that bytes between them are never written.
+ *
+ ************************************************************************************/
+static int piControlTransferV(const SPISegment *pSeg, int Count, int Write)
+{
+	int idx[PICONTROL_MAX_SEGMENTS];
+	uint8_t buf[PICONTROL_IMAGE_SIZE];
+	uint32_t gap = Write ? 0 : PICONTROL_READV_GAP;
+	int total = 0;
+	int i, j, k;
+
+	piControlSortSegments(pSeg, Count, idx);
+
+	if (PiControlImage_g && !Write)
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	for (i = 0; i < Count; i = j) {
+		uint32_t start = pSeg[idx[i]].Offset;
+		uint32_t end = start + pSeg[idx[i]].Length;
+		uint8_t *span;
+		ssize_t n;
+
+		for (j = i + 1; j < Count; j++) {
+			const SPISegment *s = &pSeg[idx[j]];
+
+			if (s->Offset > end + gap)
+				break;
+			if (Write && s->Offset < end)
+				break;	/* overlapping writes stay separate, in offset order */
+			if (s->Offset + s->Length > end)
+				end = s->Offset + s->Length;
+		}
+
+		if (!piControlInImage(start, end - start)) {
+			fprintf(stderr,
+				"Failed to %s data at offset %" PRIu32
+				" with length %" PRIu32 ": out of range\n",
+				Write ? "write" : "read", start, end - start);
+			return -1;
+		}
+
+		span = PiControlImage_g ? PiControlImage_g + start : buf;
+
+		if (Write) {
+			for (k = i; k < j; k++) {
+				const SPISegment *s = &pSeg[idx[k]];
+				memcpy(span + (s->Offset - start), s->pData, s->Length);
+			}
+			if (!PiControlImage_g) {
+				n = pwrite(PiControlHandle_g, buf, end - start, start);
+				if (n != (ssize_t)(end - start)) {
+					fprintf(stderr,
+						"Failed to write data at offset %" PRIu32
+						" with length %" PRIu32 ": %s\n",
+						start, end - start,
+						n < 0 ? strerror(errno) : "short write");
+					return -1;
+				}
+			}
+		} else {
+			if (!PiControlImage_g) {
+				n = pread(PiControlHandle_g, buf, end - start, start);
+				if (n != (ssize_t)(end - start)) {
+					fprintf(stderr,
+						"Failed to read data at offset %" PRIu32
+						" with length %" PRIu32 ": %s\n",
+						start, end - start,
+						n < 0 ? strerror(errno) : "short read");
+					return -1;
+				}
+			}
+			for (k = i; k < j; k++) {
+				const SPISegment *s = &pSeg[idx[k]];
+				memcpy(s->pData, span + (s->Offset - start), s->Length);
+			}
+		}
+
+		for (k = i; k < j; k++)
+			total += pSeg[idx[k]].Length;
+	}
+
+	if (PiControlImage_g && Write)
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	return total;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Get Processdata from several positions
+ *
+ * Scatter read: fills every segment with the minimum number of kernel
+ * crossings (one pread per group of nearby segments, none with mmap).
+ *
+ * @param[in/out]   pSeg	array of segments
+ * @param[in]       Count	number of segments
+ *
+ * @return Total number of bytes read or error if negative
+ *
+ ************************************************************************************/
+int piControlReadV(const SPISegment *pSeg, int Count)
+{
+	int total = 0;
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	while (Count > 0) {
+		int n = Count > PICONTROL_MAX_SEGMENTS ? PICONTROL_MAX_SEGMENTS : Count;
+
+		ret = piControlTransferV(pSeg, n, 0);
+		if (ret < 0)
+			return ret;
+
+		total += ret;
+		pSeg += n;
+		Count -= n;
+	}
+
+	return total;
+}
+
+/***********************************************************************************/
+/*!
+ * @brief Set Processdata at several positions
+ *
+ * Gather write: adjacent segments are combined into one pwrite. Segments
+ * must not overlap unless their order does not matter.
+ *
+ * @param[in]   pSeg	array of segments
+ * @param[in]   Count	number of segments
+ *
+ * @return Total number of bytes written or error if negative
+ *
+ ************************************************************************************/
+int piControlWriteV(const SPISegment *pSeg, int Count)
+{
+	int total = 0;
+	int ret;
+
+	ret = piControlOpen();
+	if (ret < 0)
+		return ret;
+
+	while (Count > 0) {
+		int n = Count > PICONTROL_MAX_SEGMENTS ? PICONTROL_MAX_SEGMENTS : Count;
+
+		ret = piControlTransferV(pSeg, n, 1);
+		if (ret < 0)
+			return ret;
+
+		total += ret;
+		pSeg += n;
+		Count -= n;
+	}
+
+	return total;
+}
+
 /***********************************************************************************/
 /*!
  * @brief Get Device Info
@@ -290,6 +631,17 @@ int piControlGetBitValue(SPIValue * pSpiValue)
 	pSpiValue->i16uAddress += pSpiValue->i8uBit / 8;
 	pSpiValue->i8uBit %= 8;
 
+	if (PiControlImage_g) {
+		if (!piControlInImage(pSpiValue->i16uAddress, 1)) {
+			fprintf(stderr, "Failed to get bit value: out of range\n");
+			return -1;
+		}
+		pSpiValue->i8uValue =
+			(__atomic_load_n(PiControlImage_g + pSpiValue->i16uAddress,
+					 __ATOMIC_SEQ_CST) >> pSpiValue->i8uBit) & 1;
+		return 0;
+	}
+
 	if (ioctl(PiControlHandle_g, KB_GET_VALUE, pSpiValue) < 0) {
 		fprintf(stderr, "Failed to get bit value: %s\n", strerror(errno));
 		return -1;
@@ -320,6 +672,23 @@ int piControlSetBitValue(SPIValue * pSpiValue)
 	pSpiValue->i16uAddress += pSpiValue->i8uBit / 8;
 	pSpiValue->i8uBit %= 8;
 
+	if (PiControlImage_g) {
+		uint8_t *pByte;
+		uint8_t mask = 1 << pSpiValue->i8uBit;
+
+		if (!piControlInImage(pSpiValue->i16uAddress, 1)) {
+			fprintf(stderr, "Failed to set bit value: out of range\n");
+			return -1;
+		}
+		pByte = PiControlImage_g + pSpiValue->i16uAddress;
+		/* atomic so concurrent writers of neighbouring bits are preserved */
+		if (pSpiValue->i8uValue)
+			__atomic_fetch_or(pByte, mask, __ATOMIC_SEQ_CST);
+		else
+			__atomic_fetch_and(pByte, (uint8_t)~mask, __ATOMIC_SEQ_CST);
+		return 0;
+	}
+
 	if (ioctl(PiControlHandle_g, KB_SET_VALUE, pSpiValue) < 0) {
 		fprintf(stderr, "Failed to set bit value: %s\n", strerror(errno));
 		return -1;
@@ -1,20 +1,23 @@
 /**
  * @file ro.c
  * @brief Implementation of the RevPi RO Hardware Abstraction Layer (HAL).
+ *
+ * Process-image access goes through io_scan.c, so reads inside a scan
+ * cycle are served from the per-tick snapshot.
  */
 
 #include <stdio.h>
 #include <stdint.h>
 #include <unistd.h>
 
-#include "piControl.h"
-#include "piControlIf.h"
+#include "hal.h"
+#include "io_scan.h"
 #include "ro_addr.h"
 #include "ro.h"
 
 int ro_init(void)
 {
-    return piControlOpen();
+    return hal_init();
 }
 
 int ro_get_addr(int ch, int *offset, int *bit, int *len)
@@ -36,10 +39,10 @@ int ro_get_ro(int ch)
     uint8_t value = 0;
 
     switch (ch) {
-        case 1: return piControlRead(RO1_OFFSET, 1, &value) < 0 ? -1 : (value >> RO1_BIT) & 1;
-        case 2: return piControlRead(RO2_OFFSET, 1, &value) < 0 ? -1 : (value >> RO2_BIT) & 1;
-        case 3: return piControlRead(RO3_OFFSET, 1, &value) < 0 ? -1 : (value >> RO3_BIT) & 1;
-        case 4: return piControlRead(RO4_OFFSET, 1, &value) < 0 ? -1 : (value >> RO4_BIT) & 1;
+        case 1: return io_scan_read(RO1_OFFSET, 1, &value) < 0 ? -1 : (value >> RO1_BIT) & 1;
+        case 2: return io_scan_read(RO2_OFFSET, 1, &value) < 0 ? -1 : (value >> RO2_BIT) & 1;
+        case 3: return io_scan_read(RO3_OFFSET, 1, &value) < 0 ? -1 : (value >> RO3_BIT) & 1;
+        case 4: return io_scan_read(RO4_OFFSET, 1, &value) < 0 ? -1 : (value >> RO4_BIT) & 1;
     }
     return -1;
 }
@@ -71,37 +74,59 @@ int ro_set_ro(int ch, int value)
 
     switch (ch) {
         case 1:
-            piControlRead(RO1_OFFSET, 1, &byte);    // read existing byte
+            io_scan_read(RO1_OFFSET, 1, &byte);    // read existing byte
             if (value)
                 byte |=  (1 << RO1_BIT);            // set bit
             else
                 byte &= ~(1 << RO1_BIT);            // clear bit
-            return piControlWrite(RO1_OFFSET, 1, &byte);
+            return io_scan_write(RO1_OFFSET, 1, &byte);
 
         case 2:
-            piControlRead(RO2_OFFSET, 1, &byte);
+            io_scan_read(RO2_OFFSET, 1, &byte);
             if (value)
                 byte |=  (1 << RO2_BIT);
             else
                 byte &= ~(1 << RO2_BIT);
-            return piControlWrite(RO2_OFFSET, 1, &byte);
+            return io_scan_write(RO2_OFFSET, 1, &byte);
 
         case 3:
-            piControlRead(RO3_OFFSET, 1, &byte);
+            io_scan_read(RO3_OFFSET, 1, &byte);
             if (value)
                 byte |=  (1 << RO3_BIT);
             else
                 byte &= ~(1 << RO3_BIT);
-            return piControlWrite(RO3_OFFSET, 1, &byte);
+            return io_scan_write(RO3_OFFSET, 1, &byte);
 
         case 4:
-            piControlRead(RO4_OFFSET, 1, &byte);
+            io_scan_read(RO4_OFFSET, 1, &byte);
             if (value)
                 byte |=  (1 << RO4_BIT);
             else
                 byte &= ~(1 << RO4_BIT);
-            return piControlWrite(RO4_OFFSET, 1, &byte);
+            return io_scan_write(RO4_OFFSET, 1, &byte);
     }
     return -1;
 }
 
+
+int ro_set_mask(uint8_t mask, uint8_t value)
+{
+    uint8_t byte = 0;
+    int offset, bit, len;
+
+    if (io_scan_read(RO1_OFFSET, 1, &byte) < 0)
+        return -1;
+
+    for (int ch = 1; ch <= 4; ch++) {
+        if (!(mask & RO_MASK(ch)))
+            continue;
+
+        ro_get_addr(ch, &offset, &bit, &len);
+        if (value & RO_MASK(ch))
+            byte |=  (1 << bit);
+        else
+            byte &= ~(1 << bit);
+    }
+
+    return io_scan_write(RO1_OFFSET, 1, &byte) < 0 ? -1 : 0;
+}
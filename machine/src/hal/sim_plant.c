@@ -0,0 +1,234 @@
+/**
+ * @file sim_plant.c
+ * @brief Physics model of the T-axis actuator and R-axis motor.
+ *
+ * Velocities follow a first-order lag towards the commanded speed, which
+ * is integrated exactly over each step, so the result does not depend on
+ * how often the HAL is polled.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "mio_addr.h"
+#include "ro_addr.h"
+#include "motion.h"
+#include "sim_plant.h"
+
+/* -------------------------------------------------------------------------
+ * Channel mapping
+ * ------------------------------------------------------------------------- */
+
+static const uint8_t k_di_bit[5] = { 0, DI1_BIT, DI2_BIT, DI3_BIT, DI4_BIT };
+static const uint8_t k_ro_bit[5] = { 0, RO1_BIT, RO2_BIT, RO3_BIT, RO4_BIT };
+static const uint32_t k_ai_offset[9] = {
+    0, AI1_OFFSET, AI2_OFFSET, AI3_OFFSET, AI4_OFFSET,
+    AI5_OFFSET, AI6_OFFSET, AI7_OFFSET, AI8_OFFSET
+};
+
+#define SIM_RO(byte, ch)   (((byte) >> k_ro_bit[ch]) & 1)
+
+/* -------------------------------------------------------------------------
+ * State
+ * ------------------------------------------------------------------------- */
+
+static SimPlantConfig_t g_cfg;
+static SimPlantState_t  g_state;
+static uint64_t         g_last_us = 0;
+static uint32_t         g_rng = 0;
+static int              g_configured = 0;
+
+/* -------------------------------------------------------------------------
+ * Helpers
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Standard normal sample (xorshift32 + Box-Muller).
+ */
+static float sim_plant_gauss(void)
+{
+    float u1, u2;
+
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    u1 = ((g_rng >> 8) + 1.0f) / 16777217.0f;
+
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    u2 = (g_rng >> 8) / 16777216.0f;
+
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+/**
+ * @brief Integrate one axis over dt with a first-order velocity lag.
+ *
+ * @param x      Position (updated).
+ * @param v      Velocity (updated).
+ * @param target Commanded velocity.
+ * @param tau_s  Time constant in seconds (0 = instantaneous).
+ * @param dt     Step in seconds.
+ */
+static void sim_plant_axis(float *x, float *v, float target, float tau_s, float dt)
+{
+    if (tau_s <= 0.0f) {
+        *v = target;
+        *x += target * dt;
+        return;
+    }
+
+    float a = expf(-dt / tau_s);
+    *x += target * dt + (*v - target) * tau_s * (1.0f - a);
+    *v  = target + (*v - target) * a;
+}
+
+static void sim_plant_set_di(uint8_t *image, int ch, int raw)
+{
+    if (raw)
+        image[DI1_OFFSET] |=  (uint8_t)(1u << k_di_bit[ch]);
+    else
+        image[DI1_OFFSET] &= (uint8_t)~(1u << k_di_bit[ch]);
+}
+
+static void sim_plant_set_ai(uint8_t *image, int ch, int counts)
+{
+    uint32_t off = k_ai_offset[ch];
+
+    image[off]     = (uint8_t)(counts & 0xFF);
+    image[off + 1] = (uint8_t)((counts >> 8) & 0xFF);
+}
+
+/* -------------------------------------------------------------------------
+ * API
+ * ------------------------------------------------------------------------- */
+
+void sim_plant_default_config(SimPlantConfig_t *cfg)
+{
+    if (!cfg) return;
+
+    /* 75° over 0.29–8.55 V at 0.5 s/deg */
+    cfg->tilt_volts_per_sec = (8.55f - 0.29f) / 75.0f / 0.5f;
+    cfg->tilt_spinup_ms     = 100.0f;
+    cfg->tilt_coast_ms      = 400.0f;
+    cfg->tilt_min_volts     = 0.29f;
+    cfg->tilt_max_volts     = 8.55f;
+    cfg->tilt_home_volts    = 0.34f;
+    cfg->tilt_start_volts   = 2.0f;
+
+    cfg->adc_noise_counts   = 4.0f;
+    cfg->adc_floor_counts   = 25;
+
+    cfg->rotate_rpm         = 1.0f;
+    cfg->rotate_spinup_ms   = 200.0f;
+    cfg->rotate_coast_ms    = 300.0f;
+    cfg->rotate_home_deg    = 4.0f;
+    cfg->rotate_start_deg   = 90.0f;
+
+    cfg->seed               = 0;
+}
+
+void sim_plant_reset(const SimPlantConfig_t *cfg)
+{
+    if (cfg)
+        g_cfg = *cfg;
+    else
+        sim_plant_default_config(&g_cfg);
+
+    memset(&g_state, 0, sizeof(g_state));
+    g_state.tilt_volts = g_cfg.tilt_start_volts;
+    g_state.rotate_deg = g_cfg.rotate_start_deg;
+
+    g_rng = g_cfg.seed ? g_cfg.seed : 0x2545F491u;
+    g_last_us = 0;
+    g_configured = 1;
+}
+
+void sim_plant_step(uint64_t now_us, uint8_t *image)
+{
+    uint8_t ro;
+    float dt;
+    float target;
+    float tau;
+
+    if (!g_configured)
+        sim_plant_reset(NULL);
+
+    ro = image[RO1_OFFSET];
+    dt = (g_last_us && now_us > g_last_us) ? (now_us - g_last_us) / 1e6f : 0.0f;
+    g_last_us = now_us;
+
+    /* Tilt actuator: DIR set = out/up (pot voltage rising) */
+    if (SIM_RO(ro, RO_TILT_EN)) {
+        target = SIM_RO(ro, RO_TILT_DIR) ? g_cfg.tilt_volts_per_sec
+                                         : -g_cfg.tilt_volts_per_sec;
+        tau = g_cfg.tilt_spinup_ms / 1000.0f;
+    } else {
+        target = 0.0f;
+        tau = g_cfg.tilt_coast_ms / 1000.0f;
+    }
+    if (g_state.tilt_jammed)
+        g_state.tilt_velocity = 0.0f;
+    else
+        sim_plant_axis(&g_state.tilt_volts, &g_state.tilt_velocity, target, tau, dt);
+
+    if (g_state.tilt_volts < g_cfg.tilt_min_volts) {
+        g_state.tilt_volts = g_cfg.tilt_min_volts;
+        if (g_state.tilt_velocity < 0.0f) g_state.tilt_velocity = 0.0f;
+    }
+    if (g_state.tilt_volts > g_cfg.tilt_max_volts) {
+        g_state.tilt_volts = g_cfg.tilt_max_volts;
+        if (g_state.tilt_velocity > 0.0f) g_state.tilt_velocity = 0.0f;
+    }
+
+    /* Rotate motor: DIR set = CW (angle rising) */
+    if (SIM_RO(ro, RO_ROTATE_EN)) {
+        target = (SIM_RO(ro, RO_ROTATE_DIR) ? 6.0f : -6.0f) * g_cfg.rotate_rpm;
+        tau = g_cfg.rotate_spinup_ms / 1000.0f;
+    } else {
+        target = 0.0f;
+        tau = g_cfg.rotate_coast_ms / 1000.0f;
+    }
+    sim_plant_axis(&g_state.rotate_deg, &g_state.rotate_velocity, target, tau, dt);
+
+    /* Tilt pot -> ADC counts */
+    int counts = (int)lroundf(g_state.tilt_volts * 1000.0f +
+                              g_cfg.adc_noise_counts * sim_plant_gauss());
+    if (counts < g_cfg.adc_floor_counts) counts = 0;
+    if (counts > 10000) counts = 10000;
+    sim_plant_set_ai(image, AI_TILT_POS, counts);
+
+    /* Sensors, inverted: raw 0 = detected */
+    float w = fmodf(g_state.rotate_deg, 360.0f);
+    if (w < 0.0f) w += 360.0f;
+    int rotate_home = (w <= g_cfg.rotate_home_deg / 2.0f) ||
+                      (w >= 360.0f - g_cfg.rotate_home_deg / 2.0f);
+    int tilt_home = g_state.tilt_volts <= g_cfg.tilt_home_volts;
+
+    sim_plant_set_di(image, DI_PROXI_ROTATE, !rotate_home);
+    sim_plant_set_di(image, DI_PROXI_TILT,   !tilt_home);
+    sim_plant_set_di(image, DI_ESTOP,        !g_state.estop);
+}
+
+void sim_plant_set_estop(int pressed)
+{
+    if (!g_configured)
+        sim_plant_reset(NULL);
+
+    g_state.estop = pressed ? 1 : 0;
+}
+
+void sim_plant_set_tilt_jam(int jammed)
+{
+    if (!g_configured)
+        sim_plant_reset(NULL);
+
+    g_state.tilt_jammed = jammed ? 1 : 0;
+}
+
+SimPlantState_t sim_plant_state(void)
+{
+    return g_state;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file ai_filter.h
+ * @brief Analog input oversampling on top of the IO cycle.
+ *
+ * io_scan_inputs() hands the AI words of every scan snapshot to
+ * ai_filter_update(), which appends them to a per-channel ring of the last
+ * AI_FILTER_DEPTH samples, timestamped with the start of the IO cycle
+ * (hal_cycle()). Filtered values are then available at once, without
+ * extra reads or sleeps:
+ *
+ *   ai_filter_mean(ch, n)     moving average of the last n samples
+ *   ai_filter_median(ch, n)   median of the last n samples (spike-proof)
+ *   ai_filter_ema(ch)         exponential moving average, every sample
+ *
+ * Only samples within AI_FILTER_WINDOW_US of the newest one are used, so
+ * a filter never mixes in values from before a pause in the scan (e.g.
+ * between sparse Control_Tick() calls); with no recent history the
+ * filters return the newest sample. The EMA restarts from the new sample
+ * after such a gap.
+ *
+ * Control thread only (the thread running the IO cycle), like io_scan.h.
+ */
+
+#ifndef AI_FILTER_H
+#define AI_FILTER_H
+
+#include <stdint.h>
+
+#define AI_FILTER_CHANNELS   8          /**< AI1–AI8 */
+#define AI_FILTER_DEPTH      16         /**< Samples kept per channel */
+#define AI_FILTER_WINDOW_US  20000ULL   /**< Oldest sample used, relative to the newest */
+#define AI_FILTER_EMA_ALPHA  0.25f      /**< Default EMA weight of a new sample */
+
+/**
+ * @brief Feed the AI words of a new IO cycle (called by io_scan_inputs()).
+ *
+ * @param ai   AI1–AI8 as in the process image (8 x uint16, host order).
+ * @param t_us Cycle timestamp.
+ */
+void ai_filter_update(const uint8_t *ai, uint64_t t_us);
+
+/**
+ * @brief Drop all samples and EMA state (keeps the EMA weights).
+ */
+void ai_filter_reset(void);
+
+/**
+ * @brief Set the EMA weight of a new sample for channel @p ch (1–8).
+ *
+ * @param alpha 0 < alpha <= 1; 1 = no smoothing.
+ * @return 0 on success, -1 if @p ch or @p alpha is invalid.
+ */
+int ai_filter_set_ema_alpha(int ch, float alpha);
+
+/**
+ * @brief Number of samples of @p ch the filters would use (0 if none).
+ *
+ * @param n Upper bound (clamped to AI_FILTER_DEPTH).
+ */
+int ai_filter_count(int ch, int n);
+
+/**
+ * @brief Newest sample of @p ch.
+ *
+ * @return ADC counts, or -1 if no cycle has run yet or @p ch is invalid.
+ */
+int ai_filter_raw(int ch);
+
+/**
+ * @brief Mean of the last @p n samples of @p ch (rounded).
+ *
+ * @return ADC counts, or -1 if no cycle has run yet or @p ch is invalid.
+ */
+int ai_filter_mean(int ch, int n);
+
+/**
+ * @brief Median of the last @p n samples of @p ch.
+ *
+ * For an even count, the mean of the two middle samples (rounded down).
+ *
+ * @return ADC counts, or -1 if no cycle has run yet or @p ch is invalid.
+ */
+int ai_filter_median(int ch, int n);
+
+/**
+ * @brief Exponential moving average of @p ch (rounded).
+ *
+ * @return ADC counts, or -1 if no cycle has run yet or @p ch is invalid.
+ */
+int ai_filter_ema(int ch);
+
+#endif /* AI_FILTER_H */
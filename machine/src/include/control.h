@@ -7,6 +7,10 @@
  *   - Session configuration structure
  *   - Control entry points for initialization, homing, session execution,
  *     pause/resume, stop, calibration, and ESTOP handling.
+ *
+ * These functions run on the control thread. Other threads queue the
+ * session commands through control_cmd.h; Control_NotifyEStopActive() is
+ * the only one safe to call from anywhere.
  */
 
 /* TODO:
@@ -19,6 +23,12 @@
 
 #include <stdint.h>
 
+/** ESTOP supervision task period (1 kHz) */
+#define CONTROL_ESTOP_PERIOD_US   1000U
+
+/** Tilt and rotate service task period (10 Hz, the engines' control_time_ms) */
+#define CONTROL_AXIS_PERIOD_US    100000U
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -35,6 +45,35 @@ typedef enum {
     MACHINE_STATUS_FAULT        /**< Fault condition detected */
 } MachineStatus_t;
 
+/**
+ * @brief Control phase of the current home or session.
+ */
+typedef enum {
+    CONTROL_PHASE_IDLE = 0,       /**< No active session */
+    CONTROL_PHASE_HOME_TILT,      /**< Tilt homing in progress */
+    CONTROL_PHASE_HOME_ROTATE,    /**< Rotate homing in progress */
+    CONTROL_PHASE_TILT,           /**< Tilt axis is moving to target */
+    CONTROL_PHASE_ROTATE,         /**< Rotate axis is executing steps */
+    CONTROL_PHASE_DONE,           /**< Session completed */
+    CONTROL_PHASE_HOME_BOTH,      /**< Tilt and rotate homing together */
+    CONTROL_PHASE_BOTH,           /**< Tilt and rotate moving together */
+    CONTROL_PHASE_DWELL           /**< Program dwell step (control_program.h) */
+} ControlPhase_t;
+
+/**
+ * @brief Why the machine entered MACHINE_STATUS_FAULT.
+ */
+typedef enum {
+    CONTROL_FAULT_NONE = 0,       /**< No fault since Control_Init() */
+    CONTROL_FAULT_STATE,          /**< Command not valid in the current status */
+    CONTROL_FAULT_SESSION,        /**< Invalid session configuration */
+    CONTROL_FAULT_CALIBRATION,    /**< Calibration missing or failed */
+    CONTROL_FAULT_NOT_HOMED,      /**< An axis is not at home */
+    CONTROL_FAULT_TILT,           /**< Tilt engine error or timeout */
+    CONTROL_FAULT_ROTATE,         /**< Rotate engine error or timeout */
+    CONTROL_FAULT_STOPPED         /**< Session stopped by Control_StopSession() */
+} ControlFault_t;
+
 /**
  * @brief Rotation direction for the rotate axis.
  */
@@ -54,18 +93,55 @@ typedef struct {
     int tilt_degree;              /**< Target tilt angle in degrees */
     RotateDirection_t rotate_dir; /**< Rotation direction */
     int rotate_num;               /**< Number of rotation steps (treated as degrees in test mode) */
+    int overlap;                  /**< 1 = tilt and rotate may move together (see ControlInterlock_t) */
 } SessionConfig_t;
 
+/** Interlock bits: axis combinations allowed to move at the same time */
+#define CONTROL_OVERLAP_NONE     0x0u
+#define CONTROL_OVERLAP_HOME     0x1u   /**< Home tilt and rotate together */
+#define CONTROL_OVERLAP_SESSION  0x2u   /**< Session tilt and rotate together */
+
+/**
+ * @brief Which axis motions may overlap.
+ *
+ * The default allows nothing: homing and sessions run tilt, then rotate.
+ * A session overlaps only if it sets overlap, CONTROL_OVERLAP_SESSION is
+ * allowed and both the current and the target tilt are at or below
+ * max_tilt_degree (e.g. where the load clears the frame while rotating);
+ * otherwise it runs serially. Homing overlaps only if CONTROL_OVERLAP_HOME
+ * is allowed and the current tilt is at or below max_tilt_degree; from
+ * higher up it homes tilt first, then rotate.
+ */
+typedef struct {
+    unsigned allow;               /**< CONTROL_OVERLAP_* bits */
+    float    max_tilt_degree;     /**< Highest tilt at which rotate may overlap */
+} ControlInterlock_t;
+
 /**
  * @brief Initialize the control state machine.
+ *
+ * Clears the ESTOP latch. If the safety thread (safety.h) tripped, its
+ * relay force is released through Safety_Reset(); while ESTOP is still
+ * pressed that fails, and the latch and the force both stay.
  */
 void Control_Init(void);
 
+/**
+ * @brief Set the axis overlap policy (control thread, between sessions).
+ */
+void Control_SetInterlock(const ControlInterlock_t *interlock);
+
+/**
+ * @brief Current axis overlap policy.
+ */
+void Control_GetInterlock(ControlInterlock_t *interlock);
+
 /**
  * @brief Periodic tick function (non-blocking orchestrator).
  *
  * Handles:
  *   - ESTOP monitoring
+ *   - Commands queued with ControlCmd_Submit() (control_cmd.h)
  *   - Non-blocking homing (tilt + rotate)
  *   - Non-blocking tilt motion
  *   - Non-blocking rotate motion
@@ -73,6 +149,25 @@ void Control_Init(void);
  */
 void Control_Tick(void);
 
+/**
+ * @brief Register the control tasks with the executive (executive.h).
+ *
+ * Multi-rate alternative to calling Control_Tick() every loop:
+ *   - "estop"   every CONTROL_ESTOP_PERIOD_US, priority 0
+ *   - "command" every CONTROL_ESTOP_PERIOD_US, priority 1 (control_cmd.h;
+ *               also ends program dwells and fine tilt pulses)
+ *   - "tilt"    every CONTROL_AXIS_PERIOD_US, priority 10 (also services
+ *               both axes while they move together)
+ *   - "rotate"  every CONTROL_AXIS_PERIOD_US, priority 11
+ *   - "publish" every CONTROL_ESTOP_PERIOD_US, priority 12 (control_status.h)
+ *
+ * The axis tasks only do work while their axis owns the current phase.
+ * Call after Exec_Init(); then drive the machine with Exec_Tick().
+ *
+ * @return 0 on success, -1 if the executive task table is full.
+ */
+int Control_RegisterTasks(void);
+
 /**
  * @brief Validate calibration for both axes.
  *
@@ -155,8 +250,16 @@ int Control_StopSession(void);
  */
 MachineStatus_t Control_GetStatus(void);
 
+/**
+ * @brief Reason for the last FAULT (CONTROL_FAULT_NONE after Control_Init()).
+ */
+ControlFault_t Control_GetFault(void);
+
 /**
  * @brief Notify the control system that ESTOP is active.
+ *
+ * Latches ESTOP until Control_Init(). Thread-safe: the safety thread
+ * (safety.h) calls it directly when it trips.
  */
 void Control_NotifyEStopActive(void);
 
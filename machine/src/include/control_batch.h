@@ -0,0 +1,117 @@
+/**
+ * @file control_batch.h
+ * @brief Batch of sessions, reordered to minimise tilt travel.
+ *
+ * Run one at a time, every session pays the tilt travel from wherever the
+ * previous one ended (and a home in between). A batch runs N sessions as
+ * one session program (control_program.h), homed once, in an order chosen
+ * to minimise motion time:
+ *
+ *   ControlBatch_DefaultModel(&model);                 speeds from calibration
+ *   ControlBatch_Plan(entries, n, ControlTilt_ReadDegree(), &model, &plan);
+ *   ControlBatch_Build(entries, &plan, &prog);         tilt + rotate per session
+ *   Control_StartProgram(&prog);                       or CONTROL_CMD_PROGRAM
+ *   ...
+ *   ControlBatch_PrintReport(&plan, Control_GetProgramMs());
+ *
+ * Motion time is modelled per move: |delta tilt| * sec_per_degree for
+ * tilt, degrees / (rpm * 6) for rotate, plus a fixed start/settle overhead
+ * for every move. Rotate time does not depend on the order, so only tilt
+ * travel is optimised. Pinned entries keep their submitted position; the
+ * others are reordered within the runs between pinned entries. Tilt
+ * positions lie on a line, so the best order of a run is one of two
+ * sweeps (down first or up first, then on to the next pinned entry).
+ * That makes the plan exact for the model.
+ *
+ * Planning only reads the calibration, so any thread can plan and build;
+ * only the start belongs to the control thread.
+ */
+
+#ifndef CONTROL_BATCH_H
+#define CONTROL_BATCH_H
+
+#include <stdint.h>
+#include "control.h"
+#include "control_program.h"
+
+#define CONTROL_BATCH_MAX              64     /**< Sessions per batch (2 program steps each) */
+#define CONTROL_BATCH_MOVE_OVERHEAD_S  0.3f   /**< Default per-move start/settle time */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief One session of a batch.
+ */
+typedef struct {
+    SessionConfig_t session;    /**< overlap is ignored: programs run serially */
+    int             pinned;     /**< 1 = keep at its submitted position */
+} ControlBatchEntry_t;
+
+/**
+ * @brief Motion time model.
+ */
+typedef struct {
+    float tilt_sec_per_degree;
+    float rotate_deg_per_sec;
+    float move_overhead_s;      /**< Added per tilt or rotate move */
+} ControlBatchModel_t;
+
+/**
+ * @brief Planned order and its predicted makespan.
+ */
+typedef struct {
+    int   count;
+    int   order[CONTROL_BATCH_MAX];   /**< Entry indexes, in run order */
+    float predicted_s;                /**< Model time of the planned order */
+    float submitted_s;                /**< Model time of the submitted order */
+} ControlBatchPlan_t;
+
+/**
+ * @brief Fill the model from the current calibration.
+ *
+ * move_overhead_s is CONTROL_BATCH_MOVE_OVERHEAD_S.
+ */
+void ControlBatch_DefaultModel(ControlBatchModel_t *model);
+
+/**
+ * @brief Model time of running the entries in a given order.
+ *
+ * @param start_degree Tilt position before the first session.
+ * @return Seconds.
+ */
+float ControlBatch_Predict(const ControlBatchEntry_t *entries, const int *order, int n,
+                           float start_degree, const ControlBatchModel_t *model);
+
+/**
+ * @brief Choose the order with the least model time.
+ *
+ * The submitted order is kept where reordering gains nothing.
+ *
+ * @param start_degree Tilt position before the first session.
+ * @return 0 on success, -1 if n is out of range or an entry is invalid.
+ */
+int ControlBatch_Plan(const ControlBatchEntry_t *entries, int n, float start_degree,
+                      const ControlBatchModel_t *model, ControlBatchPlan_t *plan);
+
+/**
+ * @brief Build the session program for a plan.
+ *
+ * @return Number of program steps (> 0), or -1 on error.
+ */
+int ControlBatch_Build(const ControlBatchEntry_t *entries, const ControlBatchPlan_t *plan,
+                       ControlProgram_t *program);
+
+/**
+ * @brief Print submitted, predicted and (if > 0) actual makespan.
+ *
+ * @param actual_ms Control_GetProgramMs() of the finished batch, or 0.
+ */
+void ControlBatch_PrintReport(const ControlBatchPlan_t *plan, uint64_t actual_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_BATCH_H */
@@ -0,0 +1,113 @@
+/**
+ * @file control_cmd.h
+ * @brief Lock-free command queue from API threads into the control loop.
+ *
+ * Control_StartSession(), Control_PauseSession() and friends touch the
+ * state machine directly and must only be called from the control thread.
+ * Other threads (gRPC handlers, CLI) submit the same operations as
+ * ControlCmd_t records instead:
+ *
+ *   uint64_t seq = ControlCmd_Submit(&cmd);   any thread, never blocks
+ *   ...
+ *   ControlCmd_Wait(seq, 1000, &result);      result of Control_*()
+ *
+ * The control loop drains the queue at one point of every tick, after the
+ * ESTOP check and before the phase is serviced (Control_Tick(), or the
+ * "command" executive task), at most CONTROL_CMD_MAX_PER_TICK commands per
+ * tick, in submission order.
+ *
+ * The queue is a bounded multi-producer / single-consumer ring. Producers
+ * claim a slot with one compare-and-swap on the tail; the consumer never
+ * waits for anything, so the tick stays wait-free however many clients
+ * submit. Each command gets a sequence number (1, 2, ...) and, once run,
+ * its result is kept in a completion table of the same size until the
+ * sequence number is reused CONTROL_CMD_QUEUE_SIZE commands later.
+ */
+
+#ifndef CONTROL_CMD_H
+#define CONTROL_CMD_H
+
+#include <stdint.h>
+#include "control.h"
+#include "control_program.h"
+
+#define CONTROL_CMD_QUEUE_SIZE    64   /**< Power of two */
+#define CONTROL_CMD_MAX_PER_TICK  4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Operations that can be submitted.
+ */
+typedef enum {
+    CONTROL_CMD_HOME = 1,       /**< Control_BeginHome() */
+    CONTROL_CMD_START,          /**< Control_StartSession(&session) */
+    CONTROL_CMD_PAUSE,          /**< Control_PauseSession() */
+    CONTROL_CMD_RESUME,         /**< Control_ResumeSession() */
+    CONTROL_CMD_STOP,           /**< Control_StopSession() */
+    CONTROL_CMD_PROGRAM         /**< Control_StartProgram(program) */
+} ControlCmdType_t;
+
+/**
+ * @brief One queued command.
+ */
+typedef struct {
+    ControlCmdType_t        type;
+    SessionConfig_t         session;   /**< CONTROL_CMD_START only */
+    const ControlProgram_t *program;   /**< CONTROL_CMD_PROGRAM only; copied when
+                                            the command runs, keep it until then */
+} ControlCmd_t;
+
+/**
+ * @brief Queue a command (any thread, lock-free).
+ *
+ * @return Sequence number (> 0), or 0 if the queue is full.
+ */
+uint64_t ControlCmd_Submit(const ControlCmd_t *cmd);
+
+/**
+ * @brief Check whether command @p seq has run.
+ *
+ * @param result Set to the Control_*() return value when done.
+ * @return 1 done, 0 still queued, -1 unknown or result already recycled.
+ */
+int ControlCmd_Poll(uint64_t seq, int *result);
+
+/**
+ * @brief Wait for command @p seq to run.
+ *
+ * Polls every millisecond; for API threads, not the control thread.
+ *
+ * @return 1 done, 0 timed out, -1 unknown or result already recycled.
+ */
+int ControlCmd_Wait(uint64_t seq, uint32_t timeout_ms, int *result);
+
+/**
+ * @brief Take the oldest queued command (control thread only).
+ *
+ * @return 1 if a command was taken, 0 if the queue is empty.
+ */
+int ControlCmd_Next(ControlCmd_t *cmd, uint64_t *seq);
+
+/**
+ * @brief Record the result of a command taken with ControlCmd_Next().
+ */
+void ControlCmd_Complete(uint64_t seq, int result);
+
+/**
+ * @brief Sequence number of the last completed command (0 = none).
+ */
+uint64_t ControlCmd_LastCompleted(void);
+
+/**
+ * @brief Number of commands rejected because the queue was full.
+ */
+uint64_t ControlCmd_Dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_CMD_H */
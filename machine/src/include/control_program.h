@@ -0,0 +1,127 @@
+/**
+ * @file control_program.h
+ * @brief Multi-step session programs: format, validation and compilation.
+ *
+ * A SessionConfig_t is one tilt target and one rotate amount. A program is
+ * an ordered list of steps, with loops:
+ *
+ *   tilt 20                 move tilt to 20 degrees
+ *   repeat 3                run the block 3 times
+ *     rotate cw 90          rotate 90 degrees clockwise
+ *     dwell 500             hold for 500 ms
+ *   end
+ *   tilt 0
+ *
+ * The same program can be given as text (ControlProgram_Parse(); steps
+ * separated by newlines or ';', '#' starts a comment) or as an array of
+ * ProgramStep_t (ControlProgram_Compile()). Either way it is validated
+ * once and compiled into a flat ControlProgram_t: loops unrolled, no-op
+ * steps (rotate 0, dwell 0) dropped.
+ *
+ * Control_StartProgram() copies the compiled program and Control_Tick()
+ * runs it step after step. A step's successor is checked against the
+ * calibration when the step starts, and begun in the same tick the step
+ * ends, so there is no command round trip or idle tick between steps.
+ * API threads queue it with CONTROL_CMD_PROGRAM (control_cmd.h).
+ */
+
+#ifndef CONTROL_PROGRAM_H
+#define CONTROL_PROGRAM_H
+
+#include <stdint.h>
+#include "control.h"
+
+#define CONTROL_PROGRAM_MAX_STEPS     256      /**< Compiled steps (loops unrolled) */
+#define CONTROL_PROGRAM_MAX_SOURCE    128      /**< Source steps, incl. repeat / end */
+#define CONTROL_PROGRAM_MAX_DEPTH     4        /**< Nested repeat blocks */
+#define CONTROL_PROGRAM_MAX_REPEAT    1000
+#define CONTROL_PROGRAM_MAX_DWELL_MS  600000   /**< 10 minutes */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Step operations.
+ */
+typedef enum {
+    PROGRAM_OP_TILT = 1,    /**< value = target degree (0-90) */
+    PROGRAM_OP_ROTATE,      /**< value = degrees (>= 0), dir */
+    PROGRAM_OP_DWELL,       /**< value = milliseconds */
+    PROGRAM_OP_REPEAT,      /**< value = count; source only, opens a block */
+    PROGRAM_OP_END          /**< Source only, closes the innermost block */
+} ProgramOp_t;
+
+/**
+ * @brief One program step.
+ */
+typedef struct {
+    ProgramOp_t       op;
+    int               value;
+    RotateDirection_t dir;  /**< PROGRAM_OP_ROTATE only */
+} ProgramStep_t;
+
+/**
+ * @brief Compiled program: TILT / ROTATE / DWELL steps only.
+ */
+typedef struct {
+    int           count;
+    ProgramStep_t steps[CONTROL_PROGRAM_MAX_STEPS];
+} ControlProgram_t;
+
+/**
+ * @brief Validate and compile a source step array.
+ *
+ * @param src Source steps (may contain REPEAT / END).
+ * @param n   Number of source steps.
+ * @param out Compiled program.
+ * @return Number of compiled steps (> 0), or -1 if the program is invalid
+ *         (the reason and step index are printed to stderr).
+ */
+int ControlProgram_Compile(const ProgramStep_t *src, int n, ControlProgram_t *out);
+
+/**
+ * @brief Parse and compile a program in text form.
+ *
+ * Thread-safe; API threads parse before queueing CONTROL_CMD_PROGRAM.
+ *
+ * @return Number of compiled steps (> 0), or -1 on a syntax error (printed
+ *         to stderr with its line number) or as ControlProgram_Compile().
+ */
+int ControlProgram_Parse(const char *text, ControlProgram_t *out);
+
+/**
+ * @brief Start a compiled program (control thread, non-blocking).
+ *
+ * Same preconditions as Control_StartSession(): READY or DONE, calibrated
+ * and homed. The program is copied; the caller's copy may be reused as
+ * soon as this returns. Steps run serially (no axis overlap). Pause,
+ * resume and stop work as for a session; resume restarts the current
+ * step (the rest of a dwell).
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int Control_StartProgram(const ControlProgram_t *program);
+
+/**
+ * @brief Progress of the running (or last) program.
+ *
+ * @param total Set to the number of compiled steps, may be NULL.
+ * @return 1-based index of the current step, 0 if no program has run
+ *         since the last session or home.
+ */
+int Control_GetProgramStep(int *total);
+
+/**
+ * @brief Time taken by the running (or last) program, pauses included.
+ *
+ * @return Milliseconds from Control_StartProgram() to now while it runs,
+ *         to its end (done, fault, ESTOP or stop) after that; 0 if none.
+ */
+uint64_t Control_GetProgramMs(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_PROGRAM_H */
@@ -15,6 +15,7 @@
 #define CONTROL_ROTATE_H
 
 #include "control.h"
+#include "control_tick.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -49,6 +50,13 @@ typedef struct
  */
 void ControlRotate_ApplyCalibration(const RotateCalibration_t *cfg);
 
+/**
+ * @brief Calibrated rotate speed.
+ *
+ * @return Degrees per second (rpm * 6).
+ */
+float ControlRotate_DegPerSec(void);
+
 /**
  * @brief Check whether the rotation axis is at the HOME position.
  *
@@ -80,9 +88,17 @@ RotateResult_t ControlRotate_BeginHome(void);
  */
 RotateResult_t ControlRotate_ServiceHome(void);
 
+/**
+ * @brief ControlRotate_ServiceHome() with the context of the current tick.
+ */
+RotateResult_t ControlRotate_ServiceHomeTick(const ControlTick_t *tick);
+
 /**
  * @brief Home the rotation axis.
  *
+ * Blocking. Sleeps until each control tick is due (or the home sensor
+ * fires) instead of spinning.
+ *
  * @return 0 on success, non-zero on failure.
  */
 int ControlRotate_Home(void);
@@ -166,6 +182,11 @@ RotateResult_t ControlRotate_RotateMoveToDegree(RotateDirection_t dir,
  */
 RotateResult_t ControlRotate_Service(void);
 
+/**
+ * @brief ControlRotate_Service() with the context of the current tick.
+ */
+RotateResult_t ControlRotate_ServiceTick(const ControlTick_t *tick);
+
 /**
  * @brief Read the current rotation count.
  *
@@ -174,6 +195,11 @@ RotateResult_t ControlRotate_Service(void);
  */
 int ControlRotate_ReadPosition(int *count_out);
 
+/**
+ * @brief Read the estimated rotation position in degrees (unrounded).
+ */
+float ControlRotate_ReadDegree(void);
+
 /**
  * @brief Read the elapsed motion time in milliseconds.
  *
@@ -0,0 +1,118 @@
+/**
+ * @file control_status.h
+ * @brief Seqlock-published machine status snapshot.
+ *
+ * The control loop publishes a ControlStatus_t once per tick (the end of
+ * Control_Tick(), or the "publish" executive task every 1 ms). Readers
+ * (gRPC status stream, CLI tools) copy it with ControlStatus_Read() from
+ * any thread, or from another process through POSIX shared memory:
+ *
+ *   control process:  ControlStatus_Share("/machine_status")
+ *                     (main does this when CONTROL_STATUS_SHM is set)
+ *   reader process:   blk = ControlStatus_Attach("/machine_status");
+ *                     ControlStatus_ReadBlock(blk, &st);
+ *
+ * The block is a seqlock: the writer bumps the sequence to odd, copies the
+ * struct, bumps it to even. It never waits for readers, so a reader can
+ * never stall the tick. A reader copies the struct and retries if the
+ * sequence was odd or changed during the copy; with one publish per
+ * millisecond a retry is rare and the copy takes well under a
+ * microsecond.
+ */
+
+#ifndef CONTROL_STATUS_H
+#define CONTROL_STATUS_H
+
+#include <stdint.h>
+#include "control.h"
+
+#define CONTROL_STATUS_SHM_ENV   "CONTROL_STATUS_SHM"
+#define CONTROL_STATUS_MAGIC     0x53544154u   /* "STAT" */
+#define CONTROL_STATUS_VERSION   3u
+#define CONTROL_STATUS_RETRIES   1000          /**< Reader attempts before giving up */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Everything a status reader needs, as of one tick.
+ */
+typedef struct {
+    uint64_t        publish_count;   /**< Publishes since start, 0 = never */
+    uint64_t        t_us;            /**< TimeSource_NowUs() at publish */
+    MachineStatus_t status;
+    ControlPhase_t  phase;
+    ControlFault_t  fault;           /**< Reason for the last FAULT */
+    int             estop_latched;
+    int             outputs_forced;  /**< Relays held off by the safety thread */
+    float           tilt_volts;      /**< -1 if the read failed */
+    float           tilt_degree;
+    float           rotate_degree;   /**< Estimated, since home */
+    SessionConfig_t session;         /**< Current or last session */
+    uint64_t        last_cmd;        /**< Last completed ControlCmd sequence */
+    int             program_step;    /**< 1-based program step, 0 = no program */
+    int             program_steps;   /**< Compiled steps of that program */
+    uint64_t        program_ms;      /**< Time taken by that program so far */
+} ControlStatus_t;
+
+/**
+ * @brief Shared block layout (also the layout of the shm object).
+ */
+typedef struct {
+    uint32_t        magic;
+    uint32_t        version;
+    uint32_t        size;            /**< sizeof(ControlStatusBlock_t) */
+    uint32_t        seq;             /**< Odd while the writer is copying */
+    ControlStatus_t status;
+} ControlStatusBlock_t;
+
+/**
+ * @brief Publish a snapshot (control thread only, never blocks).
+ */
+void ControlStatus_Publish(const ControlStatus_t *st);
+
+/**
+ * @brief Copy the latest snapshot (any thread, in this process).
+ *
+ * @return 0 on success, -1 if no consistent copy was obtained after
+ *         CONTROL_STATUS_RETRIES attempts.
+ */
+int ControlStatus_Read(ControlStatus_t *out);
+
+/**
+ * @brief Move publishing into a POSIX shared memory object.
+ *
+ * Creates (or reuses) @p name (e.g. "/machine_status"), copies the current
+ * snapshot into it and publishes there from now on. ControlStatus_Read()
+ * follows.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int ControlStatus_Share(const char *name);
+
+/**
+ * @brief Map a shared status object read-only (reader process).
+ *
+ * @return Block pointer, or NULL if it does not exist or does not match
+ *         this build's magic/version/size.
+ */
+const ControlStatusBlock_t *ControlStatus_Attach(const char *name);
+
+/**
+ * @brief Unmap a block returned by ControlStatus_Attach().
+ */
+void ControlStatus_Detach(const ControlStatusBlock_t *blk);
+
+/**
+ * @brief Copy the snapshot from a block (local or attached).
+ *
+ * @return 0 on success, -1 as for ControlStatus_Read().
+ */
+int ControlStatus_ReadBlock(const ControlStatusBlock_t *blk, ControlStatus_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_STATUS_H */
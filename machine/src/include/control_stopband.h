@@ -0,0 +1,101 @@
+/**
+ * @file control_stopband.h
+ * @brief Learned tilt stop-band corrections.
+ *
+ * The tilt engine drops the relay stop_band_out / stop_band_in volts
+ * before the target (control_tilt.h). The real coast varies with load,
+ * direction and travel (a short move never reaches full speed), so the
+ * engine measures where each move settled and feeds the error back here:
+ *
+ *   error  = settled - target, along the direction of travel (V)
+ *   offset += CONTROL_STOPBAND_GAIN * error
+ *   band   = calibrated band + offset, clamped to [0, CONTROL_STOPBAND_MAX_V]
+ *
+ * There is one offset per direction and travel bin (CONTROL_STOPBAND_BINS,
+ * split at 0.5 V and 2.0 V). Offsets are bounded by
+ * CONTROL_STOPBAND_MAX_OFFSET_V; errors larger than that are taken as a
+ * disturbance and ignored.
+ *
+ * The offsets can be saved to and loaded from a small JSON file; main does
+ * this at start and exit when CONTROL_STOPBAND_FILE is set.
+ *
+ * Control thread only.
+ */
+
+#ifndef CONTROL_STOPBAND_H
+#define CONTROL_STOPBAND_H
+
+#define CONTROL_STOPBAND_FILE_ENV     "CONTROL_STOPBAND_FILE"
+#define CONTROL_STOPBAND_BINS         3       /**< Travel bins per direction */
+#define CONTROL_STOPBAND_GAIN         0.5f    /**< Share of an error corrected per move */
+#define CONTROL_STOPBAND_MAX_V        1.0f    /**< Largest band (V) */
+#define CONTROL_STOPBAND_MAX_OFFSET_V 0.5f    /**< Largest learned offset (V) */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Travel bin of a move.
+ *
+ * @param travel_volts Distance from start to target (V, sign ignored).
+ * @return 0 .. CONTROL_STOPBAND_BINS - 1.
+ */
+int ControlStopBand_Bin(float travel_volts);
+
+/**
+ * @brief Stop band to use for a move.
+ *
+ * @param up           1 when pulling OUT, 0 when pulling IN.
+ * @param travel_volts Distance from start to target (V).
+ * @param base_volts   Calibrated band for this direction.
+ * @return @p base_volts plus the learned offset, clamped.
+ */
+float ControlStopBand_Get(int up, float travel_volts, float base_volts);
+
+/**
+ * @brief Feed back where a move settled.
+ *
+ * @param up           Direction of the move.
+ * @param travel_volts Distance from start to target (V).
+ * @param error_volts  Settled minus target along the direction of travel
+ *                     (> 0 = overshoot).
+ * @return 0 if learned, -1 if the error was rejected as a disturbance.
+ */
+int ControlStopBand_Learn(int up, float travel_volts, float error_volts);
+
+/**
+ * @brief Learned offset and number of moves for one bin.
+ *
+ * @param moves Optional output for the moves learned from.
+ * @return Offset (V), 0 for an invalid bin.
+ */
+float ControlStopBand_Offset(int up, int bin, unsigned *moves);
+
+/**
+ * @brief Forget everything learned.
+ */
+void ControlStopBand_Reset(void);
+
+/**
+ * @brief Write the offsets to @p path as JSON.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int ControlStopBand_Save(const char *path);
+
+/**
+ * @brief Read offsets written by ControlStopBand_Save().
+ *
+ * Missing keys keep their current value; out-of-range offsets are clamped.
+ *
+ * @return 0 on success, -1 if the file cannot be read or has no
+ *         "tilt_stop_band" object.
+ */
+int ControlStopBand_Load(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_STOPBAND_H */
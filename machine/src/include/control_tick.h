@@ -0,0 +1,86 @@
+/**
+ * @file control_tick.h
+ * @brief Per-tick context for the axis engines.
+ *
+ * Control_Tick() (and each control task of the executive) fills one
+ * ControlTick_t right after the IO scan and hands it to the engine
+ * services:
+ *
+ *   io_scan_inputs()                      input snapshot
+ *   ControlTick_Begin(&tick, n)           one timestamp, tick index
+ *   ControlTilt_ServiceTick(&tick, ...)   ControlRotate_ServiceTick(&tick) ...
+ *   ControlTick_End(&tick)
+ *   io_scan_outputs()                     output staging, flushed once
+ *
+ * Every engine call of the tick sees the same timestamp, and the tilt
+ * position is read (and, outside a scan, filtered) at most once: the
+ * first ControlTick_TiltAdc() reads it, later calls return the same
+ * sample. While a tick is open, ControlTick_Now() returns it, so the
+ * Begin*() helpers and ControlTilt_ReadVolt() use the same clock and
+ * sample without a parameter.
+ *
+ * The plain ControlTilt_Service() / ControlRotate_Service() calls (and
+ * the home services) build a one-call context of their own, so blocking
+ * helpers and tests keep working unchanged.
+ *
+ * Control thread only.
+ */
+
+#ifndef CONTROL_TICK_H
+#define CONTROL_TICK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Context of one control tick.
+ */
+typedef struct
+{
+    uint64_t count;       /**< Tick index (Control_Tick() or executive base tick) */
+    uint64_t t_us;        /**< Timestamp of the tick's IO scan */
+    int      paced;       /**< 1 = the executive sets the rate, skip ShouldTick() timers */
+    int      tilt_adc;    /**< Tilt position of this tick, -1 on read error */
+    int      tilt_read;   /**< tilt_adc has been read */
+} ControlTick_t;
+
+/**
+ * @brief Fill a context and make it the current one.
+ *
+ * The timestamp is the executive tick inside a task, the scan cycle
+ * (hal_cycle()) inside an IO scan, TimeSource_NowUs() otherwise.
+ *
+ * @param count Tick index.
+ */
+void ControlTick_Begin(ControlTick_t *tick, uint64_t count);
+
+/**
+ * @brief Close the current context (no-op if @p tick is not current).
+ */
+void ControlTick_End(ControlTick_t *tick);
+
+/**
+ * @brief The open context, or NULL outside a tick.
+ */
+ControlTick_t *ControlTick_Now(void);
+
+/**
+ * @brief Timestamp of the tick in milliseconds.
+ */
+uint64_t ControlTick_Ms(const ControlTick_t *tick);
+
+/**
+ * @brief Tilt position (ADC counts) of the tick, read on first use.
+ *
+ * @return ReadTiltPosition() of this tick, or -1 on error.
+ */
+int ControlTick_TiltAdc(ControlTick_t *tick);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONTROL_TICK_H */
@@ -8,16 +8,23 @@
  *   - Non-blocking motion engine (Begin/Service)
  *   - Pause/stop-aware motion
  *   - Stop-band compensation (in/out, in volts)
+ *   - Predictive stop from an alpha-beta position/velocity estimate
+ *   - Stop bands learned from the settled position of each move
+ *   - Fine positioning with timed relay pulses
+ *   - Velocity-based stall detection with a captured sample window
  */
 
 /* TODO:
- * - Add homing timeout and jam detection configuration.
+ * - Make the stall-detection ratios and windows configurable.
  * - Expose calibration persistence helpers.
  */
 
 #ifndef CONTROL_TILT_H
 #define CONTROL_TILT_H
 
+#include <stdint.h>
+#include "control_tick.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -30,19 +37,50 @@ extern "C" {
  *
  * stop_band_out:
  *      Compensation (volts) when pulling OUT.
+ *
+ * stop_predict:
+ *      0 = release the relay when the position crosses the target offset
+ *      by the stop band (default). 1 = release it when the predicted
+ *      coast-down (estimated velocity x coast_ms) lands closest to the
+ *      target; the stop bands are then unused.
+ *
+ * sec_per_degree:
+ *      Travel time of the actuator (s per degree, 0.5 if unset). With the
+ *      volt/degree span it gives the expected speed that the stall
+ *      detector trips against (half of it while running, a fifth at
+ *      start-up), so a value that is too low causes false stall trips.
+ *      It also sizes the move and homing timeouts and the batch planner's
+ *      tilt model (control_batch.h).
+ *
+ * learn_stop_band:
+ *      1 = measure where each band-mode move settled and correct the stop
+ *      band per direction and travel distance (control_stopband.h).
+ *
+ * fine_window, fine_tolerance, fine_volts_per_ms:
+ *      Final approach. Once the move has settled with an error below
+ *      fine_window but above fine_tolerance, the engine drives short
+ *      relay pulses of error / (volts per ms) until inside fine_tolerance.
+ *      The volts per ms are learned per direction from each pulse.
+ *      Off unless 0 < fine_tolerance < fine_window.
  */
 typedef struct
 {
     int   seat_time_ms;        /**< Seat time (ms), reserved for future use */
     float minimum_volts;       /**< Minimum valid tilt sensor voltage */
     float maximum_volts;       /**< Maximum valid tilt sensor voltage */
-    float deadband;            /**< Unused placeholder */
+    float deadband;            /**< Predictive stop: closer than this is on target (V) */
     float stop_band_in;        /**< Stop-band compensation when pulling IN (V) */
     float stop_band_out;       /**< Stop-band compensation when pulling OUT (V) */
-    float sec_per_degree;      /**< Unused placeholder (speed) */
+    float sec_per_degree;      /**< Actuator travel time (s/degree), sets the stall threshold */
     float max_angle;           /**< Maximum allowed tilt angle (degree) */
     float min_angle;           /**< Minimum allowed tilt angle (degree) */
     int   control_time_ms;     /**< Motion loop sampling time (ms) */
+    int   stop_predict;        /**< 1 = predictive stop instead of the stop bands */
+    float coast_ms;            /**< Coast time constant after relay release (ms) */
+    int   learn_stop_band;     /**< 1 = adapt the stop bands to settled positions */
+    float fine_window;         /**< Pulse approach below this error (V), 0 = off */
+    float fine_tolerance;      /**< Pulse until within this error (V) */
+    float fine_volts_per_ms;   /**< First pulse gain (V/ms), then learned */
 } TiltCalibration_t;
 
 /**
@@ -57,6 +95,33 @@ typedef enum
     TILT_ERROR       /**< Motion failed due to error or invalid input */
 } TiltResult_t;
 
+#define TILT_STALL_SAMPLES  16   /**< Control ticks kept for a stall event */
+
+/**
+ * @brief One control tick of a move, as seen by the stall detector.
+ */
+typedef struct
+{
+    uint64_t t_ms;              /**< Tick time */
+    int      adc;               /**< Position sample (ADC counts) */
+    float    speed;             /**< Estimated velocity (V/s, + = OUT) */
+} TiltSample_t;
+
+/**
+ * @brief A stall trip and the ticks leading up to it.
+ */
+typedef struct
+{
+    uint64_t     t_ms;              /**< Time of the trip */
+    int          homing;            /**< 1 during homing, 0 during a move */
+    int          direction_up;      /**< Commanded direction */
+    int          startup;           /**< 1 if inside the start-up window */
+    float        expected_speed;    /**< Calibrated speed (V/s) */
+    float        min_speed;         /**< Trip threshold in effect (V/s) */
+    int          count;             /**< Valid samples, oldest first */
+    TiltSample_t samples[TILT_STALL_SAMPLES];
+} TiltStallEvent_t;
+
 /**
  * @brief Apply calibration values to the tilt controller.
  *
@@ -80,6 +145,13 @@ float ControlTilt_TiltToVolt(float degree);
  */
 float ControlTilt_VoltToTilt(float volts);
 
+/**
+ * @brief Calibrated tilt speed.
+ *
+ * @return Seconds per degree (0.5 if the calibration has none).
+ */
+float ControlTilt_SecPerDegree(void);
+
 /**
  * @brief Read raw tilt voltage from ADC.
  *
@@ -94,6 +166,49 @@ float ControlTilt_ReadVolt(void);
  */
 float ControlTilt_ReadDegree(void);
 
+/**
+ * @brief Estimated tilt velocity of the current move.
+ *
+ * Alpha-beta estimate, updated on every control tick of a move from the
+ * tick's ADC sample. Positive when pulling OUT.
+ *
+ * @return Volts per second (0 when no move has been serviced yet).
+ */
+float ControlTilt_ReadSpeed(void);
+
+/**
+ * @brief Learned fine-positioning pulse gain.
+ *
+ * @param up 1 for pulses OUT, 0 for pulses IN.
+ * @return Volts moved per ms of relay pulse, including the coast.
+ */
+float ControlTilt_ReadPulseGain(int up);
+
+/**
+ * @brief Check whether a fine-positioning pulse is on.
+ *
+ * The executive services the move at command rate while this is set, so
+ * a pulse ends within one base tick instead of on the next tilt task run.
+ *
+ * @return 1 while the relay is on for a timed pulse, 0 otherwise.
+ */
+int ControlTilt_InPulse(void);
+
+/**
+ * @brief Last stall trip, for diagnosis.
+ *
+ * While the relay drives a move or homing, the estimated speed towards
+ * the target is checked on every control tick against the calibrated
+ * speed (sec_per_degree), after a 300 ms grace for the relay to reverse a
+ * coasting actuator. Two ticks in a row below 20% of it until 600 ms
+ * (start-up), or below 50% after that, stop the axis with TILT_ERROR and
+ * record the event with the last TILT_STALL_SAMPLES ticks.
+ *
+ * @param out Optional output for the last event.
+ * @return Number of stall trips so far (0 = none, @p out untouched).
+ */
+int ControlTilt_GetStallEvent(TiltStallEvent_t *out);
+
 /**
  * @brief Check whether the tilt axis is at the HOME position.
  *
@@ -133,10 +248,16 @@ TiltResult_t ControlTilt_BeginHome(void);
  */
 TiltResult_t ControlTilt_ServiceHome(void);
 
+/**
+ * @brief ControlTilt_ServiceHome() with the context of the current tick.
+ */
+TiltResult_t ControlTilt_ServiceHomeTick(ControlTick_t *tick);
+
 /**
  * @brief Blocking homing routine.
  *
- * Wraps BeginHome() + ServiceHome() until completion.
+ * Wraps BeginHome() + ServiceHome() until completion, sleeping until
+ * each control tick is due (or the home sensor fires) instead of spinning.
  *
  * @return 0 on success, non-zero on failure.
  */
@@ -150,6 +271,13 @@ int ControlTilt_Home(void);
  */
 TiltResult_t ControlTilt_BeginMoveToVolt(float target_volt);
 
+/**
+ * @brief Check that a target degree is inside the calibrated range.
+ *
+ * @return 1 if ControlTilt_BeginMoveToDegree() would accept it, 0 otherwise.
+ */
+int ControlTilt_CheckDegree(float degree);
+
 /**
  * @brief Begin a non-blocking move to a target degree.
  */
@@ -160,8 +288,17 @@ TiltResult_t ControlTilt_BeginMoveToDegree(float target_degree);
  */
 TiltResult_t ControlTilt_Service(float *actual_volt_out);
 
+/**
+ * @brief ControlTilt_Service() with the context of the current tick.
+ *
+ * Reads the tilt position at most once per tick (control_tick.h).
+ */
+TiltResult_t ControlTilt_ServiceTick(ControlTick_t *tick, float *actual_volt_out);
+
 /**
  * @brief Blocking move to a target voltage.
+ *
+ * Sleeps between control ticks (control_time_ms) instead of spinning.
  */
 TiltResult_t ControlTilt_MoveToVolt(float target_volt,
                                     float *actual_volt_out);
@@ -0,0 +1,121 @@
+/**
+ * @file di_edge.h
+ * @brief Digital input edge capture on top of the IO cycle.
+ *
+ * io_scan_inputs() hands the DI byte of every scan snapshot to
+ * di_edge_update(), which compares it with the previous cycle and
+ * publishes one DiEdge_t per changed channel into a lock-free ring,
+ * timestamped with the start of the IO cycle (hal_cycle(), CLOCK_MONOTONIC
+ * µs in real time).
+ *
+ * Consumers subscribe to the channels and edge directions they care about.
+ * Each subscriber has its own read position in the ring and an eventfd
+ * that becomes readable when a matching edge is published, so a thread
+ * can block in poll()/select() (or di_edge_wait()) instead of polling
+ * KB_GET_VALUE in a sleep loop. A subscriber that falls more than
+ * DI_EDGE_RING_SIZE edges behind loses the oldest ones
+ * (di_edge_lost()).
+ *
+ * The ring has a single producer (the thread running the IO cycle).
+ * di_edge_next(), di_edge_wait() and di_edge_flush() for a given
+ * subscriber must be called from one thread at a time; different
+ * subscribers may be served from different threads.
+ *
+ * Levels are raw: the proximity sensors and ESTOP are inverted, so
+ * "home reached" and "ESTOP pressed" are falling edges (see motion.h).
+ */
+
+#ifndef DI_EDGE_H
+#define DI_EDGE_H
+
+#include <stdint.h>
+
+#define DI_EDGE_RING_SIZE   256     /**< Edges kept in the ring (power of 2) */
+#define DI_EDGE_MAX_SUBS    8       /**< Concurrent subscribers */
+
+#define DI_EDGE_RISING      0x01    /**< Raw 0 -> 1 */
+#define DI_EDGE_FALLING     0x02    /**< Raw 1 -> 0 */
+#define DI_EDGE_BOTH        (DI_EDGE_RISING | DI_EDGE_FALLING)
+
+/** Subscription mask bit for DI channel @p ch (1–4) */
+#define DI_EDGE_CH(ch)      (1u << ((ch) - 1))
+
+/**
+ * @brief One DI transition.
+ */
+typedef struct
+{
+    uint64_t t_us;     /**< Start of the IO cycle that saw the new level */
+    uint64_t seq;      /**< Edge number since start-up (gaps = lost edges) */
+    uint8_t  ch;       /**< DI channel (1–4) */
+    uint8_t  level;    /**< New raw level (0 or 1) */
+} DiEdge_t;
+
+/**
+ * @brief Feed the DI byte of a new IO cycle (called by io_scan_inputs()).
+ *
+ * The first call only records the levels.
+ *
+ * @param di_byte Raw DI byte (DI1 = bit 0).
+ * @param t_us Cycle timestamp.
+ */
+void di_edge_update(uint8_t di_byte, uint64_t t_us);
+
+/**
+ * @brief Current raw level of a DI channel as of the last IO cycle.
+ *
+ * @return 0 or 1, or -1 if no cycle has run yet or @p ch is invalid.
+ */
+int di_edge_level(int ch);
+
+/**
+ * @brief Register a subscriber.
+ *
+ * Only edges published after this call are delivered.
+ *
+ * @param ch_mask DI_EDGE_CH() bits of the channels of interest.
+ * @param edges DI_EDGE_RISING, DI_EDGE_FALLING or DI_EDGE_BOTH.
+ * @return Subscriber id (>= 0), or -1 if the table is full or eventfd()
+ *         failed.
+ */
+int di_edge_subscribe(unsigned ch_mask, unsigned edges);
+
+/**
+ * @brief Release a subscriber and close its eventfd.
+ */
+void di_edge_unsubscribe(int sub);
+
+/**
+ * @brief Eventfd of a subscriber, readable while matching edges are pending.
+ *
+ * @return File descriptor, or -1 if @p sub is invalid.
+ */
+int di_edge_fd(int sub);
+
+/**
+ * @brief Take the next matching edge without blocking.
+ *
+ * @return 1 if @p e was filled, 0 if no edge is pending, -1 if @p sub is
+ *         invalid.
+ */
+int di_edge_next(int sub, DiEdge_t *e);
+
+/**
+ * @brief Wait for the next matching edge.
+ *
+ * @param timeout_ms Maximum wait; -1 waits forever, 0 does not block.
+ * @return 1 if @p e was filled, 0 on timeout, -1 on error.
+ */
+int di_edge_wait(int sub, DiEdge_t *e, int timeout_ms);
+
+/**
+ * @brief Drop all pending edges of a subscriber.
+ */
+void di_edge_flush(int sub);
+
+/**
+ * @brief Number of edges a subscriber missed because the ring wrapped.
+ */
+uint64_t di_edge_lost(int sub);
+
+#endif /* DI_EDGE_H */
@@ -0,0 +1,104 @@
+/**
+ * @file executive.h
+ * @brief Multi-rate cyclic executive on one base tick.
+ *
+ * Tasks register with a period and a priority. Exec_Tick() runs one base
+ * tick:
+ *
+ *   io_scan_inputs()            one IO snapshot, one timestamp
+ *   due tasks, by priority      period_us / base_us ticks apart
+ *   io_scan_outputs()           one flush of everything they wrote
+ *
+ * Every task run in the same tick sees the same ExecTick_t (cycle number
+ * and hal_cycle() timestamp), so ESTOP supervision can run at 1 kHz while
+ * the axis engines run at 10 Hz off the same snapshot and clock.
+ *
+ * While a task runs, Exec_InTask() is true and Exec_Now() returns the
+ * tick. The axis engines use this to let the executive set their rate
+ * and timestamp instead of their own ShouldTick() timers; called from
+ * anywhere else (blocking helpers, Control_Tick()) they keep their
+ * control_time_ms pacing.
+ */
+
+#ifndef EXECUTIVE_H
+#define EXECUTIVE_H
+
+#include <stdint.h>
+
+#define EXEC_MAX_TASKS  16
+
+/**
+ * @brief The base tick being executed.
+ */
+typedef struct
+{
+    uint64_t count;    /**< Base ticks since Exec_Init() */
+    uint64_t t_us;     /**< Timestamp of the tick's IO scan (hal_cycle()) */
+} ExecTick_t;
+
+typedef void (*ExecTaskFn_t)(const ExecTick_t *tick);
+
+/**
+ * @brief Per-task counters.
+ */
+typedef struct
+{
+    const char *name;
+    uint32_t    period_us;    /**< Effective period (multiple of the base) */
+    int         priority;     /**< Lower runs first */
+    uint64_t    runs;
+    uint64_t    exec_max_us;  /**< Longest single run */
+} ExecTaskStats_t;
+
+/**
+ * @brief Reset the executive and set the base tick.
+ *
+ * Removes all tasks.
+ *
+ * @param base_us Base tick period in µs (the main loop period).
+ */
+void Exec_Init(uint32_t base_us);
+
+/**
+ * @brief Register a task.
+ *
+ * The period is rounded to the nearest multiple of the base tick (at least
+ * one). Tasks with equal priority run in registration order.
+ *
+ * @param name Static name for statistics.
+ * @param period_us Desired period in µs.
+ * @param priority Order within a tick, lower first.
+ * @param fn Task body.
+ * @return Task id (>= 0), or -1 if the table is full or arguments are invalid.
+ */
+int Exec_AddTask(const char *name, uint32_t period_us, int priority,
+                 ExecTaskFn_t fn);
+
+/**
+ * @brief Run one base tick (scan, due tasks, flush).
+ */
+void Exec_Tick(void);
+
+/**
+ * @brief Check whether the caller is running inside an executive task.
+ */
+int Exec_InTask(void);
+
+/**
+ * @brief The tick being executed, or NULL outside Exec_Tick().
+ */
+const ExecTick_t *Exec_Now(void);
+
+/**
+ * @brief Counters of task @p id.
+ *
+ * @return 0 on success, -1 if @p id is invalid.
+ */
+int Exec_GetTaskStats(int id, ExecTaskStats_t *stats);
+
+/**
+ * @brief Print the task table with run counts and worst execution times.
+ */
+void Exec_PrintStats(void);
+
+#endif /* EXECUTIVE_H */
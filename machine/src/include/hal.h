@@ -0,0 +1,193 @@
+/**
+ * @file hal.h
+ * @brief Pluggable process-image backend for the machine HAL.
+ *
+ * mio.c, ro.c and motion.c reach the process image through io_scan.c,
+ * which calls the functions below. Each call is forwarded to the active
+ * backend:
+ *
+ * - "revpi": piControlIf, read/write syscalls (or mmap if
+ *            PICONTROL_BACKEND=mmap)
+ * - "mmap":  piControlIf with the mmap backend forced
+ * - "sim":   in-memory 4096-byte image, no hardware required
+ * - "replay": a trace recorded with HAL_TRACE (see @ref hal_trace.h)
+ *
+ * The backend is chosen with hal_select() (e.g. from a config file) or the
+ * HAL_BACKEND environment variable, which takes precedence. The default is
+ * "revpi", the behavior before the backend layer existed.
+ *
+ * Setting HAL_TRACE=<file> records every access of any backend to a trace
+ * that the "replay" backend can play back.
+ *
+ * The access functions are thread-safe: one priority-inheriting lock
+ * serializes the calls into the backend, so the safety thread (safety.h)
+ * can read ESTOP and switch the relays off while the control thread is in
+ * the middle of an IO scan. hal_force_off() holds a range of outputs at
+ * zero against every later write until hal_force_release().
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdint.h>
+#include "piControlIf.h"
+
+#define HAL_BACKEND_ENV      "HAL_BACKEND"
+#define HAL_BACKEND_DEFAULT  "revpi"
+
+/**
+ * @brief Backend operations.
+ *
+ * read/write/readv/writev return the number of bytes transferred or -1,
+ * like the piControlIf calls they replace. cycle may be NULL.
+ */
+typedef struct
+{
+    const char *name;
+
+    int  (*open)(void);
+    void (*close)(void);
+
+    int  (*read)(uint32_t offset, uint32_t length, uint8_t *data);
+    int  (*write)(uint32_t offset, uint32_t length, const uint8_t *data);
+    int  (*readv)(const SPISegment *seg, int count);
+    int  (*writev)(const SPISegment *seg, int count);
+
+    int  (*get_bit)(uint32_t offset, uint8_t bit);
+    int  (*set_bit)(uint32_t offset, uint8_t bit, int value);
+
+    int  (*wait_event)(void);
+
+    /** Called at the start of every IO cycle, before the inputs are read */
+    void (*cycle)(uint64_t count, uint64_t t_us);
+} HalBackend_t;
+
+/**
+ * @brief Timestamped IO cycle counter.
+ */
+typedef struct
+{
+    uint64_t count;   /**< IO cycles started since hal_init() */
+    uint64_t t_us;    /**< TimeSource_NowUs() at the start of the current cycle */
+} HalCycle_t;
+
+/**
+ * @brief Select a backend by name ("revpi", "mmap", "sim", "replay").
+ *
+ * Must be called before hal_init(). HAL_BACKEND overrides the selection.
+ *
+ * @return 0 on success, -1 if the name is unknown.
+ */
+int hal_select(const char *name);
+
+/**
+ * @brief Open the selected backend.
+ *
+ * Called by mio_init() and ro_init(); safe to call more than once. Access
+ * functions call it implicitly if needed.
+ *
+ * @return 0 on success, -1 on failure.
+ */
+int hal_init(void);
+
+/**
+ * @brief Stop the trace and close the active backend. The next access
+ *        reopens it.
+ */
+void hal_close(void);
+
+/**
+ * @brief Name of the active (or selected) backend.
+ */
+const char *hal_backend_name(void);
+
+/**
+ * @brief Read a byte range of the process image.
+ *
+ * @return Number of bytes read, or -1 on error.
+ */
+int hal_read(uint32_t offset, uint32_t length, uint8_t *data);
+
+/**
+ * @brief Write a byte range of the process image.
+ *
+ * @return Number of bytes written, or -1 on error.
+ */
+int hal_write(uint32_t offset, uint32_t length, const uint8_t *data);
+
+/**
+ * @brief Read several ranges in one request.
+ *
+ * @return Total number of bytes read, or -1 on error.
+ */
+int hal_readv(const SPISegment *seg, int count);
+
+/**
+ * @brief Write several ranges in one request.
+ *
+ * @return Total number of bytes written, or -1 on error.
+ */
+int hal_writev(const SPISegment *seg, int count);
+
+/**
+ * @brief Read one bit of the process image.
+ *
+ * @return 0 or 1, or -1 on error.
+ */
+int hal_get_bit(uint32_t offset, uint8_t bit);
+
+/**
+ * @brief Set or clear one bit of the process image.
+ *
+ * @return 0 on success, -1 on error.
+ */
+int hal_set_bit(uint32_t offset, uint8_t bit, int value);
+
+/**
+ * @brief Switch a range of outputs off and hold it off.
+ *
+ * Writes zeros to the range in one backend write. Until
+ * hal_force_release(), every hal_write(), hal_writev() and hal_set_bit()
+ * that touches the range has those bytes replaced by zero before it
+ * reaches the backend (and the trace), so no other thread can turn the
+ * outputs back on. One range at a time; a new call replaces the previous
+ * range.
+ *
+ * @return Number of bytes written, or -1 on error (the range is forced
+ *         even if the write itself failed).
+ */
+int hal_force_off(uint32_t offset, uint32_t length);
+
+/**
+ * @brief Stop forcing the range set by hal_force_off().
+ *
+ * The outputs stay off until the next write.
+ */
+void hal_force_release(void);
+
+/**
+ * @brief Check whether a range is being forced off.
+ */
+int hal_forced(void);
+
+/**
+ * @brief Block until the backend reports an event (e.g. a driver reset).
+ *
+ * @return Event code (KB_EVENT_RESET), or -1 if unsupported or on error.
+ */
+int hal_wait_event(void);
+
+/**
+ * @brief Start a new IO cycle.
+ *
+ * Increments the cycle counter, timestamps it and runs the backend's
+ * cycle hook. Called by io_scan_inputs().
+ */
+void hal_cycle_begin(void);
+
+/**
+ * @brief Current IO cycle number and start time.
+ */
+HalCycle_t hal_cycle(void);
+
+#endif /* HAL_H */
@@ -0,0 +1,206 @@
+/**
+ * @file hal_trace.h
+ * @brief Process-image trace recorder and reader.
+ *
+ * While a trace is open, hal_core.c appends every process-image access that
+ * reaches the backend: the start of each IO cycle, every input read
+ * (io_scan snapshots included) and every output write, each with its
+ * timestamp, offset and bytes. The "replay" backend (hal_replay.c) feeds
+ * such a trace back into Control_Tick().
+ *
+ * The trace is started with hal_trace_start() or by setting HAL_TRACE to a
+ * file path before hal_init().
+ *
+ * File format (host byte order, little-endian on the RevPi):
+ *
+ *   header   HalTraceHeader_t (32 bytes)
+ *   records  type:u8  dt_us:varint  body...
+ *
+ *   CYCLE    (no body)
+ *   READ     offset:varint  length:varint  runs
+ *   WRITE    offset:varint  length:varint  runs
+ *   GET_BIT  offset:varint  bit | value << 3 : u8
+ *   SET_BIT  offset:varint  bit | value << 3 : u8
+ *
+ * dt_us is the time since the previous record (the first record counts
+ * from HalTraceHeader_t.t0_us). Varints are unsigned LEB128.
+ *
+ * READ and WRITE are delta-encoded against the image as last recorded:
+ * "runs" is a sequence of (skip:varint, n:varint, n bytes) that ends as
+ * soon as skip reaches the end of the range, so an unchanged range costs a
+ * single byte. A scan tick with no input change is about 8 bytes.
+ *
+ * The file is written through a shared mapping that grows in
+ * HAL_TRACE_CHUNK steps, so records survive a crash of the process. A zero
+ * type byte (unwritten tail) ends the trace.
+ */
+
+#ifndef HAL_TRACE_H
+#define HAL_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HAL_TRACE_ENV      "HAL_TRACE"
+#define HAL_TRACE_MAGIC    0x52545052u    /* "RPTR" */
+#define HAL_TRACE_VERSION  1
+#define HAL_TRACE_CHUNK    (1u << 20)
+
+/**
+ * @brief Trace record types.
+ */
+typedef enum
+{
+    HAL_TRACE_END     = 0,   /**< End of trace (unwritten tail) */
+    HAL_TRACE_CYCLE   = 1,   /**< hal_cycle_begin() */
+    HAL_TRACE_READ    = 2,   /**< Bytes returned by a read */
+    HAL_TRACE_WRITE   = 3,   /**< Bytes passed to a write */
+    HAL_TRACE_GET_BIT = 4,   /**< Bit returned by hal_get_bit() */
+    HAL_TRACE_SET_BIT = 5,   /**< Bit passed to hal_set_bit() */
+} HalTraceType_t;
+
+/**
+ * @brief File header.
+ */
+typedef struct
+{
+    uint32_t magic;          /**< HAL_TRACE_MAGIC */
+    uint16_t version;        /**< HAL_TRACE_VERSION */
+    uint16_t header_size;    /**< sizeof(HalTraceHeader_t) */
+    uint32_t image_size;     /**< Process image size (4096) */
+    uint32_t reserved;
+    uint64_t t0_us;          /**< TimeSource_NowUs() when the trace started */
+    uint64_t reserved2;
+} HalTraceHeader_t;
+
+/**
+ * @brief One decoded record.
+ *
+ * For READ/WRITE, @c data points into the reader's image (the full range
+ * after the delta is applied). For GET_BIT/SET_BIT, @c length is 1 and
+ * @c bit / @c value hold the bit.
+ */
+typedef struct
+{
+    HalTraceType_t type;
+    uint64_t       t_us;     /**< Absolute timestamp */
+    uint32_t       offset;
+    uint32_t       length;
+    const uint8_t *data;
+    uint8_t        bit;
+    uint8_t        value;
+} HalTraceRecord_t;
+
+/**
+ * @brief Sequential trace reader.
+ */
+typedef struct
+{
+    const uint8_t *base;     /**< Mapped file */
+    size_t         size;
+    size_t         pos;      /**< Next record */
+    uint64_t       t_us;     /**< Timestamp of the last record */
+    uint8_t        image[4096];
+} HalTraceReader_t;
+
+/* -------------------------------------------------------------------------
+ * Recorder
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Create (truncate) a trace file and start recording.
+ *
+ * @return 0 on success, -1 on error (recording stays off).
+ */
+int hal_trace_start(const char *path);
+
+/**
+ * @brief Stop recording, trim the file to the recorded length and close it.
+ */
+void hal_trace_stop(void);
+
+/**
+ * @brief Check whether a trace is being recorded.
+ */
+int hal_trace_active(void);
+
+/**
+ * @brief Bytes recorded so far, header included.
+ */
+uint64_t hal_trace_bytes(void);
+
+/** @name Record hooks (called by hal_core.c) */
+/** @{ */
+void hal_trace_cycle(uint64_t t_us);
+void hal_trace_read(uint32_t offset, uint32_t length, const uint8_t *data);
+void hal_trace_write(uint32_t offset, uint32_t length, const uint8_t *data);
+void hal_trace_get_bit(uint32_t offset, uint8_t bit, int value);
+void hal_trace_set_bit(uint32_t offset, uint8_t bit, int value);
+/** @} */
+
+/* -------------------------------------------------------------------------
+ * Reader
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Map a trace file and check its header.
+ *
+ * @return 0 on success, -1 if the file cannot be mapped or is not a trace.
+ */
+int hal_trace_reader_open(HalTraceReader_t *r, const char *path);
+
+/**
+ * @brief Unmap a trace file.
+ */
+void hal_trace_reader_close(HalTraceReader_t *r);
+
+/**
+ * @brief Decode the next record and apply it to the reader's image.
+ *
+ * @return 1 if a record was decoded, 0 at the end of the trace, -1 if the
+ *         trace is corrupt.
+ */
+int hal_trace_reader_next(HalTraceReader_t *r, HalTraceRecord_t *rec);
+
+/* -------------------------------------------------------------------------
+ * Replay backend
+ * ------------------------------------------------------------------------- */
+
+#define HAL_REPLAY_ENV        "HAL_REPLAY"
+#define HAL_REPLAY_SPEED_ENV  "HAL_REPLAY_SPEED"
+
+/**
+ * @brief Replay progress and divergence counters.
+ */
+typedef struct
+{
+    uint64_t records;      /**< Records consumed */
+    uint64_t cycles;       /**< CYCLE records consumed */
+    uint64_t mismatches;   /**< Accesses that differ from the trace */
+    int      done;         /**< End of trace reached */
+} HalReplayStats_t;
+
+/**
+ * @brief Set the trace replayed by the next hal_init() of "replay".
+ *
+ * HAL_REPLAY overrides the path.
+ */
+void hal_replay_set_file(const char *path);
+
+/**
+ * @brief Set the replay speed relative to the recording.
+ *
+ * 1.0 replays in real time, 10.0 ten times faster, 0 (default) without
+ * pacing. Pacing applies at CYCLE records and only in real time; in
+ * virtual time the clock is moved to each record's timestamp instead, so
+ * the run is as fast as possible and still sees the recorded timing.
+ * HAL_REPLAY_SPEED overrides the setting.
+ */
+void hal_replay_set_speed(double speed);
+
+/**
+ * @brief Replay counters since the backend was opened.
+ */
+HalReplayStats_t hal_replay_stats(void);
+
+#endif /* HAL_TRACE_H */
@@ -0,0 +1,82 @@
+/**
+ * @file io_scan.h
+ * @brief PLC-style scan cycle over the RevPi process image.
+ *
+ * At the start of each control tick io_scan_inputs() copies the MIO input
+ * region and the RO output byte into a cached snapshot with a single bulk
+ * read. While the snapshot is valid, mio_get_*() and ro_get_*() are served
+ * from memory instead of one lseek+read per channel.
+ *
+ * The same buffer is the shadow output image: writes to the RO byte, the
+ * MIO DO byte and the AO words during a tick only mark them dirty, and
+ * io_scan_outputs() flushes each dirty region with one write at the end of
+ * the tick. Direction and enable changes therefore land in the same IO
+ * cycle.
+ *
+ * Outside a scan cycle every call falls through to the HAL backend (see
+ * @ref hal.h) directly, so
+ * code that never runs Control_Tick() (tests, blocking helpers) keeps the
+ * original behavior.
+ */
+
+#ifndef IO_SCAN_H
+#define IO_SCAN_H
+
+#include <stdint.h>
+#include "hal.h"
+
+/**
+ * @brief Read the scanned process-image region into the snapshot.
+ *
+ * Starts a scan cycle (hal_cycle_begin()), passes the DI byte to
+ * di_edge_update() and the AI words to ai_filter_update(). The snapshot
+ * stays valid until io_scan_outputs().
+ *
+ * @return 0 on success, -1 on read error (snapshot left invalid).
+ */
+int io_scan_inputs(void);
+
+/**
+ * @brief Flush dirty output regions and end the current scan cycle.
+ *
+ * Writes the RO byte, the MIO DO byte and the dirty AO span with one
+ * hal_writev() call (one pwrite per dirty region on RevPi). Subsequent
+ * reads and writes go straight to the backend until the next
+ * io_scan_inputs().
+ *
+ * @return 0 on success, -1 if any flush write failed.
+ */
+int io_scan_outputs(void);
+
+/**
+ * @brief Check whether a scan snapshot is currently valid.
+ *
+ * @return 1 if valid, 0 otherwise.
+ */
+int io_scan_is_valid(void);
+
+/**
+ * @brief Read process-image bytes, from the snapshot when possible.
+ *
+ * @param offset Byte offset in the process image.
+ * @param length Number of bytes to read.
+ * @param data Output buffer.
+ * @return Number of bytes read, or -1 on error.
+ */
+int io_scan_read(uint32_t offset, uint32_t length, uint8_t *data);
+
+/**
+ * @brief Write process-image bytes.
+ *
+ * Inside a scan cycle, writes to an output region are staged in the
+ * shadow image and flushed by io_scan_outputs(); anything else is written
+ * through immediately.
+ *
+ * @param offset Byte offset in the process image.
+ * @param length Number of bytes to write.
+ * @param data Input buffer.
+ * @return Number of bytes written, or -1 on error.
+ */
+int io_scan_write(uint32_t offset, uint32_t length, const uint8_t *data);
+
+#endif /* IO_SCAN_H */
@@ -24,6 +24,9 @@ typedef enum
 
 /**
  * @brief Global machine state shared across main, control, and axis modules.
+ *
+ * Owned by the control thread. Other threads request pause/resume/stop
+ * through the command queue (control_cmd.h), not through these flags.
  */
 typedef struct
 {
@@ -8,7 +8,8 @@
  * - Analog Inputs (AI1–AI8)
  * - Analog Outputs (AO1–AO8)
  *
- * All functions internally use piControl ioctl access (no mmap).
+ * All functions go through the HAL backend selected in @ref hal.h
+ * (piControl read/write by default, mmap, or the simulator).
  * Offsets and bit positions are defined in @ref mio_addr.h.
  */
 
@@ -18,7 +19,7 @@
 #include <stdint.h>
 
 /**
- * @brief Initialize the MIO HAL and open piControl device.
+ * @brief Initialize the MIO HAL and open the HAL backend.
  *
  * This must be called once before using any other MIO functions.
  *
@@ -43,6 +43,7 @@
 
 /* Analog Inputs */
 #define AI_TILT_POS       1
+#define AI_TILT_FILTER_N  8     /**< Scan samples averaged by ReadTiltPosition() */
 
 /* Relay Outputs */
 #define RO_TILT_DIR       4
@@ -85,14 +86,19 @@ int ReadTiltADC(void);
 /**
  * @brief Read the tilt position with filtering.
  *
- * This function reads the ADC three times with 1 ms spacing and returns
- * the integer average. The ADC range is 0–10000 corresponding to 0–10 V.
+ * Inside a scan cycle (see io_scan.h) this is the mean of the last
+ * AI_TILT_FILTER_N scan samples (ai_filter.h), without any extra read or
+ * sleep. Outside a scan, the ADC is read three times with 1 ms spacing and
+ * the integer average is returned. The ADC range is 0–10000 corresponding
+ * to 0–10 V.
  *
  * NOTE:
  *   - The ADC cannot reliably measure below ~25 counts (~0.025 V).
  *   - The linear actuator's valid signal range is 0.95–9.23 V
  *     (≈950–9230 counts). Values below ~950 counts are outside the
  *     actuator's meaningful range and should be treated as "0°" or invalid.
+ *   - Samples older than AI_FILTER_WINDOW_US (a pause between scans) are
+ *     not averaged in; after such a gap the current snapshot is returned.
  *
  * @return Filtered ADC value (0–10000) or -1 on error.
  */
@@ -9,7 +9,12 @@
 #include <stdint.h>
 
 /**
- * @brief Initialize RO HAL (opens piControl).
+ * @brief Bit for relay channel @p ch in a ro_set_mask() mask.
+ */
+#define RO_MASK(ch)  (1u << ((ch) - 1))
+
+/**
+ * @brief Initialize RO HAL (opens the HAL backend).
  */
 int ro_init(void);
 
@@ -30,6 +35,18 @@ int ro_get_ro(int ch);
  */
 int ro_set_ro(int ch, int value);
 
+/**
+ * @brief Set several relay output channels with one process-image write.
+ *
+ * Channels whose RO_MASK() bit is set in @p mask take the matching bit of
+ * @p value; all other relays keep their state.
+ *
+ * @param mask Channels to update (RO_MASK(1) … RO_MASK(4))
+ * @param value New state for each channel in @p mask
+ * @return 0 on success, -1 on error
+ */
+int ro_set_mask(uint8_t mask, uint8_t value);
+
 /**
  * @brief Retrieve offset/bit/len for a relay channel.
  *
@@ -0,0 +1,153 @@
+/**
+ * @file rt_loop.h
+ * @brief Fixed-period main loop with absolute deadlines and jitter stats.
+ *
+ * Each tick starts at start + n * period, slept to with
+ * TimeSource_SleepUntilUs() (clock_nanosleep(TIMER_ABSTIME) in real time),
+ * so the period does not drift by the time the tick itself takes.
+ *
+ * Optional real-time setup (RtLoop_Setup()):
+ *   - mlockall(MCL_CURRENT | MCL_FUTURE) to avoid page faults
+ *   - SCHED_FIFO at a given priority
+ *   - pinning to one CPU (e.g. a core isolated with isolcpus=)
+ *
+ * For every tick the loop records the wake-up latency (actual start minus
+ * deadline) in a log2 histogram and the execution time. A tick that ends
+ * after the next deadline is an overrun: the missed deadlines are skipped
+ * and counted, and the loop resumes on the original time grid.
+ *
+ * Typical use:
+ *
+ *   RtLoop_t loop;
+ *   RtLoop_Setup(&cfg);
+ *   RtLoop_Start(&loop, cfg.period_us);
+ *   while (running) {
+ *       RtLoop_Wait(&loop);
+ *       Control_Tick();
+ *       RtLoop_Done(&loop);
+ *   }
+ *   RtLoop_PrintStats(&loop.stats);
+ */
+
+#ifndef RT_LOOP_H
+#define RT_LOOP_H
+
+#include <stdint.h>
+
+#define RT_LOOP_MIN_PERIOD_US   1000U
+#define RT_LOOP_HIST_BUCKETS    24      /**< Up to 2^23 µs (~8 s) */
+
+/**
+ * @brief Process-wide real-time settings.
+ */
+typedef struct
+{
+    uint32_t period_us;      /**< Tick period (>= RT_LOOP_MIN_PERIOD_US) */
+    int      fifo_priority;  /**< SCHED_FIFO priority 1–99, 0 = keep SCHED_OTHER */
+    int      cpu;            /**< CPU to pin to, -1 = no affinity */
+    int      lock_memory;    /**< 1 = mlockall() */
+} RtLoopConfig_t;
+
+/**
+ * @brief Per-tick timing statistics.
+ *
+ * hist[0] counts latencies of 0 µs, hist[i] latencies in
+ * [2^(i-1), 2^i) µs; the last bucket also holds everything above.
+ */
+typedef struct
+{
+    uint64_t ticks;          /**< Ticks run */
+    uint64_t overruns;       /**< Ticks that ended after the next deadline */
+    uint64_t missed;         /**< Deadlines skipped because of overruns */
+    uint64_t lat_min_us;
+    uint64_t lat_max_us;
+    uint64_t lat_sum_us;
+    uint64_t exec_max_us;    /**< Longest tick (wake-up to RtLoop_Done()) */
+    uint64_t hist[RT_LOOP_HIST_BUCKETS];
+} RtLoopStats_t;
+
+/**
+ * @brief Loop state.
+ */
+typedef struct
+{
+    uint32_t      period_us;
+    uint64_t      deadline_us;   /**< Start of the current/next tick */
+    uint64_t      wake_us;       /**< Actual start of the current tick */
+    RtLoopStats_t stats;
+} RtLoop_t;
+
+/**
+ * @brief Default configuration: 100 ms, SCHED_OTHER, no affinity, no mlock.
+ */
+void RtLoop_DefaultConfig(RtLoopConfig_t *cfg);
+
+/**
+ * @brief Apply mlockall, CPU affinity and SCHED_FIFO for the calling thread.
+ *
+ * Each step that fails (typically EPERM without CAP_SYS_NICE /
+ * CAP_IPC_LOCK) is reported on stderr and skipped.
+ *
+ * @return 0 if every requested step succeeded, -1 otherwise.
+ */
+int RtLoop_Setup(const RtLoopConfig_t *cfg);
+
+/**
+ * @brief Start the time grid: the first tick is due now.
+ *
+ * @param period_us Clamped to RT_LOOP_MIN_PERIOD_US.
+ */
+void RtLoop_Start(RtLoop_t *loop, uint32_t period_us);
+
+/**
+ * @brief Sleep until the current deadline and record the wake-up latency.
+ */
+void RtLoop_Wait(RtLoop_t *loop);
+
+/**
+ * @brief End the tick: record its execution time and schedule the next one.
+ */
+void RtLoop_Done(RtLoop_t *loop);
+
+/**
+ * @brief Clear the statistics (e.g. after a warm-up phase).
+ */
+void RtLoop_ResetStats(RtLoop_t *loop);
+
+/**
+ * @brief Upper bound of the latency below which @p pct percent of ticks woke.
+ *
+ * @return Bucket upper edge in µs (0 if no ticks).
+ */
+uint64_t RtLoop_LatencyPercentile(const RtLoopStats_t *stats, double pct);
+
+/**
+ * @brief Print a summary and the latency histogram to stdout.
+ */
+void RtLoop_PrintStats(const RtLoopStats_t *stats);
+
+/*
+ * Histogram helpers, shared with other latency records that use the same
+ * log2 buckets (safety.h).
+ */
+
+/**
+ * @brief Histogram bucket of a latency in µs.
+ */
+unsigned RtLoop_Bucket(uint64_t us);
+
+/**
+ * @brief Percentile of a histogram of @p count samples.
+ *
+ * @return Bucket upper edge in µs (0 if empty, @p max_us past the last
+ *         bucket).
+ */
+uint64_t RtLoop_HistPercentile(const uint64_t *hist, uint64_t count,
+                               uint64_t max_us, double pct);
+
+/**
+ * @brief Print the non-empty buckets of a histogram.
+ */
+void RtLoop_PrintHist(const uint64_t *hist);
+
+#endif /* RT_LOOP_H */
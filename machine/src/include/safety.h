@@ -0,0 +1,131 @@
+/**
+ * @file safety.h
+ * @brief ESTOP safety thread: relays off within one poll of the press.
+ *
+ * A separate thread, normally at a SCHED_FIFO priority above the control
+ * loop, polls DI_ESTOP (DI4) straight from the HAL every period. It does
+ * not go through io_scan or di_edge, so it keeps working while the control
+ * thread is blocked, busy or stuck. On a press it:
+ *
+ *   1. hal_force_off(RO1_OFFSET, 1): all four relays off in one write,
+ *      and held off against any later write by the control thread
+ *   2. Control_NotifyEStopActive(): latches ESTOP in the state machine
+ *
+ * The trip stays latched until Safety_Reset(), which refuses while ESTOP
+ * is still pressed; Control_Init() calls it when it clears its latch. Three consecutive failed reads also trip (fail safe).
+ *
+ * Latency: the press happened after the previous poll, so the time from
+ * that poll to the end of the relay write is an upper bound on the
+ * ESTOP-edge-to-output-write latency. It is recorded per trip in a log2
+ * histogram, like the loop latency in rt_loop.h, and trips above
+ * SAFETY_LATENCY_TARGET_US are counted. With the default 1 ms poll the
+ * bound is one period plus the wake-up latency and the write. On a Revolution
+ * Pi the DI value itself is refreshed once per piControl IO cycle, which
+ * adds up to one cycle in front of what is measured here.
+ *
+ * Without the thread (or in virtual time, which is single-threaded),
+ * Safety_Poll() can be called from the simulation loop instead.
+ */
+
+#ifndef SAFETY_H
+#define SAFETY_H
+
+#include <stdint.h>
+#include "rt_loop.h"
+
+#define SAFETY_PERIOD_US           1000U
+#define SAFETY_FIFO_PRIORITY       90
+#define SAFETY_LATENCY_TARGET_US   2000U
+#define SAFETY_READ_FAULT_LIMIT    3      /**< Failed reads in a row that trip */
+
+/**
+ * @brief Safety counters.
+ *
+ * hist[] uses the RtLoopStats_t buckets: hist[0] counts 0 µs, hist[i]
+ * [2^(i-1), 2^i) µs.
+ */
+typedef struct
+{
+    uint64_t      polls;
+    uint64_t      trips;          /**< ESTOP presses handled */
+    uint64_t      read_errors;
+    uint64_t      write_errors;   /**< Failed relay-off writes */
+    uint64_t      lat_min_us;     /**< Edge-to-write bound, per trip */
+    uint64_t      lat_max_us;
+    uint64_t      lat_sum_us;
+    uint64_t      over_target;    /**< Trips above SAFETY_LATENCY_TARGET_US */
+    uint64_t      write_max_us;   /**< Longest detection-to-write time */
+    uint64_t      hist[RT_LOOP_HIST_BUCKETS];
+    RtLoopStats_t loop;           /**< Poll loop timing (thread only) */
+} SafetyStats_t;
+
+/**
+ * @brief Default thread settings: 1 ms, SCHED_FIFO 90, no affinity.
+ *
+ * lock_memory is left off; mlockall() is process-wide and belongs to the
+ * main loop setup.
+ */
+void Safety_DefaultConfig(RtLoopConfig_t *cfg);
+
+/**
+ * @brief Start the safety thread.
+ *
+ * The thread applies @p cfg to itself with RtLoop_Setup() (failures are
+ * reported and it runs anyway) and polls every cfg->period_us.
+ *
+ * @return 0 on success, -1 if it is already running, time is virtual or
+ *         the thread cannot be created.
+ */
+int Safety_Start(const RtLoopConfig_t *cfg);
+
+/**
+ * @brief Stop and join the safety thread. A latched trip stays latched.
+ */
+void Safety_Stop(void);
+
+/**
+ * @brief Sample ESTOP once and trip if it is pressed.
+ *
+ * This is the thread's loop body.
+ *
+ * @return 1 if tripped (now or earlier), 0 otherwise.
+ */
+int Safety_Poll(void);
+
+/**
+ * @brief Check whether the relays are being held off by a trip.
+ */
+int Safety_IsTripped(void);
+
+/**
+ * @brief Release the relays after ESTOP has been released.
+ *
+ * Control_Init() is still needed to clear the state machine's latch.
+ *
+ * @return 0 on success, -1 if ESTOP is still pressed or cannot be read.
+ */
+int Safety_Reset(void);
+
+/**
+ * @brief Copy the counters.
+ */
+void Safety_GetStats(SafetyStats_t *stats);
+
+/**
+ * @brief Clear the counters.
+ */
+void Safety_ResetStats(void);
+
+/**
+ * @brief Upper bound of the edge-to-write latency of @p pct percent of trips.
+ *
+ * @return Bucket upper edge in µs (0 if no trips).
+ */
+uint64_t Safety_LatencyPercentile(const SafetyStats_t *stats, double pct);
+
+/**
+ * @brief Print the counters and the latency histogram to stdout.
+ */
+void Safety_PrintStats(const SafetyStats_t *stats);
+
+#endif /* SAFETY_H */
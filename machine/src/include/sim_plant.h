@@ -0,0 +1,104 @@
+/**
+ * @file sim_plant.h
+ * @brief Physics model of the T-axis actuator and R-axis motor.
+ *
+ * Used by the "sim" HAL backend. The model reads the relay byte of the
+ * simulated process image (RO_TILT_EN/DIR, RO_ROTATE_EN/DIR), integrates
+ * both axes up to the current time and writes the sensors back:
+ *
+ * - AI_TILT_POS: pot voltage as ADC counts, with Gaussian noise and the
+ *   ~25-count floor below which the MIO reads 0
+ * - DI_PROXI_TILT: tilt home sensor at the retracted end (inverted)
+ * - DI_PROXI_ROTATE: rotate home sensor window around 0° (inverted)
+ * - DI_ESTOP: ESTOP button (inverted)
+ *
+ * Each axis is a first-order velocity model: it spins up towards the
+ * commanded speed with spinup_ms and coasts to rest with coast_ms after
+ * the enable relay drops. The tilt axis stops hard at its travel ends.
+ */
+
+#ifndef SIM_PLANT_H
+#define SIM_PLANT_H
+
+#include <stdint.h>
+
+/**
+ * @brief Plant parameters.
+ */
+typedef struct
+{
+    /* Tilt actuator */
+    float tilt_volts_per_sec;   /**< Pot voltage rate at full speed */
+    float tilt_spinup_ms;       /**< Velocity time constant, relay on */
+    float tilt_coast_ms;        /**< Velocity time constant, relay off */
+    float tilt_min_volts;       /**< Pot voltage at the retracted end stop */
+    float tilt_max_volts;       /**< Pot voltage at the extended end stop */
+    float tilt_home_volts;      /**< Home sensor active at or below this */
+    float tilt_start_volts;     /**< Initial pot voltage */
+
+    /* ADC */
+    float adc_noise_counts;     /**< Noise standard deviation (counts) */
+    int   adc_floor_counts;     /**< Readings below this return 0 */
+
+    /* Rotate motor */
+    float rotate_rpm;           /**< Table speed at full speed */
+    float rotate_spinup_ms;     /**< Velocity time constant, relay on */
+    float rotate_coast_ms;      /**< Velocity time constant, relay off */
+    float rotate_home_deg;      /**< Width of the home sensor window */
+    float rotate_start_deg;     /**< Initial table angle (0 = home) */
+
+    uint32_t seed;              /**< Noise generator seed (0 = fixed default) */
+} SimPlantConfig_t;
+
+/**
+ * @brief Observable plant state.
+ */
+typedef struct
+{
+    float tilt_volts;           /**< True pot voltage */
+    float tilt_velocity;        /**< Volts per second (+ = out/up) */
+    float rotate_deg;           /**< Table angle, unwrapped (+ = CW) */
+    float rotate_velocity;      /**< Degrees per second (+ = CW) */
+    int   estop;                /**< 1 if ESTOP is pressed */
+    int   tilt_jammed;          /**< 1 if the tilt actuator is blocked */
+} SimPlantState_t;
+
+/**
+ * @brief Fill a configuration with defaults matching the tilt and rotate
+ *        calibration defaults (0.5 s/deg over 0.29–8.55 V, 1 rpm).
+ */
+void sim_plant_default_config(SimPlantConfig_t *cfg);
+
+/**
+ * @brief Reset the plant to a configuration (NULL = defaults).
+ *
+ * The next sim_plant_step() starts integrating from its own timestamp.
+ */
+void sim_plant_reset(const SimPlantConfig_t *cfg);
+
+/**
+ * @brief Advance the plant to now_us and update the sensor inputs.
+ *
+ * @param now_us Current time in microseconds (monotonic).
+ * @param image  Process image: relays are read, DI/AI are written.
+ */
+void sim_plant_step(uint64_t now_us, uint8_t *image);
+
+/**
+ * @brief Press (1) or release (0) the simulated ESTOP button.
+ */
+void sim_plant_set_estop(int pressed);
+
+/**
+ * @brief Block (1) or free (0) the tilt actuator, e.g. a mechanical jam.
+ *
+ * While blocked the actuator stands still whatever the relays do.
+ */
+void sim_plant_set_tilt_jam(int jammed);
+
+/**
+ * @brief Current plant state.
+ */
+SimPlantState_t sim_plant_state(void);
+
+#endif /* SIM_PLANT_H */
@@ -0,0 +1,100 @@
+/**
+ * @file time_source.h
+ * @brief Shared time source for the control engines and the HAL.
+ *
+ * All timestamps and delays in control_tilt.c, control_rotate.c,
+ * control.c, motion.c and the HAL go through this module so a simulation
+ * can replace wall-clock time:
+ *
+ * - real (default): CLOCK_MONOTONIC, sleeps block the caller
+ * - virtual: a counter that only moves when someone sleeps or idles, so
+ *   sleeps return immediately and a run against the sim backend takes as
+ *   long as the CPU work it does
+ *
+ * Virtual time is selected with TimeSource_UseVirtual() or
+ * TIME_SOURCE=virtual. The environment is read once, on first use, and
+ * the selection is shared atomically, so any thread may call in.
+ */
+
+#ifndef TIME_SOURCE_H
+#define TIME_SOURCE_H
+
+#include <stdint.h>
+
+#define TIME_SOURCE_ENV  "TIME_SOURCE"
+
+/**
+ * @brief Select virtual (1) or real (0) time.
+ *
+ * Switching to virtual time starts the counter at the current real time,
+ * so timestamps taken before the switch stay in the past.
+ */
+void TimeSource_UseVirtual(int enable);
+
+/**
+ * @brief Check whether virtual time is active.
+ */
+int TimeSource_IsVirtual(void);
+
+/**
+ * @brief Monotonic time in microseconds.
+ */
+uint64_t TimeSource_NowUs(void);
+
+/**
+ * @brief Monotonic time in milliseconds.
+ */
+uint64_t TimeSource_NowMs(void);
+
+/**
+ * @brief Sleep for a number of microseconds (advances virtual time).
+ */
+void TimeSource_SleepUs(uint64_t us);
+
+/**
+ * @brief Sleep for a number of milliseconds (advances virtual time).
+ */
+void TimeSource_SleepMs(uint64_t ms);
+
+/**
+ * @brief Sleep until an absolute TimeSource_NowUs() deadline.
+ *
+ * Real time: clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME), so the
+ * deadline does not drift with the time spent before the call. Virtual
+ * time: same as TimeSource_IdleUntilUs().
+ */
+void TimeSource_SleepUntilUs(uint64_t t_us);
+
+/**
+ * @brief Sleep until a deadline or until a file descriptor becomes readable.
+ *
+ * For blocking loops that poll a non-blocking engine: sleep until its
+ * next tick is due instead of spinning, but wake at once on an event
+ * (an eventfd, e.g. di_edge_fd()). The descriptor is only polled, never
+ * read.
+ *
+ * Real time: poll() on @p fd with the remaining time as timeout, or
+ * TimeSource_SleepUntilUs() without one. Virtual time: returns 1 if
+ * @p fd is already readable, otherwise same as TimeSource_IdleUntilUs().
+ *
+ * @param t_us Absolute TimeSource_NowUs() deadline.
+ * @param fd   Descriptor to wake on, or -1.
+ * @return 1 if @p fd is readable, 0 at the deadline, -1 on error.
+ */
+int TimeSource_WaitUntilUs(uint64_t t_us, int fd);
+
+/**
+ * @brief Report that the caller has nothing to do before @p t_us.
+ *
+ * Real time: returns immediately (pollers keep spinning as before).
+ * Virtual time: advances the clock to @p t_us if it is in the future, so
+ * busy-polling loops make progress.
+ */
+void TimeSource_IdleUntilUs(uint64_t t_us);
+
+/**
+ * @brief Advance virtual time (no-op in real time).
+ */
+void TimeSource_AdvanceUs(uint64_t us);
+
+#endif /* TIME_SOURCE_H */
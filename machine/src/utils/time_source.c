@@ -0,0 +1,173 @@
+/**
+ * @file time_source.c
+ * @brief Real and virtual time for the control engines and the HAL.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "time_source.h"
+
+/* Read by every thread (safety, executive, tests); atomic access only */
+static int      g_virtual  = -1;    /* -1: not decided yet (check env) */
+static uint64_t g_virtual_us = 0;
+
+static pthread_once_t g_env_once = PTHREAD_ONCE_INIT;
+
+static uint64_t TimeSource_RealUs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/* Runs once; an earlier TimeSource_UseVirtual() wins over the env */
+static void TimeSource_ResolveEnv(void)
+{
+    const char *env;
+
+    if (__atomic_load_n(&g_virtual, __ATOMIC_ACQUIRE) >= 0)
+        return;
+
+    env = getenv(TIME_SOURCE_ENV);
+    TimeSource_UseVirtual(env && strcmp(env, "virtual") == 0);
+}
+
+static int TimeSource_Virtual(void)
+{
+    int v = __atomic_load_n(&g_virtual, __ATOMIC_ACQUIRE);
+
+    if (v < 0) {
+        pthread_once(&g_env_once, TimeSource_ResolveEnv);
+        v = __atomic_load_n(&g_virtual, __ATOMIC_ACQUIRE);
+    }
+    return v;
+}
+
+void TimeSource_UseVirtual(int enable)
+{
+    /* Counter first, so a reader that sees the flag sees a valid time */
+    if (enable && __atomic_load_n(&g_virtual, __ATOMIC_ACQUIRE) != 1)
+        __atomic_store_n(&g_virtual_us, TimeSource_RealUs(), __ATOMIC_SEQ_CST);
+
+    __atomic_store_n(&g_virtual, enable ? 1 : 0, __ATOMIC_RELEASE);
+}
+
+int TimeSource_IsVirtual(void)
+{
+    return TimeSource_Virtual();
+}
+
+uint64_t TimeSource_NowUs(void)
+{
+    if (TimeSource_Virtual())
+        return __atomic_load_n(&g_virtual_us, __ATOMIC_SEQ_CST);
+
+    return TimeSource_RealUs();
+}
+
+uint64_t TimeSource_NowMs(void)
+{
+    return TimeSource_NowUs() / 1000ULL;
+}
+
+void TimeSource_SleepUs(uint64_t us)
+{
+    struct timespec ts;
+
+    if (TimeSource_Virtual()) {
+        __atomic_add_fetch(&g_virtual_us, us, __ATOMIC_SEQ_CST);
+        return;
+    }
+
+    ts.tv_sec  = (time_t)(us / 1000000ULL);
+    ts.tv_nsec = (long)(us % 1000000ULL) * 1000L;
+    while (nanosleep(&ts, &ts) < 0 && errno == EINTR)
+        ;
+}
+
+void TimeSource_SleepMs(uint64_t ms)
+{
+    TimeSource_SleepUs(ms * 1000ULL);
+}
+
+void TimeSource_SleepUntilUs(uint64_t t_us)
+{
+    struct timespec ts;
+
+    if (TimeSource_Virtual()) {
+        TimeSource_IdleUntilUs(t_us);
+        return;
+    }
+
+    ts.tv_sec  = (time_t)(t_us / 1000000ULL);
+    ts.tv_nsec = (long)(t_us % 1000000ULL) * 1000L;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+/* Poll fd for input; 1 readable, 0 timeout, -1 error */
+static int TimeSource_PollFd(int fd, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = fd, .events = POLLIN, .revents = 0 };
+    int n;
+
+    do {
+        n = poll(&pfd, 1, timeout_ms);
+    } while (n < 0 && errno == EINTR);
+
+    if (n < 0) return -1;
+    if (n == 0) return 0;
+    return (pfd.revents & POLLIN) ? 1 : -1;
+}
+
+int TimeSource_WaitUntilUs(uint64_t t_us, int fd)
+{
+    if (TimeSource_Virtual()) {
+        int r = (fd >= 0) ? TimeSource_PollFd(fd, 0) : 0;
+
+        if (r == 0) TimeSource_IdleUntilUs(t_us);
+        return r;
+    }
+
+    if (fd < 0) {
+        TimeSource_SleepUntilUs(t_us);
+        return 0;
+    }
+
+    while (1) {
+        uint64_t now = TimeSource_RealUs();
+        int r;
+
+        if (now >= t_us)
+            return TimeSource_PollFd(fd, 0);
+
+        /* Round up so the deadline is never reported early */
+        r = TimeSource_PollFd(fd, (int)((t_us - now + 999ULL) / 1000ULL));
+        if (r != 0) return r;
+    }
+}
+
+void TimeSource_IdleUntilUs(uint64_t t_us)
+{
+    uint64_t now;
+
+    if (!TimeSource_Virtual())
+        return;
+
+    now = __atomic_load_n(&g_virtual_us, __ATOMIC_SEQ_CST);
+    while (t_us > now &&
+           !__atomic_compare_exchange_n(&g_virtual_us, &now, t_us, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+        ;
+}
+
+void TimeSource_AdvanceUs(uint64_t us)
+{
+    if (TimeSource_Virtual())
+        __atomic_add_fetch(&g_virtual_us, us, __ATOMIC_SEQ_CST);
+}
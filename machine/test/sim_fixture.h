@@ -0,0 +1,125 @@
+/**
+ * @file sim_fixture.h
+ * @brief Shared set-up for the tilt and control tests on the plant model.
+ *
+ * Virtual time, the "sim" backend with the default plant starting at
+ * 1.0 V, a base tilt calibration with every optional stop feature off,
+ * and the settle-and-read helper. Each test changes only the calibration
+ * fields it is about. The control tests start from a calibrated (and
+ * optionally homed) state machine and tick it with sim_fixture_run().
+ */
+
+#ifndef SIM_FIXTURE_H
+#define SIM_FIXTURE_H
+
+#include <assert.h>
+
+#include "hal.h"
+#include "sim_plant.h"
+#include "motion.h"
+#include "machine_state.h"
+#include "control.h"
+#include "control_tilt.h"
+#include "time_source.h"
+
+/**
+ * @brief Virtual time, "sim" backend, no pending requests, default plant.
+ *
+ * @param cfg Output: the plant configuration the plant was reset to.
+ */
+static inline void sim_fixture_init(SimPlantConfig_t *cfg)
+{
+    TimeSource_UseVirtual(1);
+    assert(hal_select("sim") == 0);
+    assert(hal_init() == 0);
+
+    g_machine.pause_requested  = 0;
+    g_machine.resume_requested = 0;
+    g_machine.stop_requested   = 0;
+
+    sim_plant_default_config(cfg);
+    cfg->tilt_start_volts = 1.0f;
+    sim_plant_reset(cfg);
+}
+
+/**
+ * @brief Tilt calibration matching the plant, static 0.2 V stop bands.
+ *
+ * Stop prediction, stop-band learning and fine positioning are off.
+ */
+static inline TiltCalibration_t sim_fixture_tilt_cal(void)
+{
+    TiltCalibration_t cal = {
+        .seat_time_ms      = 200,
+        .minimum_volts     = 0.29f,
+        .maximum_volts     = 8.55f,
+        .deadband          = 0.02f,
+        .stop_band_in      = 0.2f,
+        .stop_band_out     = 0.2f,
+        .sec_per_degree    = 0.5f,
+        .max_angle         = 75.0f,
+        .min_angle         = 0.0f,
+        .control_time_ms   = 100,
+        .coast_ms          = 400.0f,
+        .fine_volts_per_ms = 0.001f
+    };
+
+    return cal;
+}
+
+/**
+ * @brief Let the tilt coast to rest and read where it settled.
+ *
+ * @return Plant tilt voltage (V).
+ */
+static inline float sim_fixture_settle(void)
+{
+    TimeSource_SleepMs(2000);   /* > 4 coast time constants */
+    ReadTiltPosition();         /* advance the plant */
+    return sim_plant_state().tilt_volts;
+}
+
+/**
+ * @brief Plant at 1.0 V tilt and 345 deg rotate, calibrated state machine.
+ *
+ * @param home 1: also home both axes and let them coast to rest.
+ */
+static inline void sim_fixture_control_init(int home)
+{
+    SimPlantConfig_t cfg;
+
+    sim_plant_default_config(&cfg);
+    cfg.tilt_start_volts = 1.0f;
+    cfg.rotate_start_deg = 345.0f;
+    sim_plant_reset(&cfg);
+
+    Control_Init();
+    Control_CalibrateTilt();
+    Control_CalibrateRotate();
+
+    if (home) {
+        assert(Control_Home() == 0);
+        TimeSource_SleepMs(2000);   /* let both axes coast to rest */
+    }
+}
+
+/**
+ * @brief Tick Control_Tick() once, then until the machine leaves RUNNING.
+ *
+ * The first tick runs commands queued before the call (control_cmd.h).
+ *
+ * @return Virtual time taken (ms).
+ */
+static inline uint64_t sim_fixture_run(void)
+{
+    uint64_t t0 = TimeSource_NowMs();
+
+    do {
+        Control_Tick();
+        TimeSource_SleepMs(1);
+    } while (Control_GetStatus() == MACHINE_STATUS_RUNNING);
+
+    return TimeSource_NowMs() - t0;
+}
+
+#endif /* SIM_FIXTURE_H */
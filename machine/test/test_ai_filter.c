@@ -0,0 +1,170 @@
+/**
+ * @file test_ai_filter.c
+ * @brief AI sample rings: mean, median and EMA, the stale-sample window,
+ *        and ReadTiltPosition() on the sim backend.
+ *
+ * Feeds AI words to ai_filter_update() directly, then drives the sim
+ * backend through io_scan_inputs() in virtual time and compares the noise
+ * of the raw and filtered tilt position at rest.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#include "hal.h"
+#include "io_scan.h"
+#include "ai_filter.h"
+#include "motion.h"
+#include "sim_plant.h"
+#include "time_source.h"
+
+#define SCANS  2000
+
+/* One cycle with AI1 = v, AI2 = 2 * v */
+static void feed(uint16_t v, uint64_t t_us)
+{
+    uint16_t ai[AI_FILTER_CHANNELS];
+
+    memset(ai, 0, sizeof(ai));
+    ai[0] = v;
+    ai[1] = (uint16_t)(2 * v);
+    ai_filter_update((const uint8_t *)ai, t_us);
+}
+
+static void test_filters(void)
+{
+    printf("=== test_filters() ===\n");
+
+    ai_filter_reset();
+    assert(ai_filter_raw(1) == -1 && ai_filter_mean(1, 4) == -1);
+    assert(ai_filter_ema(1) == -1 && ai_filter_count(1, 4) == 0);
+
+    /* 100, 102, 104, 106, then a spike */
+    for (int i = 0; i < 4; i++)
+        feed((uint16_t)(100 + 2 * i), 1000 + 1000 * (uint64_t)i);
+    feed(5000, 5000);
+
+    assert(ai_filter_raw(1) == 5000 && ai_filter_raw(2) == 10000);
+    assert(ai_filter_count(1, 8) == 5 && ai_filter_count(1, 3) == 3);
+    assert(ai_filter_mean(1, 4) == (102 + 104 + 106 + 5000 + 2) / 4);
+    assert(ai_filter_median(1, 5) == 104);              /* spike rejected */
+    assert(ai_filter_median(1, 4) == (104 + 106) / 2);
+    assert(ai_filter_mean(1, 1) == 5000);
+
+    /* Invalid channels and weights */
+    assert(ai_filter_raw(0) == -1 && ai_filter_mean(9, 4) == -1);
+    assert(ai_filter_set_ema_alpha(1, 0.0f) == -1);
+    assert(ai_filter_set_ema_alpha(1, 1.5f) == -1);
+
+    /* EMA: alpha 1 follows the input, alpha 0.5 halves each step */
+    ai_filter_reset();
+    assert(ai_filter_set_ema_alpha(1, 0.5f) == 0);
+    assert(ai_filter_set_ema_alpha(2, 1.0f) == 0);
+    feed(100, 1000);
+    feed(200, 2000);
+    feed(200, 3000);
+    assert(ai_filter_ema(1) == 175);
+    assert(ai_filter_ema(2) == 400);
+    assert(ai_filter_set_ema_alpha(1, AI_FILTER_EMA_ALPHA) == 0);
+    assert(ai_filter_set_ema_alpha(2, AI_FILTER_EMA_ALPHA) == 0);
+
+    printf("Filters OK.\n");
+}
+
+static void test_window(void)
+{
+    printf("=== test_window() ===\n");
+
+    ai_filter_reset();
+    for (int i = 0; i < 20; i++)
+        feed(100, 1000 + 1000 * (uint64_t)i);
+    assert(ai_filter_count(1, 32) == AI_FILTER_DEPTH);
+
+    /* A pause in the scan: old samples no longer count, EMA restarts */
+    feed(300, 20000 + AI_FILTER_WINDOW_US + 1);
+    assert(ai_filter_count(1, 8) == 1);
+    assert(ai_filter_mean(1, 8) == 300);
+    assert(ai_filter_median(1, 8) == 300);
+    assert(ai_filter_ema(1) == 300);
+
+    printf("Window OK.\n");
+}
+
+static void stats(const int *v, int n, double *mean, double *sd)
+{
+    double s = 0.0, s2 = 0.0;
+
+    for (int i = 0; i < n; i++) s += v[i];
+    *mean = s / n;
+    for (int i = 0; i < n; i++) s2 += (v[i] - *mean) * (v[i] - *mean);
+    *sd = sqrt(s2 / n);
+}
+
+static void test_sim(void)
+{
+    static int raw[SCANS], mean[SCANS], median[SCANS], ema[SCANS];
+    SimPlantConfig_t cfg;
+    double m_raw, sd_raw, m_mean, sd_mean, m_median, sd_median, m_ema, sd_ema;
+
+    printf("=== test_sim() ===\n");
+
+    sim_plant_default_config(&cfg);
+    cfg.tilt_start_volts = 4.0f;
+    sim_plant_reset(&cfg);
+    ai_filter_reset();
+
+    for (int i = 0; i < SCANS; i++) {
+        uint64_t t0;
+
+        assert(io_scan_inputs() == 0);
+
+        /* Filtered position without a read or a sleep */
+        t0 = TimeSource_NowUs();
+        mean[i] = ReadTiltPosition();
+        assert(TimeSource_NowUs() == t0);
+        assert(mean[i] == ai_filter_mean(AI_TILT_POS, AI_TILT_FILTER_N));
+
+        raw[i]    = ReadTiltADC();
+        median[i] = ai_filter_median(AI_TILT_POS, AI_TILT_FILTER_N);
+        ema[i]    = ai_filter_ema(AI_TILT_POS);
+        assert(io_scan_outputs() == 0);
+
+        TimeSource_SleepMs(1);
+    }
+
+    /* Skip the first scans while the rings fill */
+    stats(raw + 100,    SCANS - 100, &m_raw,    &sd_raw);
+    stats(mean + 100,   SCANS - 100, &m_mean,   &sd_mean);
+    stats(median + 100, SCANS - 100, &m_median, &sd_median);
+    stats(ema + 100,    SCANS - 100, &m_ema,    &sd_ema);
+
+    printf("At 4.0 V: raw %.1f +- %.2f, mean %.1f +- %.2f, median %.1f +- %.2f, "
+           "EMA %.1f +- %.2f counts\n",
+           m_raw, sd_raw, m_mean, sd_mean, m_median, sd_median, m_ema, sd_ema);
+
+    assert(fabs(m_mean - 4000.0) < 2.0 && fabs(m_median - 4000.0) < 2.0);
+    assert(fabs(m_ema - 4000.0) < 2.0);
+    assert(sd_mean < 0.5 * sd_raw);
+    assert(sd_median < 0.7 * sd_raw);
+    assert(sd_ema < 0.7 * sd_raw);
+
+    printf("Sim OK.\n");
+}
+
+int main(void)
+{
+    printf("=== Test: AI oversampling ===\n");
+
+    test_filters();
+    test_window();
+
+    TimeSource_UseVirtual(1);
+    assert(hal_select("sim") == 0);
+    assert(hal_init() == 0);
+    test_sim();
+
+    printf("=== All AI filter tests passed ===\n");
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file test_control_overlap.c
+ * @brief Overlapped tilt + rotate: home and session times against the
+ *        serial sequence, interlock limits, pause/resume.
+ *
+ * Runs on the "sim" backend in virtual time, so the durations are plant
+ * time, not CPU time.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <math.h>
+
+#include "sim_fixture.h"
+#include "control_rotate.h"
+#include "control_status.h"
+
+static const SessionConfig_t g_session = {
+    .tilt_degree = 10,
+    .rotate_dir  = ROTATE_DIR_CW,
+    .rotate_num  = 30,
+    .overlap     = 1,
+};
+
+static void set_interlock(unsigned allow, float max_tilt)
+{
+    ControlInterlock_t il = { .allow = allow, .max_tilt_degree = max_tilt };
+
+    Control_SetInterlock(&il);
+}
+
+/* Home then run the session; returns both durations */
+static void home_and_session(uint64_t *home_ms, uint64_t *session_ms,
+                             ControlPhase_t *session_phase)
+{
+    ControlStatus_t st;
+
+    sim_fixture_control_init(0);
+
+    assert(Control_BeginHome() == 0);
+    *home_ms = sim_fixture_run();
+    assert(Control_GetStatus() == MACHINE_STATUS_READY);
+
+    TimeSource_SleepMs(2000);   /* let both axes coast to rest */
+
+    assert(Control_StartSession(&g_session) == 0);
+    Control_Tick();
+    assert(ControlStatus_Read(&st) == 0);
+    *session_phase = st.phase;
+
+    *session_ms = sim_fixture_run();
+    assert(Control_GetStatus() == MACHINE_STATUS_DONE);
+}
+
+static void test_overlap_times(void)
+{
+    uint64_t home_serial, session_serial, home_both, session_both;
+    ControlPhase_t phase;
+    SimPlantState_t s;
+
+    printf("=== test_overlap_times() ===\n");
+
+    set_interlock(CONTROL_OVERLAP_NONE, 0.0f);
+    home_and_session(&home_serial, &session_serial, &phase);
+    assert(phase == CONTROL_PHASE_TILT);
+
+    set_interlock(CONTROL_OVERLAP_HOME | CONTROL_OVERLAP_SESSION, 45.0f);
+    home_and_session(&home_both, &session_both, &phase);
+    assert(phase == CONTROL_PHASE_BOTH);
+
+    TimeSource_SleepMs(2000);
+    s = sim_plant_state();
+    printf("Home:    serial %llu ms, overlapped %llu ms\n",
+           (unsigned long long)home_serial, (unsigned long long)home_both);
+    printf("Session: serial %llu ms, overlapped %llu ms\n",
+           (unsigned long long)session_serial, (unsigned long long)session_both);
+    printf("Overlapped session settled at tilt %.2f V, rotate %.2f deg\n",
+           s.tilt_volts, remainderf(s.rotate_deg, 360.0f));
+
+    /* Overlapped takes the longer axis, serial the sum */
+    assert(home_both < home_serial);
+    assert(session_both < session_serial);
+    assert(fabsf(remainderf(s.rotate_deg, 360.0f) - 30.0f) < 3.0f);
+
+    printf("Overlap times OK.\n");
+}
+
+static void test_interlock(void)
+{
+    SessionConfig_t cfg = g_session;
+    ControlStatus_t st;
+    uint64_t home_ms, session_ms;
+    ControlPhase_t phase;
+
+    printf("=== test_interlock() ===\n");
+
+    /* Target above the overlap limit: serial */
+    set_interlock(CONTROL_OVERLAP_SESSION, 5.0f);
+    home_and_session(&home_ms, &session_ms, &phase);
+    assert(phase == CONTROL_PHASE_TILT);
+
+    /* Session does not ask for it: serial */
+    set_interlock(CONTROL_OVERLAP_SESSION, 45.0f);
+    sim_fixture_control_init(0);
+    assert(Control_Home() == 0);
+    cfg.overlap = 0;
+    assert(Control_StartSession(&cfg) == 0);
+    Control_Tick();
+    assert(ControlStatus_Read(&st) == 0 && st.phase == CONTROL_PHASE_TILT);
+    sim_fixture_run();
+    assert(Control_GetStatus() == MACHINE_STATUS_DONE);
+
+    /* Homing from above the limit: tilt first, then rotate */
+    assert(Control_Home() == 0);
+    cfg.tilt_degree = 40;
+    assert(Control_StartSession(&cfg) == 0);
+    sim_fixture_run();
+    assert(Control_GetStatus() == MACHINE_STATUS_DONE);
+    TimeSource_SleepMs(2000);
+
+    set_interlock(CONTROL_OVERLAP_HOME, 20.0f);
+    assert(ControlTilt_ReadDegree() > 20.0f);
+    assert(Control_BeginHome() == 0);
+    Control_Tick();
+    assert(ControlStatus_Read(&st) == 0 && st.phase == CONTROL_PHASE_HOME_TILT);
+    sim_fixture_run();
+    assert(Control_GetStatus() == MACHINE_STATUS_READY);
+    assert(ControlTilt_CheckHome() && ControlRotate_CheckHome());
+
+    printf("Interlock OK.\n");
+}
+
+static void test_pause_resume(void)
+{
+    ControlStatus_t st;
+    uint64_t t_pause;
+
+    printf("=== test_pause_resume() ===\n");
+
+    /* Pause with both axes homing: resume restarts both home engines */
+    set_interlock(CONTROL_OVERLAP_HOME | CONTROL_OVERLAP_SESSION, 45.0f);
+    sim_fixture_control_init(0);
+    assert(Control_BeginHome() == 0);
+    t_pause = TimeSource_NowMs() + 500;
+    while (TimeSource_NowMs() < t_pause) {
+        Control_Tick();
+        TimeSource_SleepMs(1);
+    }
+    assert(ControlStatus_Read(&st) == 0);
+    assert(st.status == MACHINE_STATUS_RUNNING && st.phase == CONTROL_PHASE_HOME_BOTH);
+
+    assert(Control_PauseSession() == 0);
+    TimeSource_SleepMs(500);
+    assert(Control_ResumeSession() == 0);
+    sim_fixture_run();
+    assert(Control_GetStatus() == MACHINE_STATUS_READY);
+    assert(ControlTilt_CheckHome() && ControlRotate_CheckHome());
+
+    set_interlock(CONTROL_OVERLAP_SESSION, 45.0f);
+    TimeSource_SleepMs(2000);
+
+    assert(Control_StartSession(&g_session) == 0);
+    /* Pause with both axes mid-move */
+    do {
+        Control_Tick();
+        TimeSource_SleepMs(1);
+        assert(ControlStatus_Read(&st) == 0);
+    } while (st.rotate_degree < 10.0f);
+    assert(st.status == MACHINE_STATUS_RUNNING && st.phase == CONTROL_PHASE_BOTH);
+
+    assert(Control_PauseSession() == 0);
+    assert(Control_GetStatus() == MACHINE_STATUS_PAUSED);
+    TimeSource_SleepMs(500);
+
+    assert(Control_ResumeSession() == 0);
+    sim_fixture_run();
+    assert(Control_GetStatus() == MACHINE_STATUS_DONE);
+
+    /* As in the serial ROTATE phase, resume re-issues the full rotate move */
+    assert(ControlStatus_Read(&st) == 0);
+    printf("Resumed session done: tilt %.2f deg, rotate %.2f deg\n",
+           st.tilt_degree, st.rotate_degree);
+    assert(st.rotate_degree > 29.0f);
+
+    printf("Pause/resume OK.\n");
+}
+
+int main(void)
+{
+    SimPlantConfig_t cfg;
+
+    printf("=== Test: overlapped tilt and rotate ===\n");
+
+    sim_fixture_init(&cfg);
+
+    test_overlap_times();
+    test_interlock();
+    test_pause_resume();
+
+    printf("=== All overlap tests passed ===\n");
+    return 0;
+}
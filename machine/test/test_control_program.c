@@ -0,0 +1,269 @@
+/**
+ * @file test_control_program.c
+ * @brief Session programs: compiler, back-to-back execution, pause in a
+ *        dwell, pre-validation of the next step, queued start.
+ *
+ * Execution runs on the "sim" backend in virtual time.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+
+#include "sim_fixture.h"
+#include "control_cmd.h"
+#include "control_program.h"
+#include "control_status.h"
+
+static const char *g_text =
+    "# two passes at 10 degrees\n"
+    "tilt 10\n"
+    "repeat 2\n"
+    "    rotate cw 30; dwell 200\n"
+    "    rotate cw 0            # dropped\n"
+    "end\n"
+    "tilt 0\n";
+
+static void tick(void)
+{
+    Control_Tick();
+    TimeSource_SleepMs(1);
+}
+
+static void test_compile(void)
+{
+    ControlProgram_t prog;
+    const ProgramStep_t nested[] = {
+        { PROGRAM_OP_REPEAT, 3, 0 },
+        { PROGRAM_OP_REPEAT, 4, 0 },
+        { PROGRAM_OP_DWELL, 10, 0 },
+        { PROGRAM_OP_END, 0, 0 },
+        { PROGRAM_OP_ROTATE, 90, ROTATE_DIR_CCW },
+        { PROGRAM_OP_END, 0, 0 },
+    };
+    const ProgramStep_t huge[] = {
+        { PROGRAM_OP_REPEAT, 1000, 0 },
+        { PROGRAM_OP_DWELL, 10, 0 },
+        { PROGRAM_OP_END, 0, 0 },
+    };
+
+    printf("=== test_compile() ===\n");
+
+    /* tilt, 2 x (rotate, dwell), tilt */
+    assert(ControlProgram_Parse(g_text, &prog) == 6);
+    assert(prog.steps[0].op == PROGRAM_OP_TILT && prog.steps[0].value == 10);
+    assert(prog.steps[1].op == PROGRAM_OP_ROTATE && prog.steps[1].dir == ROTATE_DIR_CW);
+    assert(prog.steps[4].op == PROGRAM_OP_DWELL && prog.steps[4].value == 200);
+    assert(prog.steps[5].op == PROGRAM_OP_TILT && prog.steps[5].value == 0);
+
+    /* 3 x (4 dwells, rotate) */
+    assert(ControlProgram_Compile(nested, 6, &prog) == 15);
+    assert(prog.steps[4].op == PROGRAM_OP_ROTATE && prog.steps[14].op == PROGRAM_OP_ROTATE);
+
+    /* Rejected once, up front */
+    assert(ControlProgram_Compile(huge, 3, &prog) == -1);
+    assert(ControlProgram_Compile(nested, 5, &prog) == -1);          /* repeat without end */
+    assert(ControlProgram_Parse("tilt 10; end", &prog) == -1);
+    assert(ControlProgram_Parse("tilt 91", &prog) == -1);
+    assert(ControlProgram_Parse("rotate left 90", &prog) == -1);
+    assert(ControlProgram_Parse("dwell 5x", &prog) == -1);
+    assert(ControlProgram_Parse("tilt 10 20", &prog) == -1);
+    assert(ControlProgram_Parse("dwell 0\n# nothing\n", &prog) == -1);
+    assert(ControlProgram_Parse("repeat 2; repeat 2; repeat 2; repeat 2; repeat 2;"
+                                "dwell 1; end; end; end; end; end", &prog) == -1);
+
+    printf("Compile OK.\n");
+}
+
+static void test_run(void)
+{
+    ControlProgram_t prog;
+    ControlStatus_t st;
+    int last_step = 0, total;
+    uint64_t t0, elapsed;
+
+    printf("=== test_run() ===\n");
+
+    sim_fixture_control_init(1);
+    assert(ControlProgram_Parse(g_text, &prog) == 6);
+    assert(Control_GetProgramStep(NULL) == 0);
+
+    t0 = TimeSource_NowMs();
+    assert(Control_StartProgram(&prog) == 0);
+
+    /* RUNNING on every tick until the last step: no idle tick between steps */
+    while (Control_GetStatus() == MACHINE_STATUS_RUNNING) {
+        int step = Control_GetProgramStep(&total);
+
+        assert(total == 6);
+        assert(step >= last_step && step <= last_step + 1);
+        last_step = step;
+        tick();
+    }
+    elapsed = TimeSource_NowMs() - t0;
+
+    assert(Control_GetStatus() == MACHINE_STATUS_DONE);
+    assert(Control_GetProgramStep(NULL) == 6);
+    assert(ControlStatus_Read(&st) == 0);
+    assert(st.phase == CONTROL_PHASE_DONE);
+    assert(st.program_step == 6 && st.program_steps == 6);
+    assert(st.rotate_degree > 59.0f && st.rotate_degree < 61.0f);
+    assert(st.tilt_degree < 3.0f);
+
+    printf("Program of %d steps done in %llu ms, rotate %.2f deg\n", total,
+           (unsigned long long)elapsed, st.rotate_degree);
+    printf("Run OK.\n");
+}
+
+static void test_pause_in_dwell(void)
+{
+    ControlProgram_t prog;
+    uint64_t t0, elapsed;
+
+    printf("=== test_pause_in_dwell() ===\n");
+
+    sim_fixture_control_init(1);
+    assert(ControlProgram_Parse("dwell 1000", &prog) == 1);
+
+    t0 = TimeSource_NowMs();
+    assert(Control_StartProgram(&prog) == 0);
+    for (int i = 0; i < 400; i++)
+        tick();
+
+    assert(Control_PauseSession() == 0);
+    TimeSource_SleepMs(5000);
+    Control_Tick();
+    assert(Control_GetStatus() == MACHINE_STATUS_PAUSED);
+
+    assert(Control_ResumeSession() == 0);
+    sim_fixture_run();
+    elapsed = TimeSource_NowMs() - t0;
+
+    /* 1000 ms of dwell plus the 5 s paused */
+    assert(Control_GetStatus() == MACHINE_STATUS_DONE);
+    assert(elapsed >= 6000 && elapsed < 6100);
+
+    printf("Pause in dwell OK (%llu ms).\n", (unsigned long long)elapsed);
+}
+
+static void test_prevalidate(void)
+{
+    ControlProgram_t prog;
+
+    printf("=== test_prevalidate() ===\n");
+
+    /* 80 compiles (0-90) but is past the calibrated 75 degree limit */
+    sim_fixture_control_init(1);
+    assert(ControlProgram_Parse("tilt 10; tilt 80", &prog) == 2);
+    assert(Control_StartProgram(&prog) == 0);
+
+    /* The first step runs, the second never begins */
+    sim_fixture_run();
+    assert(Control_GetStatus() == MACHINE_STATUS_FAULT);
+    assert(Control_GetFault() == CONTROL_FAULT_SESSION);
+    assert(Control_GetProgramStep(NULL) == 2);
+    assert(ControlTilt_ReadDegree() < 20.0f);
+
+    /* Rejected before anything moves */
+    sim_fixture_control_init(1);
+    assert(ControlProgram_Parse("tilt 80", &prog) == 1);
+    assert(Control_StartProgram(&prog) == -1);
+    assert(Control_GetFault() == CONTROL_FAULT_SESSION);
+
+    printf("Pre-validation OK.\n");
+}
+
+/* Clock and published program_ms hold still over a long wait */
+static void assert_clock_stopped(void)
+{
+    ControlStatus_t st;
+    uint64_t ms = Control_GetProgramMs();
+
+    TimeSource_SleepMs(60000);
+    tick();
+    assert(Control_GetProgramMs() == ms);
+    assert(ControlStatus_Read(&st) == 0 && st.program_ms == ms);
+}
+
+static void test_stop_clock(void)
+{
+    ControlProgram_t prog;
+    uint64_t t_end;
+
+    printf("=== test_stop_clock() ===\n");
+
+    /* A step that faults ends the program */
+    sim_fixture_control_init(1);
+    assert(ControlProgram_Parse("tilt 60; rotate cw 30", &prog) == 2);
+    assert(Control_StartProgram(&prog) == 0);
+    t_end = TimeSource_NowMs() + 1000;
+    while (TimeSource_NowMs() < t_end)
+        tick();
+
+    sim_plant_set_tilt_jam(1);
+    sim_fixture_run();
+    assert(Control_GetStatus() == MACHINE_STATUS_FAULT);
+    assert(Control_GetFault() == CONTROL_FAULT_TILT);
+    printf("Tilt fault after %llu ms\n", (unsigned long long)Control_GetProgramMs());
+    assert_clock_stopped();
+    sim_plant_set_tilt_jam(0);
+
+    /* So does ESTOP */
+    sim_fixture_control_init(1);
+    assert(ControlProgram_Parse("dwell 10000", &prog) == 1);
+    assert(Control_StartProgram(&prog) == 0);
+    t_end = TimeSource_NowMs() + 500;
+    while (TimeSource_NowMs() < t_end)
+        tick();
+
+    sim_plant_set_estop(1);
+    tick();
+    assert(Control_GetStatus() == MACHINE_STATUS_ESTOP);
+    printf("ESTOP after %llu ms\n", (unsigned long long)Control_GetProgramMs());
+    assert(Control_GetProgramMs() >= 500 && Control_GetProgramMs() < 600);
+    assert_clock_stopped();
+    sim_plant_set_estop(0);
+
+    printf("Stop clock OK.\n");
+}
+
+static void test_queued(void)
+{
+    ControlProgram_t prog;
+    ControlCmd_t cmd = { .type = CONTROL_CMD_PROGRAM, .program = &prog };
+    uint64_t seq;
+    int result = -1;
+
+    printf("=== test_queued() ===\n");
+
+    sim_fixture_control_init(1);
+    assert(ControlProgram_Parse("tilt 5; rotate ccw 20", &prog) == 2);
+
+    seq = ControlCmd_Submit(&cmd);
+    assert(seq > 0);
+    tick();
+    assert(ControlCmd_Poll(seq, &result) == 1 && result == 0);
+
+    sim_fixture_run();
+    assert(Control_GetStatus() == MACHINE_STATUS_DONE);
+
+    printf("Queued OK.\n");
+}
+
+int main(void)
+{
+    SimPlantConfig_t cfg;
+
+    printf("=== Test: session programs ===\n");
+
+    sim_fixture_init(&cfg);
+
+    test_compile();
+    test_run();
+    test_pause_in_dwell();
+    test_prevalidate();
+    test_stop_clock();
+    test_queued();
+
+    printf("=== All session program tests passed ===\n");
+    return 0;
+}
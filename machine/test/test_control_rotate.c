@@ -20,13 +20,13 @@
 
 #include <stdio.h>
 #include <time.h>
-#include <unistd.h>
 
 #include "mio.h"
 #include "ro.h"
 #include "motion.h"
 #include "machine_state.h"
 #include "control_rotate.h"
+#include "time_source.h"
 
 /* -------------------------------------------------------------------------
  * Helper: Print timestamp, state, and HOME sensor info
@@ -70,7 +70,7 @@ static void PrintStatus(const char *label)
 static void WaitSeconds(int seconds, const char *label)
 {
     for (int i = 0; i < seconds; i++) {
-        sleep(1);
+        TimeSource_SleepMs(1000);
         PrintStatus(label);
     }
 }
@@ -89,7 +89,7 @@ static void WaitForHomeActive(const char *label)
         int home = ReadHomeRotate();
         PrintStatus(label);
         if (home == 1) break;
-        sleep(1);
+        TimeSource_SleepMs(1000);
     }
 }
 
@@ -112,7 +112,7 @@ static int RunRotateHome(int tick_ms)
         if (r == ROTATE_OK) return 0;
         if (r == ROTATE_STOPPED || r == ROTATE_ERROR) return -1;
 
-        usleep(tick_ms * 1000);
+        TimeSource_SleepMs(tick_ms);
     }
 }
 
@@ -136,7 +136,7 @@ static int RunRotateOne(RotateDirection_t dir, int tick_ms)
         if (r == ROTATE_OK) return 0;
         if (r == ROTATE_STOPPED || r == ROTATE_ERROR) return -1;
 
-        usleep(tick_ms * 1000);
+        TimeSource_SleepMs(tick_ms);
     }
 }
 
@@ -162,7 +162,7 @@ static int RunRotateMoveToDegree(RotateDirection_t dir, float degrees,
         if (r == ROTATE_OK) return 0;
         if (r == ROTATE_STOPPED || r == ROTATE_ERROR) return -1;
 
-        usleep(tick_ms * 1000);
+        TimeSource_SleepMs(tick_ms);
     }
 }
 
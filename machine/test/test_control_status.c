@@ -0,0 +1,170 @@
+/**
+ * @file test_control_status.c
+ * @brief Status snapshot: contents after control ticks, torn-read freedom
+ *        under a concurrent reader, and the shared memory block.
+ *
+ * The control part runs on the "sim" backend in virtual time; the
+ * concurrency part publishes from the main thread in real time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "sim_fixture.h"
+#include "control_status.h"
+
+#define PUBLISHES  200000
+
+static volatile int g_stop = 0;
+static uint64_t     g_reads = 0;
+
+/* Every field derived from publish_count, so a torn copy is detectable */
+static void fill(ControlStatus_t *st, uint64_t n)
+{
+    st->publish_count       = n;
+    st->t_us                = n * 3;
+    st->status              = (MachineStatus_t)(n % 6);
+    st->phase               = (ControlPhase_t)(n % 6);
+    st->fault               = (ControlFault_t)(n % 8);
+    st->estop_latched       = (int)(n & 1);
+    st->outputs_forced      = (int)(n & 1);
+    st->tilt_volts          = (float)(n % 1000);
+    st->tilt_degree         = (float)(n % 1000);
+    st->rotate_degree       = (float)(n % 1000);
+    st->session.tilt_degree = (int)(n % 90);
+    st->session.rotate_dir  = ROTATE_DIR_CW;
+    st->session.rotate_num  = (int)(n % 90);
+    st->last_cmd            = n;
+}
+
+static void *reader(void *arg)
+{
+    const ControlStatusBlock_t *blk = arg;
+    ControlStatus_t st, ref;
+    uint64_t last = 0;
+
+    while (!g_stop) {
+        if (ControlStatus_ReadBlock(blk, &st) != 0)
+            continue;
+
+        fill(&ref, st.publish_count);
+        assert(st.t_us == ref.t_us && st.last_cmd == ref.last_cmd);
+        assert(st.tilt_volts == ref.tilt_volts && st.rotate_degree == ref.rotate_degree);
+        assert(st.session.rotate_num == ref.session.rotate_num);
+        assert(st.publish_count >= last);   /* never goes back */
+        last = st.publish_count;
+        g_reads++;
+    }
+    return NULL;
+}
+
+static void test_concurrent(const char *shm)
+{
+    const ControlStatusBlock_t *blk;
+    ControlStatus_t st;
+    pthread_t th;
+
+    printf("=== test_concurrent() ===\n");
+
+    assert(ControlStatus_Share(shm) == 0);
+    blk = ControlStatus_Attach(shm);
+    assert(blk != NULL);
+
+    /* The attached block already holds the last local snapshot */
+    assert(ControlStatus_ReadBlock(blk, &st) == 0);
+    assert(st.status == MACHINE_STATUS_DONE);
+
+    assert(pthread_create(&th, NULL, reader, (void *)blk) == 0);
+
+    for (uint64_t n = 1; n <= PUBLISHES; n++) {
+        fill(&st, n);
+        ControlStatus_Publish(&st);
+        if (n % 1000 == 0)
+            sched_yield();
+    }
+
+    g_stop = 1;
+    pthread_join(th, NULL);
+
+    assert(ControlStatus_Read(&st) == 0 && st.publish_count == PUBLISHES);
+    printf("%d publishes, %llu consistent reads through %s\n", PUBLISHES,
+           (unsigned long long)g_reads, shm);
+
+    ControlStatus_Detach(blk);
+    shm_unlink(shm);
+    printf("Concurrent OK.\n");
+}
+
+static void test_control(void)
+{
+    SessionConfig_t cfg = { .tilt_degree = 10, .rotate_dir = ROTATE_DIR_CW, .rotate_num = 30 };
+    SimPlantConfig_t plant;
+    ControlStatus_t st;
+    uint64_t count;
+
+    printf("=== test_control() ===\n");
+
+    sim_fixture_init(&plant);
+    sim_fixture_control_init(1);
+
+    assert(ControlStatus_Read(&st) == 0);
+    assert(st.status == MACHINE_STATUS_READY && st.phase == CONTROL_PHASE_IDLE);
+    assert(st.fault == CONTROL_FAULT_NONE);
+    assert(st.tilt_volts >= 0.0f && st.tilt_volts < 1.0f);
+    count = st.publish_count;
+    assert(count > 0);
+
+    assert(Control_StartSession(&cfg) == 0);
+    Control_Tick();
+    assert(ControlStatus_Read(&st) == 0);
+    assert(st.publish_count == count + 1);
+    assert(st.status == MACHINE_STATUS_RUNNING && st.phase == CONTROL_PHASE_TILT);
+    assert(st.session.tilt_degree == 10 && st.session.rotate_num == 30);
+
+    sim_fixture_run();
+    assert(ControlStatus_Read(&st) == 0);
+    assert(st.status == MACHINE_STATUS_DONE && st.phase == CONTROL_PHASE_DONE);
+    printf("Session done: tilt %.2f V / %.2f deg, rotate %.2f deg\n",
+           st.tilt_volts, st.tilt_degree, st.rotate_degree);
+    assert(st.rotate_degree > 29.0f && st.rotate_degree < 31.0f);
+
+    /* A fault carries its reason */
+    assert(Control_PauseSession() == -1);
+    Control_Tick();
+    assert(ControlStatus_Read(&st) == 0);
+    assert(st.status == MACHINE_STATUS_FAULT && st.fault == CONTROL_FAULT_STATE);
+
+    Control_Init();
+    Control_Tick();
+    assert(ControlStatus_Read(&st) == 0);
+    assert(st.status == MACHINE_STATUS_READY && st.fault == CONTROL_FAULT_NONE);
+
+    printf("Control OK.\n");
+}
+
+int main(void)
+{
+    char shm[64];
+
+    printf("=== Test: status snapshot ===\n");
+
+    test_control();
+
+    /* Leave a DONE snapshot for the shared block to start from */
+    {
+        ControlStatus_t st = { .status = MACHINE_STATUS_DONE };
+        ControlStatus_Publish(&st);
+    }
+
+    TimeSource_UseVirtual(0);
+    snprintf(shm, sizeof(shm), "/test_control_status_%d", (int)getpid());
+    test_concurrent(shm);
+
+    printf("=== All status snapshot tests passed ===\n");
+    return 0;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file test_control_stopband.c
+ * @brief Learned stop bands: update rule, bounds, save/load, and
+ *        convergence of the tilt engine on the plant model.
+ *
+ * The sim part moves back and forth between two angles in virtual time.
+ * With the static 0.2 V bands every move settles ~1 degree short; the
+ * learned bands should bring both directions onto target within a few
+ * moves.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "sim_fixture.h"
+#include "control_stopband.h"
+
+#define CYCLES  6
+
+static void test_learn(void)
+{
+    unsigned moves;
+
+    printf("=== test_learn() ===\n");
+
+    ControlStopBand_Reset();
+    assert(ControlStopBand_Bin(0.1f) == 0 && ControlStopBand_Bin(-0.1f) == 0);
+    assert(ControlStopBand_Bin(1.0f) == 1 && ControlStopBand_Bin(5.0f) == 2);
+    assert(ControlStopBand_Get(1, 3.0f, 0.2f) == 0.2f);
+
+    /* Undershoot by 0.1 V: the long-travel OUT band shrinks by half of it */
+    assert(ControlStopBand_Learn(1, 3.0f, -0.1f) == 0);
+    assert(fabsf(ControlStopBand_Get(1, 3.0f, 0.2f) - 0.15f) < 1e-6f);
+    assert(fabsf(ControlStopBand_Offset(1, 2, &moves) + 0.05f) < 1e-6f && moves == 1);
+
+    /* Other direction and bins untouched */
+    assert(ControlStopBand_Get(0, 3.0f, 0.2f) == 0.2f);
+    assert(ControlStopBand_Get(1, 1.0f, 0.2f) == 0.2f);
+
+    /* Disturbances are ignored, bands and offsets stay bounded */
+    assert(ControlStopBand_Learn(1, 3.0f, 0.8f) == -1);
+    for (int i = 0; i < 20; i++)
+        assert(ControlStopBand_Learn(0, 0.2f, -0.5f) == 0);
+    assert(ControlStopBand_Offset(0, 0, NULL) == -CONTROL_STOPBAND_MAX_OFFSET_V);
+    assert(ControlStopBand_Get(0, 0.2f, 0.2f) == 0.0f);
+    for (int i = 0; i < 20; i++)
+        assert(ControlStopBand_Learn(0, 0.2f, 0.5f) == 0);
+    assert(ControlStopBand_Get(0, 0.2f, 0.8f) == CONTROL_STOPBAND_MAX_V);
+
+    printf("Learn OK.\n");
+}
+
+static void test_persist(void)
+{
+    char path[] = "/tmp/test_stopband_XXXXXX";
+    float out2, in0;
+    unsigned moves;
+    int fd;
+
+    printf("=== test_persist() ===\n");
+
+    fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+
+    out2 = ControlStopBand_Offset(1, 2, NULL);
+    in0  = ControlStopBand_Offset(0, 0, NULL);
+    assert(ControlStopBand_Save(path) == 0);
+
+    ControlStopBand_Reset();
+    assert(ControlStopBand_Offset(1, 2, NULL) == 0.0f);
+
+    assert(ControlStopBand_Load(path) == 0);
+    assert(fabsf(ControlStopBand_Offset(1, 2, &moves) - out2) < 1e-4f && moves == 1);
+    assert(fabsf(ControlStopBand_Offset(0, 0, &moves) - in0) < 1e-4f && moves == 40);
+
+    remove(path);
+    assert(ControlStopBand_Load(path) == -1);
+    ControlStopBand_Reset();
+
+    printf("Persist OK.\n");
+}
+
+static float settled_degree(void)
+{
+    return ControlTilt_VoltToTilt(sim_fixture_settle());
+}
+
+static float move(float degree)
+{
+    TiltResult_t r = ControlTilt_BeginMoveToDegree(degree);
+
+    assert(r == TILT_RUNNING);
+    while ((r = ControlTilt_Service(NULL)) == TILT_RUNNING)
+        TimeSource_SleepMs(10);
+    assert(r == TILT_OK);
+
+    return settled_degree() - degree;
+}
+
+static void test_sim(void)
+{
+    SimPlantConfig_t cfg;
+    float err_out[CYCLES], err_in[CYCLES];
+    unsigned moves;
+
+    printf("=== test_sim() ===\n");
+
+    sim_fixture_init(&cfg);
+    ControlStopBand_Reset();
+    assert(ControlTilt_Home() == 0);
+
+    for (int i = 0; i < CYCLES; i++) {
+        err_out[i] = move(30.0f);
+        err_in[i]  = move(10.0f);
+        printf("  cycle %d: OUT %+.2f deg, IN %+.2f deg\n", i, err_out[i], err_in[i]);
+    }
+
+    /* Learned from every move but the last, which is still pending */
+    assert(ControlStopBand_Offset(1, 2, &moves) < 0.0f && moves == CYCLES);
+    assert(ControlStopBand_Offset(0, 2, &moves) < 0.0f && moves == CYCLES - 1);
+
+    assert(fabsf(err_out[0]) > 0.5f && fabsf(err_in[0]) > 0.5f);
+    assert(fabsf(err_out[CYCLES - 1]) < 0.3f && fabsf(err_in[CYCLES - 1]) < 0.3f);
+
+    printf("Sim OK.\n");
+}
+
+int main(void)
+{
+    printf("=== Test: learned stop bands ===\n");
+
+    test_learn();
+    test_persist();
+    test_sim();
+
+    printf("=== All stop band tests passed ===\n");
+    return 0;
+}
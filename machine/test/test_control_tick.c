@@ -0,0 +1,130 @@
+/**
+ * @file test_control_tick.c
+ * @brief Per-tick context: one tilt sample and one timestamp per tick,
+ *        shared by Control_Tick(), the engines and the executive tasks.
+ *
+ * Runs on the "sim" backend in virtual time. The sim ADC is noisy, so two
+ * live reads of the tilt position almost never agree; reads served from
+ * one context always do.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+
+#include "sim_fixture.h"
+#include "control_status.h"
+#include "control_tick.h"
+#include "executive.h"
+
+static int      g_task_runs = 0;
+static uint64_t g_task_t_us = 0;
+
+static void test_context(void)
+{
+    ControlTick_t tick;
+    float volt = 0.0f;
+    int adc;
+
+    printf("=== test_context() ===\n");
+
+    assert(ControlTick_Now() == NULL);
+
+    ControlTick_Begin(&tick, 7);
+    assert(ControlTick_Now() == &tick);
+    assert(tick.count == 7 && !tick.paced);
+
+    /* One sample for the whole tick, however late it is asked for */
+    adc = ControlTick_TiltAdc(&tick);
+    assert(adc > 0);
+    TimeSource_SleepMs(50);
+    assert(ControlTick_TiltAdc(&tick) == adc);
+    assert(ControlTilt_ReadVolt() == adc / 1000.0f);
+
+    /* The plain service call joins the open tick */
+    assert(ControlTilt_Service(&volt) == TILT_OK);
+    assert(volt == adc / 1000.0f);
+    assert(ControlTick_Ms(&tick) == tick.t_us / 1000ULL);
+
+    ControlTick_End(&tick);
+    assert(ControlTick_Now() == NULL);
+
+    printf("Context OK.\n");
+}
+
+static void test_control_tick(void)
+{
+    SessionConfig_t cfg = { .tilt_degree = 20, .rotate_dir = ROTATE_DIR_CW, .rotate_num = 10 };
+    ControlStatus_t st;
+    int ticks = 0;
+
+    printf("=== test_control_tick() ===\n");
+
+    sim_fixture_control_init(1);
+
+    assert(Control_StartSession(&cfg) == 0);
+    while (Control_GetStatus() == MACHINE_STATUS_RUNNING) {
+        Control_Tick();
+        assert(ControlTick_Now() == NULL);
+
+        /* Stamped with the scan, volts and degrees from the same sample */
+        assert(ControlStatus_Read(&st) == 0);
+        assert(st.t_us == hal_cycle().t_us);
+        assert(st.tilt_degree == ControlTilt_VoltToTilt(st.tilt_volts));
+
+        TimeSource_SleepMs(1);
+        ticks++;
+    }
+    assert(Control_GetStatus() == MACHINE_STATUS_DONE);
+    assert(st.tilt_degree > 17.0f && st.tilt_degree < 23.0f);
+
+    printf("Session done in %d ticks at %.2f deg\n", ticks, st.tilt_degree);
+    printf("Control tick OK.\n");
+}
+
+static void task(const ExecTick_t *exec)
+{
+    ControlTick_t tick;
+
+    ControlTick_Begin(&tick, exec->count);
+    assert(tick.paced);
+    assert(tick.t_us == exec->t_us);
+    assert(tick.count == exec->count);
+    ControlTick_End(&tick);
+
+    g_task_runs++;
+    g_task_t_us = exec->t_us;
+}
+
+static void test_executive(void)
+{
+    printf("=== test_executive() ===\n");
+
+    Exec_Init(1000);
+    assert(Exec_AddTask("check", 1000, 0, task) >= 0);
+
+    for (int i = 0; i < 10; i++) {
+        Exec_Tick();
+        assert(g_task_t_us == hal_cycle().t_us);
+        TimeSource_SleepMs(1);
+    }
+    assert(g_task_runs == 10);
+    assert(ControlTick_Now() == NULL);
+
+    printf("Executive OK.\n");
+}
+
+int main(void)
+{
+    SimPlantConfig_t cfg;
+
+    printf("=== Test: control tick context ===\n");
+
+    sim_fixture_init(&cfg);
+
+    test_context();
+    test_control_tick();
+    test_executive();
+
+    printf("=== All control tick tests passed ===\n");
+    return 0;
+}
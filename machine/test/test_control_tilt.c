@@ -54,7 +54,6 @@
  */
 
 #include <stdio.h>
-#include <unistd.h>
 #include <time.h>
 
 #include "mio.h"
@@ -62,6 +61,7 @@
 #include "motion.h"
 #include "machine_state.h"
 #include "control_tilt.h"
+#include "time_source.h"
 
 /* -------------------------------------------------------------------------
  * Helper: print timestamp, state, and position (volt + degree)
@@ -146,7 +146,7 @@ int main(void)
         if (r == TILT_OK) break;
         if (r == TILT_STOPPED || r == TILT_ERROR) break;
 
-        usleep(tick_ms * 1000);
+        TimeSource_SleepMs(tick_ms);
     }
 
     PrintStatus("Start at Home");
@@ -162,7 +162,7 @@ int main(void)
 
 	printf("\nSTEP 2-1: Waiting 5 seconds...\n");
     for (int i = 0; i < 5; i++) {
-        sleep(1);
+        TimeSource_SleepMs(1000);
         PrintStatus("Waiting");
     }
 
@@ -175,7 +175,7 @@ int main(void)
     g_machine.resume_requested = 0;
     g_machine.stop_requested   = 0;
 
-    time_t start = time(NULL);
+    uint64_t start = TimeSource_NowMs();
 
     r = ControlTilt_BeginMoveToVolt(7.0f);
     if (r == TILT_ERROR) {
@@ -188,7 +188,7 @@ int main(void)
 
         PrintStatus("Moving to 7V");
 
-        if (time(NULL) - start >= 2 && !g_machine.pause_requested) {
+        if (TimeSource_NowMs() - start >= 2000 && !g_machine.pause_requested) {
             printf("\nSTEP 3-1: Pause after 2 seconds\n");
             g_machine.pause_requested = 1;
         }
@@ -208,12 +208,12 @@ int main(void)
             break;
         }
 
-        usleep(tick_ms * 1000);
+        TimeSource_SleepMs(tick_ms);
     }
 
 	printf("\nSTEP 3-2: Waiting 5 seconds while paused...\n");
     for (int i = 0; i < 5; i++) {
-        sleep(1);
+        TimeSource_SleepMs(1000);
         PrintStatus("Paused wait");
     }
 
@@ -235,7 +235,7 @@ int main(void)
         if (r == TILT_OK) break;
         if (r == TILT_STOPPED || r == TILT_ERROR) break;
 
-        usleep(tick_ms * 1000);
+        TimeSource_SleepMs(tick_ms);
     }
 
     printf("\nSTEP 3-4: Movement complete\n");
@@ -250,14 +250,14 @@ int main(void)
 	printf("\nSTEP 4-1: Waiting 5 seconds...\n");
 	
     for (int i = 0; i < 5; i++) {
-        sleep(1);
+        TimeSource_SleepMs(1000);
         PrintStatus("Waiting");
     }
 
     g_machine.pause_requested  = 0;
     g_machine.resume_requested = 0;
 
-    start = time(NULL);
+    start = TimeSource_NowMs();
 
     r = ControlTilt_BeginHome();
     if (r == TILT_ERROR) {
@@ -270,7 +270,7 @@ int main(void)
 
         PrintStatus("Homing");
 
-        if (time(NULL) - start >= 2 && !g_machine.pause_requested) {
+        if (TimeSource_NowMs() - start >= 2000 && !g_machine.pause_requested) {
             printf("\nSTEP 4-2: Pause during homing\n");
             g_machine.pause_requested = 1;
         }
@@ -290,12 +290,12 @@ int main(void)
             break;
         }
 
-        usleep(tick_ms * 1000);
+        TimeSource_SleepMs(tick_ms);
     }
 
 	printf("\nSTEP 4-3: Waiting 5 seconds while paused (home)...\n");
     for (int i = 0; i < 5; i++) {
-        sleep(1);
+        TimeSource_SleepMs(1000);
         PrintStatus("Paused wait (home)");
     }
 
@@ -318,7 +318,7 @@ int main(void)
         if (r == TILT_OK) break;
         if (r == TILT_STOPPED || r == TILT_ERROR) break;
 
-        usleep(tick_ms * 1000);
+        TimeSource_SleepMs(tick_ms);
     }
 
     printf("\nSTEP 4-5: Homing complete\n");
@@ -1,6 +1,6 @@
 #include <stdio.h>
-#include <unistd.h>
 #include "../src/include/control.h"
+#include "../src/include/time_source.h"
 
 static void print_status(const char *label)
 {
@@ -47,7 +47,7 @@ int main(void)
     for (int i = 0; i < 10; i++) {
         Control_Tick();
         print_status("Tick");
-        usleep(100000);
+        TimeSource_SleepMs(100);
     }
 
     printf("\n-- Step 6: Pause/Resume Test --\n");
@@ -0,0 +1,300 @@
+/**
+ * @file test_piControl_readv.c
+ * @brief piControlReadV()/piControlWriteV(): segment sort, span merging,
+ *        the batch limit and the bytes transferred.
+ *
+ * The process image is a memfd handed to piControlIf as its open handle,
+ * so no device is needed. pread() and pwrite() are wrapped to record the
+ * spans the syscall backend issues; the mmap backend maps the same memfd.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "piControlIf.h"
+
+#define MAX_CALLS  16
+
+typedef struct
+{
+    uint32_t offset;
+    uint32_t length;
+} Span_t;
+
+static Span_t g_reads[MAX_CALLS];
+static Span_t g_writes[MAX_CALLS];
+static int    g_nreads;
+static int    g_nwrites;
+
+/* Recording wrappers; the library's pread/pwrite calls resolve here */
+ssize_t pread(int fd, void *buf, size_t count, off_t offset)
+{
+    if (g_nreads < MAX_CALLS)
+        g_reads[g_nreads] = (Span_t){ (uint32_t)offset, (uint32_t)count };
+    g_nreads++;
+    return syscall(SYS_pread64, fd, buf, count, offset);
+}
+
+ssize_t pwrite(int fd, const void *buf, size_t count, off_t offset)
+{
+    if (g_nwrites < MAX_CALLS)
+        g_writes[g_nwrites] = (Span_t){ (uint32_t)offset, (uint32_t)count };
+    g_nwrites++;
+    return syscall(SYS_pwrite64, fd, buf, count, offset);
+}
+
+static void clear_calls(void)
+{
+    g_nreads = 0;
+    g_nwrites = 0;
+}
+
+static void assert_span(const Span_t *s, uint32_t offset, uint32_t length)
+{
+    if (s->offset != offset || s->length != length)
+        printf("span [%u, +%u) expected [%u, +%u)\n",
+               s->offset, s->length, offset, length);
+    assert(s->offset == offset && s->length == length);
+}
+
+/* Image byte i = i & 0xff; fill = -1 keeps the pattern everywhere */
+static void fill_image(int fill)
+{
+    uint8_t img[PICONTROL_IMAGE_SIZE];
+
+    for (int i = 0; i < PICONTROL_IMAGE_SIZE; i++)
+        img[i] = fill < 0 ? (uint8_t)i : (uint8_t)fill;
+    assert(syscall(SYS_pwrite64, PiControlHandle_g, img, sizeof(img), 0) ==
+           (long)sizeof(img));
+}
+
+static uint8_t image_byte(uint32_t offset)
+{
+    uint8_t b;
+
+    assert(syscall(SYS_pread64, PiControlHandle_g, &b, 1, offset) == 1);
+    return b;
+}
+
+static void check_pattern(const SPISegment *seg, int count)
+{
+    for (int i = 0; i < count; i++)
+        for (uint32_t k = 0; k < seg[i].Length; k++)
+            assert(seg[i].pData[k] == (uint8_t)(seg[i].Offset + k));
+}
+
+static void test_read_merge(void)
+{
+    uint8_t a[4], b[2], c[2], d[2], e[2], f[4];
+    SPISegment seg[] = {
+        { 100, 4, a },
+        {  10, 2, b },
+        {  20, 2, c },   /* 8 bytes after b: same span */
+        {  54, 2, d },   /* exactly PICONTROL_READV_GAP after c: same span */
+        {  60, 2, e },   /* 4 bytes after d, but 38 before a */
+        { 104, 4, f },   /* adjacent to a */
+    };
+
+    printf("=== test_read_merge() ===\n");
+
+    fill_image(-1);
+    memset(a, 0, sizeof(a));
+    clear_calls();
+
+    assert(piControlReadV(seg, 6) == 16);
+    check_pattern(seg, 6);
+
+    /* Sorted: b c d e merge (gaps 8, 32, 4); a f merge; 38 between */
+    assert(g_nwrites == 0 && g_nreads == 2);
+    assert_span(&g_reads[0], 10, 52);
+    assert_span(&g_reads[1], 100, 8);
+
+    printf("Read merge OK.\n");
+}
+
+static void test_read_gap(void)
+{
+    uint8_t a[1], b[1];
+    SPISegment seg[] = {
+        { 0, 1, a },
+        { 1 + PICONTROL_READV_GAP + 1, 1, b },   /* one byte past the gap */
+    };
+
+    printf("=== test_read_gap() ===\n");
+
+    clear_calls();
+    assert(piControlReadV(seg, 2) == 2);
+    check_pattern(seg, 2);
+    assert(g_nreads == 2);
+    assert_span(&g_reads[0], 0, 1);
+    assert_span(&g_reads[1], 1 + PICONTROL_READV_GAP + 1, 1);
+
+    printf("Read gap OK.\n");
+}
+
+static void test_write_adjacent(void)
+{
+    uint8_t a[2] = { 1, 2 }, b[4] = { 3, 4, 5, 6 }, c[2] = { 7, 8 };
+    uint8_t d[1] = { 9 }, e[4] = { 10, 11, 12, 13 }, f[4] = { 14, 15, 16, 17 };
+    SPISegment seg[] = {
+        { 30, 2, a },
+        { 10, 4, b },
+        { 14, 2, c },    /* adjacent to b: same pwrite */
+        { 17, 1, d },    /* one byte gap: separate, byte 16 untouched */
+        { 42, 4, f },    /* overlaps e: separate, written after e */
+        { 40, 4, e },
+    };
+
+    printf("=== test_write_adjacent() ===\n");
+
+    fill_image(0xAA);
+    clear_calls();
+
+    assert(piControlWriteV(seg, 6) == 17);
+
+    assert(g_nreads == 0 && g_nwrites == 5);
+    assert_span(&g_writes[0], 10, 6);
+    assert_span(&g_writes[1], 17, 1);
+    assert_span(&g_writes[2], 30, 2);
+    assert_span(&g_writes[3], 40, 4);
+    assert_span(&g_writes[4], 42, 4);
+
+    for (uint32_t k = 0; k < 6; k++)
+        assert(image_byte(10 + k) == 3 + k);
+    assert(image_byte(16) == 0xAA && image_byte(17) == 9);
+    assert(image_byte(18) == 0xAA && image_byte(29) == 0xAA);
+    assert(image_byte(30) == 1 && image_byte(31) == 2);
+    assert(image_byte(40) == 10 && image_byte(41) == 11);
+    for (uint32_t k = 0; k < 4; k++)
+        assert(image_byte(42 + k) == 14 + k);
+
+    printf("Write adjacent OK.\n");
+}
+
+static void test_batch_limit(void)
+{
+    enum { N = PICONTROL_MAX_SEGMENTS + 6 };
+    SPISegment seg[N];
+    uint8_t buf[N];
+
+    printf("=== test_batch_limit() ===\n");
+
+    fill_image(-1);
+    memset(buf, 0, sizeof(buf));
+    for (int i = 0; i < N; i++)
+        seg[i] = (SPISegment){ (uint32_t)(200 + i), 1, &buf[i] };
+
+    /* Contiguous, but merged only within each batch of 64 */
+    clear_calls();
+    assert(piControlReadV(seg, N) == N);
+    check_pattern(seg, N);
+    assert(g_nreads == 2);
+    assert_span(&g_reads[0], 200, PICONTROL_MAX_SEGMENTS);
+    assert_span(&g_reads[1], 200 + PICONTROL_MAX_SEGMENTS, N - PICONTROL_MAX_SEGMENTS);
+
+    for (int i = 0; i < N; i++)
+        buf[i] = (uint8_t)~i;
+    clear_calls();
+    assert(piControlWriteV(seg, N) == N);
+    assert(g_nwrites == 2);
+    assert_span(&g_writes[0], 200, PICONTROL_MAX_SEGMENTS);
+    assert_span(&g_writes[1], 200 + PICONTROL_MAX_SEGMENTS, N - PICONTROL_MAX_SEGMENTS);
+    for (int i = 0; i < N; i++)
+        assert(image_byte(200 + i) == (uint8_t)~i);
+
+    printf("Batch limit OK.\n");
+}
+
+static void test_range(void)
+{
+    uint8_t buf[4];
+    SPISegment seg[] = {
+        { 0, 1, buf },
+        { PICONTROL_IMAGE_SIZE - 2, 4, buf },
+    };
+
+    printf("=== test_range() ===\n");
+
+    clear_calls();
+    assert(piControlReadV(&seg[1], 1) == -1);
+    assert(piControlWriteV(&seg[1], 1) == -1);
+    assert(g_nreads == 0 && g_nwrites == 0);
+
+    /* The in-range span before it is already done */
+    assert(piControlReadV(seg, 2) == -1);
+    assert(g_nreads == 1);
+
+    assert(piControlReadV(seg, 0) == 0);
+
+    printf("Range OK.\n");
+}
+
+static void test_mmap(void)
+{
+    uint8_t a[4], b[2], c[2];
+    SPISegment rd[] = {
+        { 300, 4, a },
+        {  10, 2, b },
+        {  20, 2, c },
+    };
+    uint8_t w1[2] = { 1, 2 }, w2[2] = { 3, 4 };
+    SPISegment wr[] = {
+        { 52, 2, w2 },
+        { 50, 2, w1 },
+    };
+
+    printf("=== test_mmap() ===\n");
+
+    assert(piControlSetBackend(PICONTROL_BACKEND_MMAP) == 0);
+    assert(piControlGetBackend() == PICONTROL_BACKEND_MMAP);
+
+    fill_image(-1);
+    clear_calls();
+    assert(piControlReadV(rd, 3) == 8);
+    check_pattern(rd, 3);
+
+    fill_image(0xAA);
+    assert(piControlWriteV(wr, 2) == 4);
+    assert(image_byte(49) == 0xAA && image_byte(54) == 0xAA);
+    assert(image_byte(50) == 1 && image_byte(51) == 2);
+    assert(image_byte(52) == 3 && image_byte(53) == 4);
+
+    /* Served from the mapping */
+    assert(g_nreads == 0 && g_nwrites == 0);
+
+    rd[0].Offset = PICONTROL_IMAGE_SIZE - 3;
+    assert(piControlReadV(rd, 3) == -1);
+
+    assert(piControlSetBackend(PICONTROL_BACKEND_SYSCALL) == 0);
+    printf("Mmap OK.\n");
+}
+
+int main(void)
+{
+    int fd;
+
+    printf("=== Test: piControlReadV / piControlWriteV ===\n");
+
+    fd = memfd_create("piControl", 0);
+    assert(fd >= 0);
+    assert(ftruncate(fd, PICONTROL_IMAGE_SIZE) == 0);
+    PiControlHandle_g = fd;     /* piControlOpen() keeps an open handle */
+
+    assert(piControlSetBackend(PICONTROL_BACKEND_SYSCALL) == 0);
+
+    test_read_merge();
+    test_read_gap();
+    test_write_adjacent();
+    test_batch_limit();
+    test_range();
+    test_mmap();
+
+    piControlClose();
+    printf("=== All piControl readv tests passed ===\n");
+    return 0;
+}
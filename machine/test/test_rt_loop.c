@@ -0,0 +1,116 @@
+/**
+ * @file test_rt_loop.c
+ * @brief Fixed-period loop: drift, overrun accounting and virtual time.
+ *
+ * The drift check runs in real time without SCHED_FIFO, so the latency
+ * bounds are loose. The overrun accounting runs in virtual time. Run
+ * main with -f/-c/-m on the target to measure the real numbers.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+
+#include "rt_loop.h"
+#include "time_source.h"
+
+#define PERIOD_US  1000U
+#define TICKS      200
+
+static void test_real_time(void)
+{
+    RtLoop_t loop;
+    uint64_t t0, elapsed;
+
+    printf("=== test_real_time() ===\n");
+
+    RtLoop_Start(&loop, PERIOD_US);
+    t0 = loop.deadline_us;
+
+    for (int i = 0; i < TICKS; i++) {
+        RtLoop_Wait(&loop);
+        TimeSource_SleepUs(200);      /* tick work */
+        RtLoop_Done(&loop);
+    }
+
+    /* No drift: the next deadline is TICKS periods after start, plus one
+     * period per deadline a preempted tick skipped */
+    assert(loop.deadline_us ==
+           t0 + ((uint64_t)TICKS + loop.stats.missed) * PERIOD_US);
+
+    elapsed = TimeSource_NowUs() - t0;
+    RtLoop_PrintStats(&loop.stats);
+    printf("Elapsed %llu us for %d ticks\n", (unsigned long long)elapsed, TICKS);
+
+    assert(loop.stats.ticks == TICKS);
+    assert(elapsed >= (uint64_t)(TICKS - 1) * PERIOD_US);
+    assert(loop.stats.exec_max_us >= 200);
+    assert(RtLoop_LatencyPercentile(&loop.stats, 50.0) < PERIOD_US);
+
+    printf("Real time OK.\n");
+}
+
+static void test_overrun(void)
+{
+    RtLoop_t loop;
+    uint64_t t0;
+
+    printf("=== test_overrun() ===\n");
+
+    /* Virtual time: the overrun is exactly 3.5 periods, not a real sleep
+     * that may overshoot into a third missed deadline */
+    TimeSource_UseVirtual(1);
+    RtLoop_Start(&loop, PERIOD_US);
+    t0 = loop.deadline_us;
+
+    RtLoop_Wait(&loop);
+    TimeSource_SleepUs(3500);         /* 3.5 periods */
+    RtLoop_Done(&loop);
+
+    assert(loop.stats.overruns == 1);
+    assert(loop.stats.missed == 2);
+    assert(loop.deadline_us == t0 + 3 * PERIOD_US);   /* still on the grid */
+
+    RtLoop_Wait(&loop);
+    RtLoop_Done(&loop);
+    assert(loop.deadline_us == t0 + 4 * PERIOD_US);
+
+    RtLoop_PrintStats(&loop.stats);
+    TimeSource_UseVirtual(0);
+    printf("Overrun OK.\n");
+}
+
+static void test_virtual_time(void)
+{
+    RtLoop_t loop;
+
+    printf("=== test_virtual_time() ===\n");
+
+    TimeSource_UseVirtual(1);
+    RtLoop_Start(&loop, PERIOD_US);
+
+    for (int i = 0; i < 10000; i++) {
+        RtLoop_Wait(&loop);
+        TimeSource_SleepUs(100);
+        RtLoop_Done(&loop);
+    }
+
+    assert(loop.stats.ticks == 10000);
+    assert(loop.stats.lat_max_us == 0);
+    assert(loop.stats.overruns == 0);
+    assert(loop.stats.exec_max_us == 100);
+
+    TimeSource_UseVirtual(0);
+    printf("Virtual time OK.\n");
+}
+
+int main(void)
+{
+    printf("=== Test: real-time main loop ===\n");
+
+    test_real_time();
+    test_overrun();
+    test_virtual_time();
+
+    printf("=== All main loop tests passed ===\n");
+    return 0;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file test_safety.c
+ * @brief Safety thread: relays off on ESTOP, held off against the control
+ *        thread, latency accounting and reset.
+ *
+ * Runs on a bare "sim" image (HAL_SIM_PLANT=0) in real time without
+ * SCHED_FIFO, so the latency bound checked here is loose; run main with -f
+ * on the target for the real distribution.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#include "hal.h"
+#include "control.h"
+#include "safety.h"
+#include "mio_addr.h"
+#include "ro_addr.h"
+#include "time_source.h"
+
+#define TRIPS       20
+#define TIMEOUT_US  100000U
+
+static void set_estop(int pressed)
+{
+    /* Inverted input: 0 = pressed */
+    assert(hal_set_bit(DI4_OFFSET, DI4_BIT, !pressed) == 0);
+}
+
+static uint8_t relays(void)
+{
+    uint8_t ro = 0xFF;
+
+    assert(hal_read(RO1_OFFSET, 1, &ro) == 1);
+    return ro;
+}
+
+static void test_poll(void)
+{
+    uint8_t on = 0x0F;
+
+    printf("=== test_poll() ===\n");
+
+    set_estop(0);
+    assert(hal_write(RO1_OFFSET, 1, &on) == 1);
+    assert(Safety_Poll() == 0);
+    assert(relays() == 0x0F);
+
+    set_estop(1);
+    assert(Safety_Poll() == 1);
+    assert(relays() == 0x00);
+    assert(hal_forced());
+
+    /* Control thread writes are zeroed in the relay byte only */
+    assert(hal_write(RO1_OFFSET, 1, &on) == 1);
+    assert(relays() == 0x00);
+    assert(hal_set_bit(RO1_OFFSET, RO3_BIT, 1) == 0);
+    assert(relays() == 0x00);
+
+    /* The state machine latched ESTOP */
+    Control_Tick();
+    assert(Control_GetStatus() == MACHINE_STATUS_ESTOP);
+
+    /* No reset while still pressed */
+    assert(Safety_Reset() == -1);
+    assert(Safety_IsTripped());
+
+    set_estop(0);
+    assert(Safety_Reset() == 0);
+    assert(!Safety_IsTripped() && !hal_forced());
+    assert(hal_write(RO1_OFFSET, 1, &on) == 1);
+    assert(relays() == 0x0F);
+
+    Control_Init();
+    Control_Tick();
+    assert(Control_GetStatus() == MACHINE_STATUS_READY);
+
+    printf("Poll OK.\n");
+}
+
+static void test_init_release(void)
+{
+    uint8_t on = 0x0F;
+
+    printf("=== test_init_release() ===\n");
+
+    set_estop(1);
+    assert(Safety_Poll() == 1 && hal_forced());
+    Control_Tick();
+    assert(Control_GetStatus() == MACHINE_STATUS_ESTOP);
+
+    /* Still pressed: the latch and the force stay */
+    Control_Init();
+    Control_Tick();
+    assert(Control_GetStatus() == MACHINE_STATUS_ESTOP);
+    assert(Safety_IsTripped() && hal_forced());
+
+    /* Released: Control_Init() alone lets the relays switch again */
+    set_estop(0);
+    Control_Init();
+    Control_Tick();
+    assert(Control_GetStatus() == MACHINE_STATUS_READY);
+    assert(!Safety_IsTripped() && !hal_forced());
+    assert(hal_write(RO1_OFFSET, 1, &on) == 1);
+    assert(relays() == 0x0F);
+
+    printf("Init release OK.\n");
+}
+
+static void test_thread(void)
+{
+    RtLoopConfig_t cfg;
+    SafetyStats_t st;
+    uint8_t on = 0x0F;
+
+    printf("=== test_thread() ===\n");
+
+    Safety_ResetStats();
+    Safety_DefaultConfig(&cfg);
+    cfg.fifo_priority = 0;
+    assert(Safety_Start(&cfg) == 0);
+    assert(Safety_Start(&cfg) == -1);
+
+    for (int i = 0; i < TRIPS; i++) {
+        uint64_t t0;
+
+        set_estop(0);
+        assert(Safety_Reset() == 0);
+        Control_Init();
+        assert(hal_write(RO1_OFFSET, 1, &on) == 1);
+
+        /* Press at an arbitrary point of the poll period */
+        TimeSource_SleepUs(3000 + (uint64_t)(rand() % 1000));
+        assert(relays() == 0x0F);
+        t0 = TimeSource_NowUs();
+        set_estop(1);
+
+        while (!Safety_IsTripped() && TimeSource_NowUs() - t0 < TIMEOUT_US)
+            TimeSource_SleepUs(20);
+        assert(Safety_IsTripped());
+        assert(relays() == 0x00);
+
+        /* The control thread cannot switch them back on */
+        assert(hal_write(RO1_OFFSET, 1, &on) == 1);
+        assert(relays() == 0x00);
+    }
+
+    Safety_Stop();
+    Safety_GetStats(&st);
+    Safety_PrintStats(&st);
+
+    assert(st.trips == TRIPS);
+    assert(st.read_errors == 0 && st.write_errors == 0);
+    assert(st.polls >= TRIPS * 3);
+    assert(st.lat_min_us <= st.lat_max_us);
+    assert(st.lat_max_us < TIMEOUT_US);
+    assert(Safety_LatencyPercentile(&st, 50.0) < 10 * SAFETY_LATENCY_TARGET_US);
+
+    /* Still latched after the thread is gone */
+    assert(Safety_IsTripped());
+    set_estop(0);
+    assert(Safety_Reset() == 0);
+
+    printf("Thread OK.\n");
+}
+
+int main(void)
+{
+    printf("=== Test: safety thread ===\n");
+
+    setenv("HAL_SIM_PLANT", "0", 1);
+    assert(hal_select("sim") == 0);
+    assert(hal_init() == 0);
+
+    Control_Init();
+
+    test_poll();
+    test_init_release();
+    test_thread();
+
+    printf("=== All safety tests passed ===\n");
+    return 0;
+}
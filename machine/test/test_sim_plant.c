@@ -0,0 +1,149 @@
+/**
+ * @file test_sim_plant.c
+ * @brief Closed-loop test of the tilt and rotate engines against the plant model.
+ *
+ * Runs unmodified ControlTilt_* / ControlRotate_* code on the "sim" HAL
+ * backend (sim_plant.c), so it needs no RevPi:
+ *
+ *   1. Tilt home from 1.0 V
+ *   2. Tilt move to 10 degrees, check the settled position
+ *   3. Rotate home from 345 degrees
+ *   4. Rotate 30 degrees CW, check the settled angle
+ *   5. ESTOP press/release reaches ReadEStopButton()
+ *   6. Blocking wrappers in real time sleep between ticks instead of
+ *      spinning
+ *
+ * The settled positions include the simulated coast after relay-off, so
+ * the printed errors show how well the stop bands match the plant.
+ *
+ * Steps 1-5 run in virtual time (time_source.h), so the ~20 s of
+ * simulated motion completes in milliseconds; step 6 takes ~3 s of real
+ * time.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <math.h>
+#include <time.h>
+
+#include "sim_fixture.h"
+#include "ro.h"
+#include "control_rotate.h"
+
+static void test_tilt(void)
+{
+    printf("=== test_tilt() ===\n");
+
+    assert(ControlTilt_Home() == 0);
+    SimPlantState_t s = sim_plant_state();
+    printf("Homed at %.3f V\n", s.tilt_volts);
+    assert(ReadHomeTilt() == 1);
+
+    float actual = 0.0f;
+    TiltResult_t r = ControlTilt_MoveToDegree(10.0f, &actual);
+    assert(r == TILT_OK);
+
+    float deg = ControlTilt_VoltToTilt(sim_fixture_settle());
+    printf("Target 10.00 deg, stopped at %.2f deg, settled at %.2f deg (error %+.2f)\n",
+           actual, deg, deg - 10.0f);
+    assert(fabsf(deg - 10.0f) < 2.0f);
+
+    printf("Tilt OK.\n");
+}
+
+static void test_rotate(void)
+{
+    printf("=== test_rotate() ===\n");
+
+    assert(ControlRotate_Home() == 0);
+    sim_fixture_settle();
+    SimPlantState_t s = sim_plant_state();
+    printf("Homed at %+.2f deg\n", remainderf(s.rotate_deg, 360.0f));
+
+    float start = s.rotate_deg;
+    RotateResult_t r = ControlRotate_BeginRotate(ROTATE_DIR_CW, 30.0f);
+    assert(r == ROTATE_RUNNING);
+    while ((r = ControlRotate_Service()) == ROTATE_RUNNING)
+        TimeSource_SleepMs(1);
+    assert(r == ROTATE_OK);
+
+    sim_fixture_settle();
+    s = sim_plant_state();
+    printf("Target 30.00 deg, settled after %.2f deg (error %+.2f)\n",
+           s.rotate_deg - start, s.rotate_deg - start - 30.0f);
+    assert(fabsf(s.rotate_deg - start - 30.0f) < 3.0f);
+
+    printf("Rotate OK.\n");
+}
+
+static void test_estop(void)
+{
+    printf("=== test_estop() ===\n");
+
+    assert(ReadEStopButton() == 0);
+    sim_plant_set_estop(1);
+    assert(ReadEStopButton() == 1);
+    sim_plant_set_estop(0);
+    assert(ReadEStopButton() == 0);
+
+    printf("ESTOP OK.\n");
+}
+
+static uint64_t cpu_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static void test_blocking_real_time(const SimPlantConfig_t *base)
+{
+    SimPlantConfig_t cfg = *base;
+    uint64_t wall0, cpu0, wall, cpu;
+    float actual = 0.0f;
+
+    printf("=== test_blocking_real_time() ===\n");
+
+    /* 5 degrees of tilt and 10 degrees of rotate, ~3 s in real time */
+    TimeSource_UseVirtual(0);
+    cfg.tilt_start_volts = ControlTilt_TiltToVolt(10.0f);
+    cfg.rotate_start_deg = 350.0f;
+    sim_plant_reset(&cfg);
+
+    wall0 = TimeSource_NowUs();
+    cpu0  = cpu_us();
+
+    assert(ControlTilt_MoveToDegree(15.0f, &actual) == TILT_OK);
+    assert(ControlRotate_Home() == 0);
+
+    wall = TimeSource_NowUs() - wall0;
+    cpu  = cpu_us() - cpu0;
+    printf("Blocking moves took %.2f s, %.1f ms CPU (%.1f%%)\n",
+           wall / 1e6, cpu / 1e3, 100.0 * cpu / wall);
+
+    assert(wall > 2000000ULL);
+    assert(cpu * 10 < wall);
+
+    printf("Blocking real time OK.\n");
+}
+
+int main(void)
+{
+    SimPlantConfig_t cfg;
+
+    printf("=== Test: control engines on the plant simulator ===\n");
+
+    sim_fixture_init(&cfg);
+    cfg.rotate_start_deg = 345.0f;
+    sim_plant_reset(&cfg);
+    printf("HAL backend: %s\n", hal_backend_name());
+
+    test_tilt();
+    test_rotate();
+    test_estop();
+    test_blocking_real_time(&cfg);
+
+    printf("=== All plant simulator tests passed ===\n");
+    return 0;
+}
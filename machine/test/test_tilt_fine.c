@@ -0,0 +1,221 @@
+/**
+ * @file test_tilt_fine.c
+ * @brief Fine positioning: timed relay pulses after the bulk move, pulse
+ *        gain learning, short moves, and pause during a pulse.
+ *
+ * Runs on the "sim" backend in virtual time with the static 0.2 V stop
+ * bands (learning off), so every bulk move settles ~1 degree short and
+ * the pulses have to close the gap. Sessions are also run through the
+ * executive, where the 100 ms tilt task alone would stretch every pulse
+ * to the next task run.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <math.h>
+
+#include "sim_fixture.h"
+#include "ro.h"
+#include "control.h"
+#include "executive.h"
+
+#define TOLERANCE_V  0.02f
+#define WINDOW_V     0.3f
+
+static const float k_moves[] = { 10.0f, 30.0f, 45.0f, 20.0f, 5.0f, 40.0f };
+#define NUM_MOVES  ((int)(sizeof(k_moves) / sizeof(k_moves[0])))
+
+static TiltCalibration_t fine_cal(int fine)
+{
+    TiltCalibration_t cal = sim_fixture_tilt_cal();
+
+    cal.fine_window    = fine ? WINDOW_V : 0.0f;
+    cal.fine_tolerance = TOLERANCE_V;
+    return cal;
+}
+
+static void apply(int fine)
+{
+    TiltCalibration_t cal = fine_cal(fine);
+
+    ControlTilt_ApplyCalibration(&cal);
+}
+
+/* One move through the blocking wrapper; returns its duration */
+static uint64_t move(float degree)
+{
+    uint64_t t0 = TimeSource_NowMs();
+    float actual;
+
+    assert(ControlTilt_MoveToDegree(degree, &actual) == TILT_OK);
+    return TimeSource_NowMs() - t0;
+}
+
+static void test_moves(const SimPlantConfig_t *cfg)
+{
+    uint64_t ms_bulk = 0, ms_fine = 0;
+    float err_bulk = 0.0f, err_fine = 0.0f;
+
+    printf("=== test_moves() ===\n");
+
+    for (int fine = 0; fine <= 1; fine++) {
+        sim_plant_reset(cfg);
+        apply(fine);
+        assert(ControlTilt_Home() == 0);
+
+        for (int i = 0; i < NUM_MOVES; i++) {
+            float goal = ControlTilt_TiltToVolt(k_moves[i]);
+            uint64_t ms = move(k_moves[i]);
+            float err = fabsf(sim_fixture_settle() - goal);
+
+            printf("  %s %5.1f deg: %4llu ms, error %.3f V\n", fine ? "fine" : "bulk",
+                   k_moves[i], (unsigned long long)ms, err);
+            if (fine) {
+                ms_fine += ms;
+                if (err > err_fine) err_fine = err;
+            } else {
+                ms_bulk += ms;
+                if (err > err_bulk) err_bulk = err;
+            }
+        }
+    }
+
+    printf("Bulk: max error %.3f V in %llu ms; fine: max error %.3f V in %llu ms\n",
+           err_bulk, (unsigned long long)ms_bulk, err_fine, (unsigned long long)ms_fine);
+    printf("Pulse gain: OUT %.5f V/ms, IN %.5f V/ms\n",
+           ControlTilt_ReadPulseGain(1), ControlTilt_ReadPulseGain(0));
+
+    assert(err_bulk > 0.05f);
+    assert(err_fine < TOLERANCE_V + 0.005f);
+
+    /* Learned from the plant: ~0.7 mV per ms of pulse including the coast */
+    assert(ControlTilt_ReadPulseGain(1) > 0.0004f && ControlTilt_ReadPulseGain(1) < 0.001f);
+    assert(ControlTilt_ReadPulseGain(0) > 0.0004f && ControlTilt_ReadPulseGain(0) < 0.001f);
+
+    printf("Moves OK.\n");
+}
+
+/* Base ticks of the executive until the machine leaves RUNNING */
+static void exec_run(void)
+{
+    while (Control_GetStatus() == MACHINE_STATUS_RUNNING) {
+        Exec_Tick();
+        TimeSource_SleepMs(1);
+    }
+}
+
+static void test_executive(const SimPlantConfig_t *cfg)
+{
+    SessionConfig_t session = { .rotate_dir = ROTATE_DIR_CW, .rotate_num = 0 };
+    TiltCalibration_t cal = fine_cal(1);
+    float err_max = 0.0f;
+
+    printf("=== test_executive() ===\n");
+
+    sim_plant_reset(cfg);
+    Control_Init();
+    Control_CalibrateTilt();
+    Control_CalibrateRotate();
+
+    /* Bulk moves settle ~0.035 V short: pulses well under the 100 ms
+     * tilt task period */
+    cal.stop_band_in  = 0.13f;
+    cal.stop_band_out = 0.13f;
+    ControlTilt_ApplyCalibration(&cal);
+
+    Exec_Init(1000);
+    assert(Control_RegisterTasks() == 0);
+
+    for (int i = 0; i < NUM_MOVES; i++) {
+        float goal, err;
+
+        assert(Control_BeginHome() == 0);
+        exec_run();
+        assert(Control_GetStatus() == MACHINE_STATUS_READY);
+
+        session.tilt_degree = (int)k_moves[i];
+        goal = ControlTilt_TiltToVolt((float)session.tilt_degree);
+        assert(Control_StartSession(&session) == 0);
+        exec_run();
+        assert(Control_GetStatus() == MACHINE_STATUS_DONE);
+
+        err = fabsf(sim_fixture_settle() - goal);
+        printf("  exec %5.1f deg: error %.3f V\n", k_moves[i], err);
+        if (err > err_max) err_max = err;
+    }
+
+    printf("Executive: max error %.3f V, pulse gain OUT %.5f V/ms\n",
+           err_max, ControlTilt_ReadPulseGain(1));
+
+    /* Every session starts from home, so only OUT pulses are learned */
+    assert(err_max < TOLERANCE_V + 0.005f);
+    assert(ControlTilt_ReadPulseGain(1) > 0.0004f && ControlTilt_ReadPulseGain(1) < 0.001f);
+
+    printf("Executive OK.\n");
+}
+
+static void test_short_move(void)
+{
+    float from, goal;
+
+    printf("=== test_short_move() ===\n");
+
+    /* Inside the stop band: the bulk engine does not move at all */
+    from = sim_fixture_settle();
+    apply(0);
+    goal = from + 0.1f;
+    assert(ControlTilt_BeginMoveToVolt(goal) == TILT_OK);
+
+    /* Pulses alone get there */
+    apply(1);
+    assert(ControlTilt_MoveToVolt(goal, NULL) == TILT_OK);
+    printf("0.1 V move: error %.3f V\n", sim_fixture_settle() - goal);
+    assert(fabsf(sim_fixture_settle() - goal) < TOLERANCE_V + 0.005f);
+
+    printf("Short move OK.\n");
+}
+
+static void test_pause(void)
+{
+    float goal = sim_fixture_settle() - 0.2f;
+    TiltResult_t r;
+    int ticks = 0;
+
+    printf("=== test_pause() ===\n");
+
+    apply(1);
+    assert(ControlTilt_BeginMoveToVolt(goal) == TILT_RUNNING);
+
+    /* Service until the relay is on for a pulse, then pause */
+    while ((r = ControlTilt_Service(NULL)) == TILT_RUNNING && !ro_get_ro(RO_TILT_EN)) {
+        TimeSource_SleepMs(1);
+        assert(++ticks < 5000);
+    }
+    assert(r == TILT_RUNNING && ro_get_ro(RO_TILT_EN));
+
+    g_machine.pause_requested = 1;
+    assert(ControlTilt_Service(NULL) == TILT_PAUSED);
+    assert(!ro_get_ro(RO_TILT_EN));
+    assert(ControlTilt_Service(NULL) == TILT_OK);
+    g_machine.pause_requested = 0;
+
+    printf("Pause OK.\n");
+}
+
+int main(void)
+{
+    SimPlantConfig_t cfg;
+
+    printf("=== Test: tilt fine positioning ===\n");
+
+    sim_fixture_init(&cfg);
+
+    /* First, so the pulse gains are learned under the executive */
+    test_executive(&cfg);
+    test_moves(&cfg);
+    test_short_move();
+    test_pause();
+
+    printf("=== All tilt fine positioning tests passed ===\n");
+    return 0;
+}
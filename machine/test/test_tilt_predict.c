@@ -0,0 +1,126 @@
+/**
+ * @file test_tilt_predict.c
+ * @brief Tilt velocity estimate and predictive stop against the plant model.
+ *
+ * Runs the same sequence of tilt moves on the "sim" backend in virtual
+ * time, once with the fixed stop bands and once with stop_predict, and
+ * compares the settled positions. A move settled outside TOLERANCE_DEG
+ * would need a correction; with the predictive stop none should.
+ */
+
+#include <stdio.h>
+#include <assert.h>
+#include <math.h>
+
+#include "sim_fixture.h"
+
+#define TOLERANCE_DEG  0.5f
+
+static const float k_moves[] = { 10.0f, 30.0f, 45.0f, 20.0f, 5.0f, 60.0f, 40.0f, 12.0f };
+#define NUM_MOVES  ((int)(sizeof(k_moves) / sizeof(k_moves[0])))
+
+typedef struct
+{
+    float err_sum;          /* Sum of |settled error| (deg) */
+    float err_max;
+    int   missed;           /* Moves settled outside TOLERANCE_DEG */
+} Result_t;
+
+static void apply(int predict)
+{
+    TiltCalibration_t cal = sim_fixture_tilt_cal();
+
+    cal.stop_predict = predict;
+    ControlTilt_ApplyCalibration(&cal);
+}
+
+static float settled_degree(void)
+{
+    return ControlTilt_VoltToTilt(sim_fixture_settle());
+}
+
+static Result_t run(int predict, const SimPlantConfig_t *cfg)
+{
+    Result_t res = { 0.0f, 0.0f, 0 };
+
+    sim_plant_reset(cfg);
+    apply(predict);
+    assert(ControlTilt_Home() == 0);
+
+    for (int i = 0; i < NUM_MOVES; i++) {
+        TiltResult_t r = ControlTilt_BeginMoveToDegree(k_moves[i]);
+        float deg, err;
+
+        assert(r == TILT_RUNNING);
+        while ((r = ControlTilt_Service(NULL)) == TILT_RUNNING)
+            TimeSource_SleepMs(10);
+        assert(r == TILT_OK);
+
+        deg = settled_degree();
+        err = fabsf(deg - k_moves[i]);
+        res.err_sum += err;
+        if (err > res.err_max) res.err_max = err;
+        if (err > TOLERANCE_DEG) res.missed++;
+        printf("  %5.1f deg: settled at %6.2f\n", k_moves[i], deg);
+    }
+
+    printf("%s: mean error %.2f deg, max %.2f deg, %d of %d outside %.1f deg\n",
+           predict ? "Predict" : "Band", res.err_sum / NUM_MOVES, res.err_max,
+           res.missed, NUM_MOVES, TOLERANCE_DEG);
+    return res;
+}
+
+static void test_speed(const SimPlantConfig_t *cfg)
+{
+    SimPlantState_t s;
+
+    printf("=== test_speed() ===\n");
+
+    sim_plant_reset(cfg);
+    apply(1);
+    assert(ControlTilt_Home() == 0);
+
+    /* Well into a long move the estimate follows the plant */
+    assert(ControlTilt_BeginMoveToDegree(60.0f) == TILT_RUNNING);
+    for (int i = 0; i < 300; i++) {
+        assert(ControlTilt_Service(NULL) == TILT_RUNNING);
+        TimeSource_SleepMs(10);
+    }
+    s = sim_plant_state();
+    printf("Plant %.3f V/s, estimate %.3f V/s\n", s.tilt_velocity, ControlTilt_ReadSpeed());
+    assert(fabsf(ControlTilt_ReadSpeed() - s.tilt_velocity) < 0.02f);
+
+    ControlTilt_Pause();
+    printf("Speed OK.\n");
+}
+
+static void test_predict(const SimPlantConfig_t *cfg)
+{
+    Result_t band, predict;
+
+    printf("=== test_predict() ===\n");
+
+    band    = run(0, cfg);
+    predict = run(1, cfg);
+
+    assert(predict.missed == 0);
+    assert(predict.missed < band.missed);
+    assert(predict.err_sum < 0.5f * band.err_sum);
+
+    printf("Predict OK.\n");
+}
+
+int main(void)
+{
+    SimPlantConfig_t cfg;
+
+    printf("=== Test: tilt predictive stop ===\n");
+
+    sim_fixture_init(&cfg);
+
+    test_speed(&cfg);
+    test_predict(&cfg);
+
+    printf("=== All tilt predict tests passed ===\n");
+    return 0;
+}
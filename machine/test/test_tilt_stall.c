@@ -0,0 +1,158 @@
+/**
+ * @file test_tilt_stall.c
+ * @brief Velocity-based tilt stall detection against a jammed plant.
+ *
+ * Runs on the "sim" backend in virtual time and blocks the actuator with
+ * sim_plant_set_tilt_jam(): mid-move, before a move starts, and while
+ * homing. Each must trip within a few control periods (the old
+ * no-progress timeout took 2 s) and leave a stall event with the samples
+ * that led to it. Normal moves, including a reversal right after homing,
+ * must not trip.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+
+#include "sim_fixture.h"
+#include "ro.h"
+
+/* Service a move until it ends; returns the result, *t_end its time */
+static TiltResult_t run_move(uint64_t *t_end)
+{
+    TiltResult_t r;
+
+    while ((r = ControlTilt_Service(NULL)) == TILT_RUNNING)
+        TimeSource_SleepMs(1);
+    *t_end = TimeSource_NowMs();
+    return r;
+}
+
+static void print_event(const TiltStallEvent_t *ev)
+{
+    printf("Stall %s %s: %.3f V/s expected, min %.3f V/s, %d samples\n",
+           ev->homing ? "homing" : "move", ev->startup ? "at start-up" : "running",
+           ev->expected_speed, ev->min_speed, ev->count);
+    for (int i = ev->count > 5 ? ev->count - 5 : 0; i < ev->count; i++)
+        printf("  t=%llu adc=%d speed=%+.3f V/s\n",
+               (unsigned long long)ev->samples[i].t_ms, ev->samples[i].adc,
+               ev->samples[i].speed);
+}
+
+static void test_no_trip(void)
+{
+    float actual;
+
+    printf("=== test_no_trip() ===\n");
+
+    /* Homing, then straight out while still coasting in */
+    assert(ControlTilt_Home() == 0);
+    assert(ControlTilt_MoveToDegree(20.0f, &actual) == TILT_OK);
+    assert(ControlTilt_MoveToDegree(5.0f, &actual) == TILT_OK);
+    assert(ControlTilt_MoveToDegree(30.0f, &actual) == TILT_OK);
+    assert(ControlTilt_GetStallEvent(NULL) == 0);
+
+    printf("No trip OK.\n");
+}
+
+static void test_jam_running(void)
+{
+    TiltStallEvent_t ev;
+    uint64_t t_jam, t_end;
+    int n;
+
+    printf("=== test_jam_running() ===\n");
+
+    t_jam = TimeSource_NowMs() + 3000;
+    assert(ControlTilt_BeginMoveToDegree(60.0f) == TILT_RUNNING);
+    while (TimeSource_NowMs() < t_jam) {
+        assert(ControlTilt_Service(NULL) == TILT_RUNNING);
+        TimeSource_SleepMs(1);
+    }
+
+    sim_plant_set_tilt_jam(1);
+    t_jam = TimeSource_NowMs();
+    assert(run_move(&t_end) == TILT_ERROR);
+    printf("Tripped %llu ms after the jam\n", (unsigned long long)(t_end - t_jam));
+    assert(t_end - t_jam <= 400);
+    assert(!ro_get_ro(RO_TILT_EN));
+
+    n = ControlTilt_GetStallEvent(&ev);
+    assert(n == 1);
+    print_event(&ev);
+    assert(!ev.homing && ev.direction_up && !ev.startup);
+    assert(fabsf(ev.expected_speed - 0.22f) < 0.01f);
+    assert(ev.count == TILT_STALL_SAMPLES);
+    assert(ev.samples[ev.count - 1].t_ms == ev.t_ms);
+    assert(ev.samples[ev.count - 1].speed < ev.min_speed);
+    assert(abs(ev.samples[ev.count - 1].adc - ev.samples[ev.count - 3].adc) < 10);
+    assert(ev.samples[0].speed > ev.expected_speed * 0.8f);
+
+    sim_plant_set_tilt_jam(0);
+    printf("Jam running OK.\n");
+}
+
+static void test_jam_start(void)
+{
+    TiltStallEvent_t ev;
+    uint64_t t0, t_end;
+
+    printf("=== test_jam_start() ===\n");
+
+    sim_fixture_settle();
+    sim_plant_set_tilt_jam(1);
+
+    t0 = TimeSource_NowMs();
+    assert(ControlTilt_BeginMoveToDegree(10.0f) == TILT_RUNNING);
+    assert(run_move(&t_end) == TILT_ERROR);
+    printf("Tripped %llu ms after the start\n", (unsigned long long)(t_end - t0));
+    assert(t_end - t0 <= 500);
+
+    assert(ControlTilt_GetStallEvent(&ev) == 2);
+    print_event(&ev);
+    assert(!ev.homing && !ev.direction_up && ev.startup);
+
+    sim_plant_set_tilt_jam(0);
+    printf("Jam start OK.\n");
+}
+
+static void test_jam_homing(void)
+{
+    TiltStallEvent_t ev;
+    uint64_t t0;
+
+    printf("=== test_jam_homing() ===\n");
+
+    sim_fixture_settle();
+    sim_plant_set_tilt_jam(1);
+
+    t0 = TimeSource_NowMs();
+    assert(ControlTilt_Home() != 0);
+    printf("Homing tripped after %llu ms\n", (unsigned long long)(TimeSource_NowMs() - t0));
+    assert(TimeSource_NowMs() - t0 <= 500);
+
+    assert(ControlTilt_GetStallEvent(&ev) == 3);
+    assert(ev.homing && !ev.direction_up);
+
+    sim_plant_set_tilt_jam(0);
+    assert(ControlTilt_Home() == 0);
+    printf("Jam homing OK.\n");
+}
+
+int main(void)
+{
+    SimPlantConfig_t cfg;
+
+    printf("=== Test: tilt stall detection ===\n");
+
+    sim_fixture_init(&cfg);
+
+    test_no_trip();
+    test_jam_running();
+    test_jam_start();
+    test_jam_homing();
+
+    printf("=== All tilt stall tests passed ===\n");
+    return 0;
+}
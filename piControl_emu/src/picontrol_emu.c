@@ -0,0 +1,967 @@
+/**
+ * @file picontrol_emu.c
+ * @brief LD_PRELOAD emulator for the RevPi piControl device.
+ *
+ * Interposes open()/openat()/close()/ioctl() so that opening
+ * /dev/piControl0 returns a descriptor on an in-memory 4096-byte process
+ * image instead of the kernel driver. The image lives in a sealed memfd
+ * (or a POSIX shared-memory object when PICONTROL_EMU_SHM is set), so
+ * lseek(), read(), write(), pread(), pwrite() and mmap() on the returned
+ * descriptor behave like the driver without being interposed. The KB_*
+ * ioctls are emulated from the device and variable tables parsed out of
+ * config.rsc.
+ *
+ * Environment:
+ *   PICONTROL_EMU_CONFIG   path of config.rsc
+ *                          (default /etc/revpi/config.rsc, then ./config.rsc)
+ *   PICONTROL_EMU_DEVICE   device path to emulate (default /dev/piControl0)
+ *   PICONTROL_EMU_SHM      shm object name, shares one image between processes
+ *   PICONTROL_EMU_INIT     initial bytes, "offset=value[,offset=value...]"
+ *   PICONTROL_EMU_VERBOSE  print the loaded configuration to stderr
+ */
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "piControl.h"
+
+/* -------------------------------------------------------------------------
+ * Configuration
+ * ------------------------------------------------------------------------- */
+
+#define EMU_IMAGE_SIZE      4096
+#define EMU_MAX_FD          4096
+#define EMU_MAX_VARIABLES   4096
+#define EMU_FIELD_LEN       64
+
+#define EMU_DEFAULT_CONFIG  "/etc/revpi/config.rsc"
+#define EMU_LOCAL_CONFIG    "config.rsc"
+
+/**
+ * @brief One variable of config.rsc ("inp", "out" or "mem" entry).
+ */
+typedef struct
+{
+    char     name[32];      /**< Variable name */
+    uint16_t address;       /**< Absolute byte offset in the image */
+    uint8_t  bit;           /**< Bit position (1-bit variables), else 0 */
+    uint16_t length;        /**< Length in bits */
+    long     def;           /**< Default value */
+    int      has_def;       /**< 1 if a numeric default is configured */
+    int      output;        /**< 1 for "out" and "mem" entries */
+} EmuVariable_t;
+
+/**
+ * @brief Byte range of one device section, built while parsing.
+ */
+typedef struct
+{
+    uint32_t lo;            /**< First byte relative to the device */
+    uint32_t hi;            /**< One past the last byte */
+} EmuRange_t;
+
+/* -------------------------------------------------------------------------
+ * State
+ * ------------------------------------------------------------------------- */
+
+static pthread_once_t  g_sym_once = PTHREAD_ONCE_INIT;
+static pthread_once_t  g_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  g_event = PTHREAD_COND_INITIALIZER;
+
+static int      g_image_fd = -1;
+static uint8_t *g_image = NULL;
+static int      g_image_fresh = 0;
+
+static SDeviceInfo    g_devices[REV_PI_DEV_CNT_MAX];
+static int            g_num_devices = 0;
+static EmuVariable_t *g_vars = NULL;
+static int            g_num_vars = 0;
+
+static unsigned int g_reset_count = 0;
+static int          g_io_stopped = 0;
+
+static volatile uint8_t g_emu_fd[EMU_MAX_FD];
+
+static int (*real_open)(const char *, int, ...);
+static int (*real_open64)(const char *, int, ...);
+static int (*real_openat)(int, const char *, int, ...);
+static int (*real_openat64)(int, const char *, int, ...);
+static int (*real_close)(int);
+static int (*real_ioctl)(int, unsigned long, ...);
+
+/* -------------------------------------------------------------------------
+ * Minimal JSON reader (just enough for config.rsc)
+ * ------------------------------------------------------------------------- */
+
+typedef struct
+{
+    const char *p;
+    const char *end;
+} EmuJson_t;
+
+static void json_ws(EmuJson_t *j)
+{
+    while (j->p < j->end &&
+           (*j->p == ' ' || *j->p == '\t' || *j->p == '\n' || *j->p == '\r'))
+        j->p++;
+}
+
+static int json_expect(EmuJson_t *j, char c)
+{
+    json_ws(j);
+    if (j->p >= j->end || *j->p != c)
+        return -1;
+    j->p++;
+    return 0;
+}
+
+/**
+ * @brief Peek at the next non-blank character (0 at end of input).
+ */
+static char json_peek(EmuJson_t *j)
+{
+    json_ws(j);
+    return j->p < j->end ? *j->p : 0;
+}
+
+/**
+ * @brief Read a string into out (truncated to cap - 1 bytes).
+ */
+static int json_string(EmuJson_t *j, char *out, size_t cap)
+{
+    size_t n = 0;
+
+    if (json_expect(j, '"') < 0)
+        return -1;
+
+    while (j->p < j->end && *j->p != '"') {
+        char c = *j->p++;
+
+        if (c == '\\' && j->p < j->end) {
+            c = *j->p++;
+            switch (c) {
+            case 'n': c = '\n'; break;
+            case 't': c = '\t'; break;
+            case 'r': c = '\r'; break;
+            case 'b': c = '\b'; break;
+            case 'f': c = '\f'; break;
+            case 'u':
+                /* Non-ASCII never appears in names or numbers */
+                j->p += (j->end - j->p >= 4) ? 4 : j->end - j->p;
+                c = '?';
+                break;
+            default: break;
+            }
+        }
+        if (n + 1 < cap)
+            out[n++] = c;
+    }
+    if (cap)
+        out[n] = '\0';
+
+    return json_expect(j, '"');
+}
+
+/**
+ * @brief Read any scalar (string, number, true/false/null) as text.
+ */
+static int json_scalar(EmuJson_t *j, char *out, size_t cap)
+{
+    size_t n = 0;
+
+    if (json_peek(j) == '"')
+        return json_string(j, out, cap);
+
+    while (j->p < j->end && *j->p != ',' && *j->p != '}' && *j->p != ']' &&
+           *j->p != ' ' && *j->p != '\n' && *j->p != '\r' && *j->p != '\t') {
+        if (n + 1 < cap)
+            out[n++] = *j->p;
+        j->p++;
+    }
+    if (cap)
+        out[n] = '\0';
+
+    return n > 0 ? 0 : -1;
+}
+
+/**
+ * @brief Skip one value of any type.
+ */
+static int json_skip(EmuJson_t *j)
+{
+    char c = json_peek(j);
+    char tmp[EMU_FIELD_LEN];
+
+    if (c == '{' || c == '[') {
+        char close = (c == '{') ? '}' : ']';
+
+        j->p++;
+        if (json_peek(j) == close) {
+            j->p++;
+            return 0;
+        }
+        for (;;) {
+            if (c == '{') {
+                if (json_string(j, tmp, sizeof(tmp)) < 0 || json_expect(j, ':') < 0)
+                    return -1;
+            }
+            if (json_skip(j) < 0)
+                return -1;
+            c = (close == '}') ? '{' : '[';
+            if (json_peek(j) == ',') {
+                j->p++;
+                continue;
+            }
+            return json_expect(j, close);
+        }
+    }
+
+    return json_scalar(j, tmp, sizeof(tmp));
+}
+
+/**
+ * @brief Iterate the members of an object.
+ *
+ * The callback must consume exactly the member's value.
+ */
+static int json_object(EmuJson_t *j,
+                       int (*member)(EmuJson_t *, const char *, void *),
+                       void *ctx)
+{
+    char key[EMU_FIELD_LEN];
+
+    if (json_expect(j, '{') < 0)
+        return -1;
+    if (json_peek(j) == '}') {
+        j->p++;
+        return 0;
+    }
+
+    for (;;) {
+        if (json_string(j, key, sizeof(key)) < 0 || json_expect(j, ':') < 0)
+            return -1;
+        if (member(j, key, ctx) < 0)
+            return -1;
+        if (json_peek(j) == ',') {
+            j->p++;
+            continue;
+        }
+        return json_expect(j, '}');
+    }
+}
+
+/* -------------------------------------------------------------------------
+ * config.rsc parsing
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Device being parsed, collected before it is committed.
+ */
+typedef struct
+{
+    long       offset;
+    long       type;
+    long       position;
+    EmuRange_t range[3];    /* inp, out, mem */
+    int        first_var;
+    int        section;
+} EmuDeviceCtx_t;
+
+/**
+ * @brief Parse one variable array:
+ *        [name, default, bitLength, offset, exported, sortKey, comment, bit]
+ */
+static int emu_parse_variable(EmuJson_t *j, const char *key, void *ctx)
+{
+    EmuDeviceCtx_t *dev = ctx;
+    char f[8][EMU_FIELD_LEN];
+    int n = 0;
+    EmuVariable_t *v;
+    EmuVariable_t *grown;
+    EmuRange_t *r;
+    long rel;
+    uint32_t bytes;
+    char *endp;
+
+    (void)key;
+    memset(f, 0, sizeof(f));
+
+    if (json_expect(j, '[') < 0)
+        return -1;
+    if (json_peek(j) != ']') {
+        for (;;) {
+            if (n < 8) {
+                if (json_scalar(j, f[n], sizeof(f[n])) < 0)
+                    return -1;
+            } else if (json_skip(j) < 0) {
+                return -1;
+            }
+            n++;
+            if (json_peek(j) == ',') {
+                j->p++;
+                continue;
+            }
+            break;
+        }
+    }
+    if (json_expect(j, ']') < 0)
+        return -1;
+
+    if (n < 4 || g_num_vars >= EMU_MAX_VARIABLES)
+        return 0;
+
+    if ((g_num_vars % 64) == 0) {
+        grown = realloc(g_vars, (size_t)(g_num_vars + 64) * sizeof(*g_vars));
+        if (!grown)
+            return -1;
+        g_vars = grown;
+    }
+
+    v = &g_vars[g_num_vars];
+    memset(v, 0, sizeof(*v));
+    snprintf(v->name, sizeof(v->name), "%.31s", f[0]);
+
+    rel = strtol(f[3], NULL, 10);
+    v->address = (uint16_t)(dev->offset + rel);
+    v->length  = (uint16_t)strtol(f[2], NULL, 10);
+    v->output  = dev->section != 0;
+    if (v->length == 1 && n >= 8 && f[7][0])
+        v->bit = (uint8_t)strtol(f[7], NULL, 10);
+
+    v->def = strtol(f[1], &endp, 0);
+    v->has_def = (f[1][0] != '\0' && *endp == '\0');
+
+    bytes = (v->length + 7) / 8;
+    if (bytes == 0)
+        bytes = 1;
+    r = &dev->range[dev->section];
+    if (r->hi <= r->lo) {
+        r->lo = (uint32_t)rel;
+        r->hi = (uint32_t)rel + bytes;
+    } else {
+        if ((uint32_t)rel < r->lo)        r->lo = (uint32_t)rel;
+        if ((uint32_t)rel + bytes > r->hi) r->hi = (uint32_t)rel + bytes;
+    }
+
+    g_num_vars++;
+    return 0;
+}
+
+static int emu_parse_device_member(EmuJson_t *j, const char *key, void *ctx)
+{
+    EmuDeviceCtx_t *dev = ctx;
+    char buf[EMU_FIELD_LEN];
+
+    if (!strcmp(key, "offset") || !strcmp(key, "productType") ||
+        !strcmp(key, "position")) {
+        long val;
+
+        if (json_scalar(j, buf, sizeof(buf)) < 0)
+            return -1;
+        val = strtol(buf, NULL, 10);
+        if (key[0] == 'o')      dev->offset = val;
+        else if (key[1] == 'r') dev->type = val;
+        else                    dev->position = val;
+        return 0;
+    }
+
+    if (!strcmp(key, "inp")) dev->section = 0;
+    else if (!strcmp(key, "out")) dev->section = 1;
+    else if (!strcmp(key, "mem")) dev->section = 2;
+    else return json_skip(j);
+
+    return json_object(j, emu_parse_variable, dev);
+}
+
+/**
+ * @brief Fill an SDeviceInfo from a parsed device.
+ */
+static void emu_commit_device(const EmuDeviceCtx_t *dev)
+{
+    SDeviceInfo *d;
+    uint16_t base = (uint16_t)dev->offset;
+    const EmuRange_t *r = dev->range;
+
+    if (g_num_devices >= REV_PI_DEV_CNT_MAX)
+        return;
+
+    d = &g_devices[g_num_devices++];
+    memset(d, 0, sizeof(*d));
+
+    d->i8uAddress        = (__u8)dev->position;
+    d->i16uModuleType    = (__u16)dev->type;
+    d->i16uBaseOffset    = base;
+    d->i16uInputOffset   = base + (r[0].hi > r[0].lo ? r[0].lo : 0);
+    d->i16uInputLength   = (__u16)(r[0].hi - r[0].lo);
+    d->i16uOutputOffset  = base + (r[1].hi > r[1].lo ? r[1].lo : r[0].hi);
+    d->i16uOutputLength  = (__u16)(r[1].hi - r[1].lo);
+    d->i16uConfigOffset  = base + (r[2].hi > r[2].lo ? r[2].lo : r[1].hi);
+    d->i16uConfigLength  = (__u16)(r[2].hi - r[2].lo);
+    d->i16uFirstEntry    = (__u16)dev->first_var;
+    d->i16uEntries       = (__u16)(g_num_vars - dev->first_var);
+    d->i8uActive         = 1;
+}
+
+static int emu_parse_device(EmuJson_t *j)
+{
+    EmuDeviceCtx_t dev;
+
+    memset(&dev, 0, sizeof(dev));
+    dev.first_var = g_num_vars;
+
+    if (json_object(j, emu_parse_device_member, &dev) < 0)
+        return -1;
+
+    emu_commit_device(&dev);
+    return 0;
+}
+
+static int emu_parse_root_member(EmuJson_t *j, const char *key, void *ctx)
+{
+    (void)ctx;
+
+    if (strcmp(key, "Devices"))
+        return json_skip(j);
+
+    if (json_expect(j, '[') < 0)
+        return -1;
+    if (json_peek(j) == ']') {
+        j->p++;
+        return 0;
+    }
+    for (;;) {
+        if (emu_parse_device(j) < 0)
+            return -1;
+        if (json_peek(j) == ',') {
+            j->p++;
+            continue;
+        }
+        return json_expect(j, ']');
+    }
+}
+
+/**
+ * @brief Open config.rsc from the environment or the default locations.
+ */
+static FILE *emu_open_config(const char **path)
+{
+    const char *env = getenv("PICONTROL_EMU_CONFIG");
+    FILE *f;
+
+    if (env) {
+        *path = env;
+        return fopen(env, "r");
+    }
+
+    *path = EMU_DEFAULT_CONFIG;
+    f = fopen(EMU_DEFAULT_CONFIG, "r");
+    if (f)
+        return f;
+
+    *path = EMU_LOCAL_CONFIG;
+    return fopen(EMU_LOCAL_CONFIG, "r");
+}
+
+/**
+ * @brief (Re)load the device and variable tables. Caller holds g_lock.
+ */
+static void emu_load_config(void)
+{
+    const char *path;
+    FILE *f;
+    char *buf;
+    long size;
+    EmuJson_t j;
+
+    free(g_vars);
+    g_vars = NULL;
+    g_num_vars = 0;
+    g_num_devices = 0;
+
+    f = emu_open_config(&path);
+    if (!f) {
+        fprintf(stderr, "picontrol_emu: no config.rsc (%s), empty device list\n", path);
+        return;
+    }
+
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    buf = malloc(size > 0 ? (size_t)size : 1);
+    if (!buf || fread(buf, 1, (size_t)size, f) != (size_t)size) {
+        fprintf(stderr, "picontrol_emu: failed to read %s\n", path);
+        free(buf);
+        fclose(f);
+        return;
+    }
+    fclose(f);
+
+    j.p = buf;
+    j.end = buf + size;
+    if (json_object(&j, emu_parse_root_member, NULL) < 0)
+        fprintf(stderr, "picontrol_emu: parse error in %s near byte %ld\n",
+                path, (long)(j.p - buf));
+
+    free(buf);
+
+    if (getenv("PICONTROL_EMU_VERBOSE")) {
+        fprintf(stderr, "picontrol_emu: %s: %d devices, %d variables\n",
+                path, g_num_devices, g_num_vars);
+        for (int i = 0; i < g_num_devices; i++)
+            fprintf(stderr, "picontrol_emu:   addr %2u type %3u base %4u "
+                    "in %u/%u out %u/%u cfg %u/%u\n",
+                    g_devices[i].i8uAddress, g_devices[i].i16uModuleType,
+                    g_devices[i].i16uBaseOffset,
+                    g_devices[i].i16uInputOffset, g_devices[i].i16uInputLength,
+                    g_devices[i].i16uOutputOffset, g_devices[i].i16uOutputLength,
+                    g_devices[i].i16uConfigOffset, g_devices[i].i16uConfigLength);
+    }
+}
+
+/* -------------------------------------------------------------------------
+ * Process image
+ * ------------------------------------------------------------------------- */
+
+/**
+ * @brief Store a variable's value little-endian, as the driver does.
+ */
+static void emu_store(const EmuVariable_t *v, uint32_t value)
+{
+    uint32_t bytes = v->length / 8;
+
+    if (v->address >= EMU_IMAGE_SIZE)
+        return;
+
+    if (v->length == 1) {
+        if (value)
+            g_image[v->address] |= (uint8_t)(1u << v->bit);
+        else
+            g_image[v->address] &= (uint8_t)~(1u << v->bit);
+        return;
+    }
+
+    for (uint32_t i = 0; i < bytes && v->address + i < EMU_IMAGE_SIZE; i++)
+        g_image[v->address + i] = (uint8_t)(value >> (8 * i));
+}
+
+/**
+ * @brief Apply output/config defaults and PICONTROL_EMU_INIT to a new image.
+ */
+static void emu_init_image(void)
+{
+    const char *init = getenv("PICONTROL_EMU_INIT");
+
+    for (int i = 0; i < g_num_vars; i++) {
+        if (g_vars[i].output && g_vars[i].has_def)
+            emu_store(&g_vars[i], (uint32_t)g_vars[i].def);
+    }
+
+    while (init && *init) {
+        char *endp;
+        unsigned long off = strtoul(init, &endp, 0);
+        unsigned long val;
+
+        if (*endp != '=')
+            break;
+        val = strtoul(endp + 1, &endp, 0);
+        if (off < EMU_IMAGE_SIZE)
+            g_image[off] = (uint8_t)val;
+        init = (*endp == ',') ? endp + 1 : "";
+    }
+}
+
+/**
+ * @brief Create (or attach to) the backing object for the image.
+ */
+static int emu_create_image(void)
+{
+    const char *shm = getenv("PICONTROL_EMU_SHM");
+    int fd;
+
+    if (shm) {
+        fd = shm_open(shm, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd >= 0) {
+            g_image_fresh = 1;
+            if (ftruncate(fd, EMU_IMAGE_SIZE) < 0) {
+                real_close(fd);
+                return -1;
+            }
+        } else if (errno == EEXIST) {
+            fd = shm_open(shm, O_RDWR, 0600);
+        }
+        return fd;
+    }
+
+    fd = memfd_create("piControl0", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+        return -1;
+
+    g_image_fresh = 1;
+    if (ftruncate(fd, EMU_IMAGE_SIZE) < 0) {
+        real_close(fd);
+        return -1;
+    }
+
+    /* Fixed size: writes past the image fail, reads past it return 0 */
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+    return fd;
+}
+
+static void emu_resolve_symbols(void)
+{
+    real_open     = dlsym(RTLD_NEXT, "open");
+    real_open64   = dlsym(RTLD_NEXT, "open64");
+    real_openat   = dlsym(RTLD_NEXT, "openat");
+    real_openat64 = dlsym(RTLD_NEXT, "openat64");
+    real_close    = dlsym(RTLD_NEXT, "close");
+    real_ioctl    = dlsym(RTLD_NEXT, "ioctl");
+}
+
+static void emu_resolve(void)
+{
+    pthread_once(&g_sym_once, emu_resolve_symbols);
+}
+
+/**
+ * @brief Create the image on the first open of the device.
+ */
+static void emu_init(void)
+{
+    emu_resolve();
+
+    g_image_fd = emu_create_image();
+    if (g_image_fd < 0) {
+        fprintf(stderr, "picontrol_emu: cannot create image: %s\n", strerror(errno));
+        return;
+    }
+
+    g_image = mmap(NULL, EMU_IMAGE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   g_image_fd, 0);
+    if (g_image == MAP_FAILED) {
+        fprintf(stderr, "picontrol_emu: cannot map image: %s\n", strerror(errno));
+        g_image = NULL;
+        real_close(g_image_fd);
+        g_image_fd = -1;
+        return;
+    }
+
+    pthread_mutex_lock(&g_lock);
+    emu_load_config();
+    if (g_image_fresh)
+        emu_init_image();
+    pthread_mutex_unlock(&g_lock);
+}
+
+/* -------------------------------------------------------------------------
+ * Descriptor handling
+ * ------------------------------------------------------------------------- */
+
+static int emu_is_device(const char *path)
+{
+    const char *dev = getenv("PICONTROL_EMU_DEVICE");
+
+    return path && !strcmp(path, dev ? dev : PICONTROL_DEVICE);
+}
+
+static int emu_is_emulated(int fd)
+{
+    return fd >= 0 && fd < EMU_MAX_FD && g_emu_fd[fd];
+}
+
+/**
+ * @brief Open a new descriptor on the image.
+ *
+ * Reopening through /proc gives each open() its own file position, like
+ * separate opens of the character device.
+ */
+static int emu_open(int flags)
+{
+    char path[64];
+    int fd;
+
+    pthread_once(&g_once, emu_init);
+    if (g_image_fd < 0) {
+        errno = ENODEV;
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", g_image_fd);
+    fd = real_open(path, flags & ~(O_CREAT | O_EXCL | O_TRUNC | O_DIRECTORY));
+    if (fd >= 0 && fd < EMU_MAX_FD)
+        g_emu_fd[fd] = 1;
+
+    return fd;
+}
+
+#define EMU_MODE_ARG(flags, mode)                       \
+    do {                                                \
+        if ((flags) & (O_CREAT | __O_TMPFILE)) {        \
+            va_list ap;                                 \
+            va_start(ap, flags);                        \
+            mode = va_arg(ap, mode_t);                  \
+            va_end(ap);                                 \
+        }                                               \
+    } while (0)
+
+int open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+
+    EMU_MODE_ARG(flags, mode);
+    if (emu_is_device(path))
+        return emu_open(flags);
+
+    emu_resolve();
+    return real_open(path, flags, mode);
+}
+
+int open64(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+
+    EMU_MODE_ARG(flags, mode);
+    if (emu_is_device(path))
+        return emu_open(flags);
+
+    emu_resolve();
+    return real_open64(path, flags, mode);
+}
+
+int openat(int dirfd, const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+
+    EMU_MODE_ARG(flags, mode);
+    if (emu_is_device(path))
+        return emu_open(flags);
+
+    emu_resolve();
+    return real_openat(dirfd, path, flags, mode);
+}
+
+int openat64(int dirfd, const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+
+    EMU_MODE_ARG(flags, mode);
+    if (emu_is_device(path))
+        return emu_open(flags);
+
+    emu_resolve();
+    return real_openat64(dirfd, path, flags, mode);
+}
+
+int close(int fd)
+{
+    emu_resolve();
+    if (fd >= 0 && fd < EMU_MAX_FD)
+        g_emu_fd[fd] = 0;
+
+    return real_close(fd);
+}
+
+/* -------------------------------------------------------------------------
+ * ioctl
+ * ------------------------------------------------------------------------- */
+
+static int emu_get_value(SPIValue *val)
+{
+    uint8_t byte;
+
+    if (val->i16uAddress >= EMU_IMAGE_SIZE) {
+        errno = EFAULT;
+        return -1;
+    }
+
+    byte = __atomic_load_n(&g_image[val->i16uAddress], __ATOMIC_SEQ_CST);
+    if (val->i8uBit >= 8)
+        val->i8uValue = byte;
+    else
+        val->i8uValue = (byte >> val->i8uBit) & 1;
+
+    return 0;
+}
+
+static int emu_set_value(const SPIValue *val)
+{
+    uint8_t *p;
+
+    if (val->i16uAddress >= EMU_IMAGE_SIZE) {
+        errno = EFAULT;
+        return -1;
+    }
+
+    p = &g_image[val->i16uAddress];
+    if (val->i8uBit >= 8)
+        __atomic_store_n(p, val->i8uValue, __ATOMIC_SEQ_CST);
+    else if (val->i8uValue)
+        __atomic_fetch_or(p, (uint8_t)(1u << val->i8uBit), __ATOMIC_SEQ_CST);
+    else
+        __atomic_fetch_and(p, (uint8_t)~(1u << val->i8uBit), __ATOMIC_SEQ_CST);
+
+    return 0;
+}
+
+static int emu_find_variable(SPIVariable *var)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&g_lock);
+    for (int i = 0; i < g_num_vars; i++) {
+        if (!strncmp(g_vars[i].name, var->strVarName, sizeof(var->strVarName))) {
+            var->i16uAddress = g_vars[i].address;
+            var->i8uBit      = g_vars[i].bit;
+            var->i16uLength  = g_vars[i].length;
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    if (ret < 0)
+        errno = ENOENT;
+    return ret;
+}
+
+static int emu_get_device_info(SDeviceInfo *dev)
+{
+    int ret = -1;
+
+    pthread_mutex_lock(&g_lock);
+    for (int i = 0; i < g_num_devices; i++) {
+        /* The driver matches by module type when given, else by address */
+        if (dev->i16uModuleType ? g_devices[i].i16uModuleType == dev->i16uModuleType
+                                : g_devices[i].i8uAddress == dev->i8uAddress) {
+            *dev = g_devices[i];
+            ret = 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_lock);
+
+    if (ret < 0)
+        errno = ENXIO;
+    return ret;
+}
+
+static int emu_wait_for_event(int *event)
+{
+    unsigned int seen;
+
+    pthread_mutex_lock(&g_lock);
+    seen = g_reset_count;
+    while (g_reset_count == seen)
+        pthread_cond_wait(&g_event, &g_lock);
+    pthread_mutex_unlock(&g_lock);
+
+    if (event)
+        *event = KB_EVENT_RESET;
+    return 0;
+}
+
+static int emu_ioctl(int fd, unsigned long request, void *arg)
+{
+    int n;
+
+    switch (request) {
+    case KB_GET_VALUE:
+        if (!arg) break;
+        return emu_get_value(arg);
+
+    case KB_SET_VALUE:
+        if (!arg) break;
+        return emu_set_value(arg);
+
+    case KB_FIND_VARIABLE:
+        if (!arg) break;
+        return emu_find_variable(arg);
+
+    case KB_GET_DEVICE_INFO:
+        if (!arg) break;
+        return emu_get_device_info(arg);
+
+    case KB_GET_DEVICE_INFO_LIST:
+        if (!arg) break;
+        pthread_mutex_lock(&g_lock);
+        n = g_num_devices;
+        memcpy(arg, g_devices, (size_t)n * sizeof(SDeviceInfo));
+        pthread_mutex_unlock(&g_lock);
+        return n;
+
+    case KB_WAIT_FOR_EVENT:
+        return emu_wait_for_event(arg);
+
+    case KB_RESET:
+        pthread_mutex_lock(&g_lock);
+        emu_load_config();
+        g_reset_count++;
+        pthread_cond_broadcast(&g_event);
+        pthread_mutex_unlock(&g_lock);
+        return 0;
+
+    case KB_STOP_IO:
+        n = arg ? *(int *)arg : 1;
+        if (n == 2)
+            n = !g_io_stopped;
+        g_io_stopped = (n != 0);
+        return g_io_stopped;
+
+    case KB_SET_POS:
+        if (!arg) break;
+        return lseek(fd, *(unsigned int *)arg, SEEK_SET) < 0 ? -1 : 0;
+
+    case KB_GET_LAST_MESSAGE:
+        if (!arg) break;
+        ((char *)arg)[0] = '\0';
+        return 0;
+
+    case KB_RO_GET_COUNTER:
+        if (!arg) break;
+        memset(((struct revpi_ro_ioctl_counters *)arg)->counter, 0,
+               sizeof(((struct revpi_ro_ioctl_counters *)arg)->counter));
+        return 0;
+
+    case KB_DIO_RESET_COUNTER:
+    case KB_SET_OUTPUT_WATCHDOG:
+    case KB_SET_EXPORTED_OUTPUTS:
+    case KB_AIO_CALIBRATE:
+        return 0;
+
+    default:
+        break;
+    }
+
+    errno = EINVAL;
+    return -1;
+}
+
+int ioctl(int fd, unsigned long request, ...)
+{
+    va_list ap;
+    void *arg;
+
+    va_start(ap, request);
+    arg = va_arg(ap, void *);
+    va_end(ap);
+
+    emu_resolve();
+    if (emu_is_emulated(fd))
+        return emu_ioctl(fd, request, arg);
+
+    return real_ioctl(fd, request, arg);
+}